@@ -0,0 +1,174 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+/*
+ *  Checks that the patches of every OBJ file given on the command line read back unchanged
+ *  from the text BV file of BVWriter and from float32 and float64 binary BV files of BinaryBVWriter.
+ *
+ *  Usage: check_binary_bv file.obj [file.obj ...]
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <OpenMesh/Core/IO/MeshIO.hh>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+#include "ProcessMesh.hpp"
+#include "PatchConsumer/BVWriter.hpp"
+#include "PatchConsumer/BinaryBVReader.hpp"
+#include "PatchConsumer/BinaryBVWriter.hpp"
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+/*
+ *  Keeps the patches it consumes.
+ */
+class PatchCollector : public PatchConsumer
+{
+public:
+    void start() {}
+    void stop() {}
+    void consume(const Patch& a_Patch) { m_Patches.push_back(a_Patch); }
+    std::vector<Patch> m_Patches;
+};
+
+/*
+ *  Reads the patches of a text BV file written by BVWriter.
+ */
+static bool read_bv(const std::string& a_File, std::vector<Patch>& a_Patches)
+{
+    std::ifstream t_InFile(a_File);
+    std::string t_Group;
+    while(std::getline(t_InFile, t_Group))
+    {
+        std::string t_Line;
+        int t_DegU, t_DegV;
+        if(!std::getline(t_InFile, t_Line) || t_Line != Patch::m_PatchType || !(t_InFile >> t_DegU >> t_DegV))
+        {
+            return false;
+        }
+        Patch t_Patch(t_DegU, t_DegV, t_Group);
+        for(float& t_Coef : t_Patch.m_Coefs)
+        {
+            if(!(t_InFile >> t_Coef))
+            {
+                return false;
+            }
+        }
+        // Rest of the last coefficient line
+        std::getline(t_InFile, t_Line);
+        a_Patches.push_back(std::move(t_Patch));
+    }
+    return true;
+}
+
+/*
+ *  Compares a_Patches against a_Reference and prints the first difference.
+ *  The coefficients must be equal, both formats store them without loss.
+ */
+static bool is_same_patches(const std::vector<Patch>& a_Reference, const std::vector<Patch>& a_Patches, const std::string& a_Name)
+{
+    if(a_Patches.size() != a_Reference.size())
+    {
+        std::cerr << a_Name << ": " << a_Patches.size() << " patches, expected " << a_Reference.size() << "\n";
+        return false;
+    }
+    for(size_t p = 0; p < a_Reference.size(); ++p)
+    {
+        const Patch& t_Expected = a_Reference[p];
+        const Patch& t_Patch = a_Patches[p];
+        if(t_Patch.m_DegU != t_Expected.m_DegU || t_Patch.m_DegV != t_Expected.m_DegV || t_Patch.getGroup() != t_Expected.getGroup())
+        {
+            std::cerr << a_Name << ": patch " << p << " has a different degree or group\n";
+            return false;
+        }
+        if(t_Patch.m_Coefs != t_Expected.m_Coefs)
+        {
+            std::cerr << a_Name << ": patch " << p << " has different coefficients\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " file.obj [file.obj ...]\n";
+        return 1;
+    }
+
+    const std::string t_BVFile = "check_binary_bv.bv";
+    const std::string t_FloatFile = "check_binary_bv_float.bvb";
+    const std::string t_DoubleFile = "check_binary_bv_double.bvb";
+
+    int t_NumFailed = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string t_File = argv[i];
+
+        MeshType t_Mesh;
+        if(!OpenMesh::IO::read_mesh(t_Mesh, t_File))
+        {
+            std::cerr << t_File << ": OpenMesh cannot read the file\n";
+            ++t_NumFailed;
+            continue;
+        }
+        PatchCollector t_Collector;
+        process_mesh(t_Mesh, &t_Collector, false);
+
+        // The writers are closed before the files are read back
+        {
+            BVWriter t_BVWriter(t_BVFile);
+            BinaryBVWriter t_FloatWriter(t_FloatFile, false);
+            BinaryBVWriter t_DoubleWriter(t_DoubleFile, true);
+            for(PatchConsumer* t_Writer : std::vector<PatchConsumer*>{&t_BVWriter, &t_FloatWriter, &t_DoubleWriter})
+            {
+                t_Writer->start();
+                for(const Patch& t_Patch : t_Collector.m_Patches)
+                {
+                    t_Writer->consume(t_Patch);
+                }
+                t_Writer->stop();
+            }
+        }
+
+        bool t_IsSame = true;
+        std::vector<Patch> t_BVPatches;
+        if(!read_bv(t_BVFile, t_BVPatches))
+        {
+            std::cerr << t_File << ": the BV file is malformed\n";
+            t_IsSame = false;
+        }
+        else
+        {
+            t_IsSame = is_same_patches(t_Collector.m_Patches, t_BVPatches, t_File + " (bv)");
+        }
+        for(const std::string& t_BinaryFile : {t_FloatFile, t_DoubleFile})
+        {
+            try
+            {
+                BinaryBVReader t_Reader(t_BinaryFile);
+                t_IsSame = is_same_patches(t_Collector.m_Patches, t_Reader.getPatches(), t_File + " (" + t_BinaryFile + ")") && t_IsSame;
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << t_File << ": " << e.what() << "\n";
+                t_IsSame = false;
+            }
+        }
+
+        std::cout << (t_IsSame ? "OK     " : "FAILED ") << t_File << " (" << t_Collector.m_Patches.size() << " patches)\n";
+        t_NumFailed += t_IsSame ? 0 : 1;
+    }
+
+    std::remove(t_BVFile.c_str());
+    std::remove(t_FloatFile.c_str());
+    std::remove(t_DoubleFile.c_str());
+    return t_NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+/*
+ *  Checks that PatchBuilder::degRaise keeps the surface: the patches built after raising the mask must
+ *  describe the same surface as the patches built before. Tested on the builders of every OBJ file given
+ *  on the command line, and on builders with random masks of every degree up to 3 in u and v, so that
+ *  raising only in u and only in v are covered as well.
+ *
+ *  Usage: check_builder_deg_raise file.obj [file.obj ...]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <OpenMesh/Core/IO/MeshIO.hh>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+#include "ProcessMesh.hpp"
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+/*
+ *  Coordinate a_K of a patch at (u, v), by De Casteljau evaluation in double precision.
+ */
+static double evaluate(const Patch& a_Patch, double a_U, double a_V, int a_K)
+{
+    std::vector<double> t_Rows(a_Patch.m_DegU + 1);
+    std::vector<double> t_Row(a_Patch.m_DegV + 1);
+    for(int i = 0; i <= a_Patch.m_DegU; ++i)
+    {
+        for(int j = 0; j <= a_Patch.m_DegV; ++j)
+        {
+            t_Row[j] = a_Patch(i, j, a_K);
+        }
+        for(int k = 1; k <= a_Patch.m_DegV; ++k)
+        {
+            for(int j = 0; j <= a_Patch.m_DegV - k; ++j)
+            {
+                t_Row[j] = (1.0 - a_V) * t_Row[j] + a_V * t_Row[j + 1];
+            }
+        }
+        t_Rows[i] = t_Row[0];
+    }
+    for(int k = 1; k <= a_Patch.m_DegU; ++k)
+    {
+        for(int i = 0; i <= a_Patch.m_DegU - k; ++i)
+        {
+            t_Rows[i] = (1.0 - a_U) * t_Rows[i] + a_U * t_Rows[i + 1];
+        }
+    }
+    return t_Rows[0];
+}
+
+/*
+ *  Raises a copy of a_Builder and compares the patches it builds with those of a_Builder on a 5 x 5 grid of parameters.
+ */
+static bool is_raise_exact(const MeshType& a_Mesh, const PatchBuilder& a_Builder, const std::string& a_Name)
+{
+    PatchBuilder t_Raised = a_Builder;
+    t_Raised.degRaise();
+    const std::vector<Patch> t_Expected = a_Builder.buildPatches(a_Mesh);
+    const std::vector<Patch> t_Patches = t_Raised.buildPatches(a_Mesh);
+
+    const std::string t_Degrees = std::to_string(a_Builder.m_DegU) + "x" + std::to_string(a_Builder.m_DegV);
+    if(t_Patches.size() != t_Expected.size())
+    {
+        std::cerr << a_Name << ": raising a " << t_Degrees << " builder changed the number of patches\n";
+        return false;
+    }
+    for(size_t p = 0; p < t_Patches.size(); ++p)
+    {
+        const int t_DegU = t_Expected[p].m_DegU < 3 ? t_Expected[p].m_DegU + 1 : t_Expected[p].m_DegU;
+        const int t_DegV = t_Expected[p].m_DegV < 3 ? t_Expected[p].m_DegV + 1 : t_Expected[p].m_DegV;
+        if(t_Patches[p].m_DegU != t_DegU || t_Patches[p].m_DegV != t_DegV)
+        {
+            std::cerr << a_Name << ": raising a " << t_Degrees << " builder gave degree "
+                      << t_Patches[p].m_DegU << "x" << t_Patches[p].m_DegV << "\n";
+            return false;
+        }
+        double t_Scale = 1.0;
+        for(float t_Coef : t_Expected[p].m_Coefs)
+        {
+            t_Scale = std::max(t_Scale, static_cast<double>(std::abs(t_Coef)));
+        }
+        for(int s = 0; s <= 4; ++s)
+        {
+            for(int t = 0; t <= 4; ++t)
+            {
+                for(int k = 0; k < 3; ++k)
+                {
+                    const double t_Difference = evaluate(t_Patches[p], s / 4.0, t / 4.0, k) - evaluate(t_Expected[p], s / 4.0, t / 4.0, k);
+                    if(std::abs(t_Difference) > 1e-5 * t_Scale)
+                    {
+                        std::cerr << a_Name << ": raising a " << t_Degrees << " builder moved patch " << p << " at ("
+                                  << s / 4.0 << ", " << t / 4.0 << ") by " << t_Difference << "\n";
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " file.obj [file.obj ...]\n";
+        return 1;
+    }
+
+    int t_NumFailed = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string t_File = argv[i];
+
+        MeshType t_Mesh;
+        if(!OpenMesh::IO::read_mesh(t_Mesh, t_File))
+        {
+            std::cerr << t_File << ": OpenMesh cannot read the file\n";
+            ++t_NumFailed;
+            continue;
+        }
+        const std::vector<PatchBuilder> t_Builders = getPatchBuilders(t_Mesh);
+
+        bool t_IsSame = true;
+        for(const PatchBuilder& t_Builder : t_Builders)
+        {
+            if(!is_raise_exact(t_Mesh, t_Builder, t_File))
+            {
+                t_IsSame = false;
+                break;
+            }
+        }
+
+        // Random masks of every degree on the neighborhood of the first builder, the same for every run
+        if(t_IsSame && !t_Builders.empty())
+        {
+            const PatchBuilder& t_First = t_Builders.front();
+            std::mt19937 t_Random(1);
+            std::uniform_real_distribution<double> t_Weight(0.0, 1.0);
+            for(int t_DegU = 1; t_DegU <= 3 && t_IsSame; ++t_DegU)
+            {
+                for(int t_DegV = 1; t_DegV <= 3 && t_IsSame; ++t_DegV)
+                {
+                    Matrix t_Mask((t_DegU + 1) * (t_DegV + 1), static_cast<int>(t_First.m_NBVertexHandles.size()));
+                    for(int r = 0; r < t_Mask.getRows(); ++r)
+                    {
+                        for(int c = 0; c < t_Mask.getCols(); ++c)
+                        {
+                            t_Mask(r, c) = t_Weight(t_Random);
+                        }
+                    }
+                    const PatchBuilder t_Builder(t_Mesh, t_First.m_NBVertexHandles, std::make_shared<const Matrix>(std::move(t_Mask)),
+                                                 t_First.m_PatchConstructor, t_DegU, t_DegV);
+                    t_IsSame = is_raise_exact(t_Mesh, t_Builder, t_File + " (random mask)");
+                }
+            }
+        }
+
+        std::cout << (t_IsSame ? "OK     " : "FAILED ") << t_File << " (" << t_Builders.size() << " builders)\n";
+        t_NumFailed += t_IsSame ? 0 : 1;
+    }
+    return t_NumFailed == 0 ? 0 : 1;
+}
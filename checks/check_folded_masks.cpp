@@ -0,0 +1,111 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+/*
+ *  Checks that the masks folded onto the original vertices of a subdivided region are shared independently of the vertex
+ *  numbering: the builders of a copy of the mesh with its vertices renumbered must reuse the masks of the builders of the
+ *  mesh itself. Prints how many builders share how many masks, for every OBJ file given on the command line.
+ *
+ *  Usage: check_folded_masks file.obj [file.obj ...]
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <OpenMesh/Core/IO/MeshIO.hh>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+#include "ProcessMesh.hpp"
+#include "Helper/MeshBuilder.hpp"
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+/*
+ *  Copy of a_Mesh with its vertices in a random order, the same for every run. Faces keep their order and first vertex.
+ */
+static MeshType renumber(const MeshType& a_Mesh)
+{
+    std::vector<uint32_t> t_NewIndex(a_Mesh.n_vertices());
+    std::iota(t_NewIndex.begin(), t_NewIndex.end(), 0);
+    std::mt19937 t_Random(1);
+    std::shuffle(t_NewIndex.begin(), t_NewIndex.end(), t_Random);
+
+    std::vector<double> t_Points(3 * a_Mesh.n_vertices());
+    for(size_t v = 0; v < a_Mesh.n_vertices(); ++v)
+    {
+        const MeshType::Point& t_Point = a_Mesh.point(a_Mesh.vertex_handle(v));
+        for(int k = 0; k < 3; ++k)
+        {
+            t_Points[3 * t_NewIndex[v] + k] = t_Point[k];
+        }
+    }
+    std::vector<uint32_t> t_Indices;
+    std::vector<uint64_t> t_Offsets(1, 0);
+    for(size_t f = 0; f < a_Mesh.n_faces(); ++f)
+    {
+        const MeshType::FaceHandle t_Face = a_Mesh.face_handle(f);
+        for(auto t_FVIt = a_Mesh.cfv_ccwiter(t_Face); t_FVIt.is_valid(); ++t_FVIt)
+        {
+            t_Indices.push_back(t_NewIndex[t_FVIt->idx()]);
+        }
+        t_Offsets.push_back(t_Indices.size());
+    }
+    MeshType t_Mesh;
+    Helper::build_mesh(t_Mesh, t_Points.data(), a_Mesh.n_vertices(), t_Indices.data(), t_Offsets.data(), a_Mesh.n_faces());
+    return t_Mesh;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " file.obj [file.obj ...]\n";
+        return 1;
+    }
+
+    int t_NumFailed = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string t_File = argv[i];
+
+        MeshType t_Mesh;
+        if(!OpenMesh::IO::read_mesh(t_Mesh, t_File))
+        {
+            std::cerr << t_File << ": OpenMesh cannot read the file\n";
+            ++t_NumFailed;
+            continue;
+        }
+        MeshType t_Renumbered = renumber(t_Mesh);
+
+        // The builders of the mesh keep their masks alive, so the builders of the renumbered mesh can find them
+        const std::vector<PatchBuilder> t_Builders = getPatchBuilders(t_Mesh);
+        const std::vector<PatchBuilder> t_RenumberedBuilders = getPatchBuilders(t_Renumbered);
+
+        std::set<const Matrix*> t_Masks;
+        for(const PatchBuilder& t_Builder : t_Builders)
+        {
+            t_Masks.insert(t_Builder.m_Mask.get());
+        }
+        size_t t_NumReused = 0;
+        for(const PatchBuilder& t_Builder : t_RenumberedBuilders)
+        {
+            t_NumReused += t_Masks.count(t_Builder.m_Mask.get());
+        }
+
+        const bool t_IsSame = t_RenumberedBuilders.size() == t_Builders.size() && t_NumReused == t_Builders.size();
+        if(!t_IsSame)
+        {
+            std::cerr << t_File << ": " << t_RenumberedBuilders.size() - t_NumReused << " of " << t_RenumberedBuilders.size()
+                      << " builders of the renumbered mesh have a mask that the mesh does not have\n";
+        }
+        std::cout << (t_IsSame ? "OK     " : "FAILED ") << t_File << " (" << t_Builders.size() << " builders share "
+                  << t_Masks.size() << " masks)\n";
+        t_NumFailed += t_IsSame ? 0 : 1;
+    }
+    return t_NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+/*
+ *  Checks that local refinement gives the same builders as subdividing the whole mesh, for every OBJ file given on the
+ *  command line: the same number of builders, the same neighborhoods, the same mask times points for every builder, and
+ *  the same patches when all builders are built in one batch. Builders are matched by their constructor and their set of
+ *  neighbor vertices, since the two ways of refining collect them in a different order.
+ *
+ *  Usage: check_local_refinement file.obj [file.obj ...]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <OpenMesh/Core/IO/MeshIO.hh>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+#include "ProcessMesh.hpp"
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+/*
+ *  The first difference of two lists of patches beyond a_Tolerance, or an empty string if there is none.
+ */
+static std::string first_difference(const Patch* a_Expected, const Patch* a_Patches, size_t a_NumPatches, float a_Tolerance)
+{
+    for(size_t p = 0; p < a_NumPatches; ++p)
+    {
+        if(a_Patches[p].m_DegU != a_Expected[p].m_DegU || a_Patches[p].m_DegV != a_Expected[p].m_DegV
+           || a_Patches[p].getGroup() != a_Expected[p].getGroup())
+        {
+            return "patch " + std::to_string(p) + " has a different degree or group";
+        }
+        for(size_t c = 0; c < a_Patches[p].size(); ++c)
+        {
+            const float t_Difference = a_Patches[p].data()[c] - a_Expected[p].data()[c];
+            if(std::abs(t_Difference) > a_Tolerance)
+            {
+                return "coefficient " + std::to_string(c) + " of patch " + std::to_string(p) + " differs by " + std::to_string(t_Difference);
+            }
+        }
+    }
+    return "";
+}
+
+/*
+ *  Neighbor vertices of a builder, sorted, so that builders are matched independently of the order of their columns.
+ */
+static std::vector<int> neighborhood(const PatchBuilder& a_Builder)
+{
+    std::vector<int> t_Indices;
+    for(const auto& t_Vertex : a_Builder.m_NBVertexHandles)
+    {
+        t_Indices.push_back(t_Vertex.idx());
+    }
+    std::sort(t_Indices.begin(), t_Indices.end());
+    return t_Indices;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " file.obj [file.obj ...]\n";
+        return 1;
+    }
+
+    int t_NumFailed = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string t_File = argv[i];
+
+        MeshType t_Mesh;
+        if(!OpenMesh::IO::read_mesh(t_Mesh, t_File))
+        {
+            std::cerr << t_File << ": OpenMesh cannot read the file\n";
+            ++t_NumFailed;
+            continue;
+        }
+        const std::vector<PatchBuilder> t_Expected = getPatchBuilders(t_Mesh, 0, false);
+        const std::vector<PatchBuilder> t_Builders = getPatchBuilders(t_Mesh, 0, true);
+
+        // The masks of both are summed in a different order, allow for a few rounding steps of the largest coordinate
+        float t_Scale = 1.0f;
+        for(const auto& t_Vertex : t_Mesh.vertices())
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                t_Scale = std::max(t_Scale, std::abs(t_Mesh.point(t_Vertex)[k]));
+            }
+        }
+        const float t_Tolerance = 1e-5f * t_Scale;
+
+        bool t_IsSame = t_Builders.size() == t_Expected.size();
+        if(!t_IsSame)
+        {
+            std::cerr << t_File << ": " << t_Builders.size() << " builders, expected " << t_Expected.size() << "\n";
+        }
+
+        // Match every builder of the whole mesh with an unmatched builder of local refinement that builds the same patches
+        std::map<std::pair<const PatchConstructor*, std::vector<int>>, std::vector<size_t>> t_Unmatched;
+        for(size_t b = 0; b < t_Builders.size(); ++b)
+        {
+            t_Unmatched[std::make_pair(t_Builders[b].getPatchConstructor(), neighborhood(t_Builders[b]))].push_back(b);
+        }
+        std::vector<size_t> t_Match(t_Expected.size());
+        for(size_t e = 0; e < t_Expected.size() && t_IsSame; ++e)
+        {
+            const std::vector<Patch> t_ExpectedPatches = t_Expected[e].buildPatches(t_Mesh);
+            std::vector<size_t>& t_Candidates = t_Unmatched[std::make_pair(t_Expected[e].getPatchConstructor(), neighborhood(t_Expected[e]))];
+            auto t_It = std::find_if(t_Candidates.begin(), t_Candidates.end(), [&](size_t b)
+            {
+                const std::vector<Patch> t_Patches = t_Builders[b].buildPatches(t_Mesh);
+                return t_Patches.size() == t_ExpectedPatches.size()
+                    && first_difference(t_ExpectedPatches.data(), t_Patches.data(), t_Patches.size(), t_Tolerance).empty();
+            });
+            if(t_It == t_Candidates.end())
+            {
+                std::cerr << t_File << ": builder " << e << " of the whole mesh has no builder with the same patches";
+                if(!t_Candidates.empty())
+                {
+                    // Show how the first builder with the same neighborhood differs
+                    const std::vector<Patch> t_Patches = t_Builders[t_Candidates.front()].buildPatches(t_Mesh);
+                    std::cerr << ", " << (t_Patches.size() != t_ExpectedPatches.size() ? "the builder with the same neighborhood has a different number of patches"
+                                  : first_difference(t_ExpectedPatches.data(), t_Patches.data(), t_Patches.size(), t_Tolerance));
+                }
+                std::cerr << "\n";
+                t_IsSame = false;
+                break;
+            }
+            t_Match[e] = *t_It;
+            t_Candidates.erase(t_It);
+        }
+
+        // The batched patches, in the order of the matched builders
+        if(t_IsSame)
+        {
+            const std::vector<Patch> t_ExpectedPatches = PatchBuilder::buildPatchesBatched(t_Mesh, t_Expected.data(), t_Expected.size());
+            const std::vector<Patch> t_Patches = PatchBuilder::buildPatchesBatched(t_Mesh, t_Builders.data(), t_Builders.size());
+            std::vector<size_t> t_Offsets(t_Builders.size() + 1, 0);
+            for(size_t b = 0; b < t_Builders.size(); ++b)
+            {
+                t_Offsets[b + 1] = t_Offsets[b] + t_Builders[b].numPatches();
+            }
+            size_t t_First = 0;
+            for(size_t e = 0; e < t_Expected.size() && t_IsSame; ++e)
+            {
+                const size_t t_NumPatches = t_Expected[e].numPatches();
+                const std::string t_Difference = first_difference(t_ExpectedPatches.data() + t_First, t_Patches.data() + t_Offsets[t_Match[e]],
+                                                                  t_NumPatches, t_Tolerance);
+                if(!t_Difference.empty())
+                {
+                    std::cerr << t_File << " (batched): builder " << e << ", " << t_Difference << "\n";
+                    t_IsSame = false;
+                }
+                t_First += t_NumPatches;
+            }
+        }
+
+        std::cout << (t_IsSame ? "OK     " : "FAILED ") << t_File << " (" << t_Expected.size() << " builders)\n";
+        t_NumFailed += t_IsSame ? 0 : 1;
+    }
+    return t_NumFailed == 0 ? 0 : 1;
+}
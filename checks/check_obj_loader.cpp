@@ -0,0 +1,114 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+/*
+ *  Checks that Helper::load_obj builds the same mesh as OpenMesh::IO::read_mesh,
+ *  the loader it replaces, for every OBJ file given on the command line.
+ *
+ *  Usage: check_obj_loader file.obj [file.obj ...]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <OpenMesh/Core/IO/MeshIO.hh>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+#include "Helper/ObjLoader.hpp"
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+/*
+ *  Vertex indices of a face, rotated to start at the smallest index,
+ *  so that faces are compared independently of their first halfedge.
+ */
+static std::vector<int> face_indices(const MeshType& a_Mesh, const MeshType::FaceHandle& a_Face)
+{
+    std::vector<int> t_Indices;
+    for(auto t_FVIt = a_Mesh.cfv_ccwiter(a_Face); t_FVIt.is_valid(); ++t_FVIt)
+    {
+        t_Indices.push_back(t_FVIt->idx());
+    }
+    std::rotate(t_Indices.begin(), std::min_element(t_Indices.begin(), t_Indices.end()), t_Indices.end());
+    return t_Indices;
+}
+
+/*
+ *  Compares a_Mesh against a_Reference and prints the first difference.
+ */
+static bool is_same_mesh(const MeshType& a_Reference, const MeshType& a_Mesh, const std::string& a_Name)
+{
+    if(a_Mesh.n_vertices() != a_Reference.n_vertices() || a_Mesh.n_faces() != a_Reference.n_faces())
+    {
+        std::cerr << a_Name << ": " << a_Mesh.n_vertices() << " vertices and " << a_Mesh.n_faces() << " faces, expected "
+                  << a_Reference.n_vertices() << " and " << a_Reference.n_faces() << "\n";
+        return false;
+    }
+    for(size_t v = 0; v < a_Reference.n_vertices(); ++v)
+    {
+        const MeshType::Point& t_Expected = a_Reference.point(a_Reference.vertex_handle(v));
+        const MeshType::Point& t_Point = a_Mesh.point(a_Mesh.vertex_handle(v));
+        for(int k = 0; k < 3; ++k)
+        {
+            // Both loaders round the same decimal text to float, allow for one rounding step of difference
+            if(std::abs(t_Point[k] - t_Expected[k]) > 1e-6f * std::max(1.0f, std::abs(t_Expected[k])))
+            {
+                std::cerr << a_Name << ": coordinate " << k << " of vertex " << v << " is " << t_Point[k] << ", expected " << t_Expected[k] << "\n";
+                return false;
+            }
+        }
+    }
+    for(size_t f = 0; f < a_Reference.n_faces(); ++f)
+    {
+        if(face_indices(a_Mesh, a_Mesh.face_handle(f)) != face_indices(a_Reference, a_Reference.face_handle(f)))
+        {
+            std::cerr << a_Name << ": face " << f << " has different vertices\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " file.obj [file.obj ...]\n";
+        return 1;
+    }
+
+    int t_NumFailed = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string t_File = argv[i];
+
+        MeshType t_Reference;
+        if(!OpenMesh::IO::read_mesh(t_Reference, t_File))
+        {
+            std::cerr << t_File << ": OpenMesh cannot read the file\n";
+            ++t_NumFailed;
+            continue;
+        }
+
+        // One thread and all hardware threads
+        bool t_IsSame = true;
+        for(int t_NumThreads : {1, 0})
+        {
+            MeshType t_Mesh;
+            const std::string t_Name = t_File + " (" + std::to_string(t_NumThreads) + " threads)";
+            if(!Helper::load_obj(t_File, t_Mesh, t_NumThreads))
+            {
+                std::cerr << t_Name << ": load_obj failed\n";
+                t_IsSame = false;
+                continue;
+            }
+            t_IsSame = is_same_mesh(t_Reference, t_Mesh, t_Name) && t_IsSame;
+        }
+
+        std::cout << (t_IsSame ? "OK     " : "FAILED ") << t_File << "\n";
+        t_NumFailed += t_IsSame ? 0 : 1;
+    }
+    return t_NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+/*
+ *  Checks that Patch::degRaise keeps the surface: the raised patch must describe the same surface as the patch
+ *  before raising. Tested on the patches of every OBJ file given on the command line, and on random patches of
+ *  every degree up to 3 in u and v, so that raising only in u, only in v and in both directions are covered.
+ *
+ *  Usage: check_patch_deg_raise file.obj [file.obj ...]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <OpenMesh/Core/IO/MeshIO.hh>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+#include "ProcessMesh.hpp"
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+/*
+ *  Keeps the patches it consumes.
+ */
+class PatchCollector : public PatchConsumer
+{
+public:
+    void start() {}
+    void stop() {}
+    void consume(const Patch& a_Patch) { m_Patches.push_back(a_Patch); }
+    std::vector<Patch> m_Patches;
+};
+
+/*
+ *  Coordinate a_K of a patch at (u, v), by De Casteljau evaluation in double precision.
+ */
+static double evaluate(const Patch& a_Patch, double a_U, double a_V, int a_K)
+{
+    std::vector<double> t_Rows(a_Patch.m_DegU + 1);
+    std::vector<double> t_Row(a_Patch.m_DegV + 1);
+    for(int i = 0; i <= a_Patch.m_DegU; ++i)
+    {
+        for(int j = 0; j <= a_Patch.m_DegV; ++j)
+        {
+            t_Row[j] = a_Patch(i, j, a_K);
+        }
+        for(int k = 1; k <= a_Patch.m_DegV; ++k)
+        {
+            for(int j = 0; j <= a_Patch.m_DegV - k; ++j)
+            {
+                t_Row[j] = (1.0 - a_V) * t_Row[j] + a_V * t_Row[j + 1];
+            }
+        }
+        t_Rows[i] = t_Row[0];
+    }
+    for(int k = 1; k <= a_Patch.m_DegU; ++k)
+    {
+        for(int i = 0; i <= a_Patch.m_DegU - k; ++i)
+        {
+            t_Rows[i] = (1.0 - a_U) * t_Rows[i] + a_U * t_Rows[i + 1];
+        }
+    }
+    return t_Rows[0];
+}
+
+/*
+ *  Raises a copy of a_Patch and compares it with a_Patch on a 5 x 5 grid of parameters.
+ */
+static bool is_raise_exact(const Patch& a_Patch, const std::string& a_Name)
+{
+    Patch t_Raised = a_Patch;
+    t_Raised.degRaise();
+
+    const std::string t_Degrees = std::to_string(a_Patch.m_DegU) + "x" + std::to_string(a_Patch.m_DegV);
+    const int t_DegU = a_Patch.m_DegU < 3 ? a_Patch.m_DegU + 1 : a_Patch.m_DegU;
+    const int t_DegV = a_Patch.m_DegV < 3 ? a_Patch.m_DegV + 1 : a_Patch.m_DegV;
+    if(t_Raised.m_DegU != t_DegU || t_Raised.m_DegV != t_DegV)
+    {
+        std::cerr << a_Name << ": raising a " << t_Degrees << " patch gave degree " << t_Raised.m_DegU << "x" << t_Raised.m_DegV << "\n";
+        return false;
+    }
+    if(t_Raised.getGroup() != a_Patch.getGroup())
+    {
+        std::cerr << a_Name << ": raising a " << t_Degrees << " patch changed its group\n";
+        return false;
+    }
+    double t_Scale = 1.0;
+    for(float t_Coef : a_Patch.m_Coefs)
+    {
+        t_Scale = std::max(t_Scale, static_cast<double>(std::abs(t_Coef)));
+    }
+    for(int s = 0; s <= 4; ++s)
+    {
+        for(int t = 0; t <= 4; ++t)
+        {
+            for(int k = 0; k < 3; ++k)
+            {
+                const double t_Difference = evaluate(t_Raised, s / 4.0, t / 4.0, k) - evaluate(a_Patch, s / 4.0, t / 4.0, k);
+                if(std::abs(t_Difference) > 1e-5 * t_Scale)
+                {
+                    std::cerr << a_Name << ": raising a " << t_Degrees << " patch moved it at ("
+                              << s / 4.0 << ", " << t / 4.0 << ") by " << t_Difference << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " file.obj [file.obj ...]\n";
+        return 1;
+    }
+
+    int t_NumFailed = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string t_File = argv[i];
+
+        MeshType t_Mesh;
+        if(!OpenMesh::IO::read_mesh(t_Mesh, t_File))
+        {
+            std::cerr << t_File << ": OpenMesh cannot read the file\n";
+            ++t_NumFailed;
+            continue;
+        }
+        PatchCollector t_Collector;
+        process_mesh(t_Mesh, &t_Collector, false);
+
+        bool t_IsSame = true;
+        for(const Patch& t_Patch : t_Collector.m_Patches)
+        {
+            if(!is_raise_exact(t_Patch, t_File))
+            {
+                t_IsSame = false;
+                break;
+            }
+        }
+
+        // Random patches of every degree, the same for every run
+        std::mt19937 t_Random(1);
+        std::uniform_real_distribution<float> t_Coordinate(-1.0f, 1.0f);
+        for(int t_DegU = 1; t_DegU <= 3 && t_IsSame; ++t_DegU)
+        {
+            for(int t_DegV = 1; t_DegV <= 3 && t_IsSame; ++t_DegV)
+            {
+                Patch t_Patch(t_DegU, t_DegV, "random");
+                for(float& t_Coef : t_Patch.m_Coefs)
+                {
+                    t_Coef = t_Coordinate(t_Random);
+                }
+                t_IsSame = is_raise_exact(t_Patch, t_File + " (random patch)");
+            }
+        }
+
+        std::cout << (t_IsSame ? "OK     " : "FAILED ") << t_File << " (" << t_Collector.m_Patches.size() << " patches)\n";
+        t_NumFailed += t_IsSame ? 0 : 1;
+    }
+    return t_NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,271 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+/*
+ *  Checks the Tessellator against De Casteljau evaluation, as EvaluatedMeshWriter did before the Tessellator,
+ *  on the patches of every OBJ file given on the command line. The uniform tessellation must give the same
+ *  grid, normals, parameters and triangles, and every vertex of the adaptive tessellation must lie on the patch.
+ *
+ *  Usage: check_tessellator file.obj [file.obj ...]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <OpenMesh/Core/IO/MeshIO.hh>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+#include "ProcessMesh.hpp"
+#include "Helper/Tessellator.hpp"
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+/*
+ *  Keeps the patches it consumes.
+ */
+class PatchCollector : public PatchConsumer
+{
+public:
+    void start() {}
+    void stop() {}
+    void consume(const Patch& a_Patch) { m_Patches.push_back(a_Patch); }
+    std::vector<Patch> m_Patches;
+};
+
+/*
+ *  De Casteljau evaluation of a Bézier curve with a_Deg + 1 control points, in place.
+ */
+static Point de_casteljau(std::vector<Point>& a_Points, int a_Deg, float a_T)
+{
+    for(int k = 1; k <= a_Deg; ++k)
+    {
+        for(int i = 0; i <= a_Deg - k; ++i)
+        {
+            a_Points[i] = (1.0f - a_T) * a_Points[i] + a_T * a_Points[i + 1];
+        }
+    }
+    return a_Points[0];
+}
+
+/*
+ *  Position and tangents of a patch at (u, v).
+ */
+static void evaluate_reference(const Patch& a_Patch, float a_U, float a_V, Point& a_Point, Point& a_TangentU, Point& a_TangentV)
+{
+    const int t_DegU = a_Patch.m_DegU;
+    const int t_DegV = a_Patch.m_DegV;
+
+    // Position and v tangent: reduce every row in v, then the results in u
+    std::vector<Point> t_Rows(t_DegU + 1);
+    std::vector<Point> t_RowTangents(t_DegU + 1);
+    std::vector<Point> t_Row(t_DegV + 1);
+    for(int i = 0; i <= t_DegU; ++i)
+    {
+        for(int j = 0; j <= t_DegV; ++j)
+        {
+            t_Row[j] = a_Patch.getPoint(i, j);
+        }
+        for(int j = 0; j < t_DegV; ++j)
+        {
+            t_Row[j] = static_cast<float>(t_DegV) * (t_Row[j + 1] - t_Row[j]);
+        }
+        t_RowTangents[i] = de_casteljau(t_Row, t_DegV - 1, a_V);
+        for(int j = 0; j <= t_DegV; ++j)
+        {
+            t_Row[j] = a_Patch.getPoint(i, j);
+        }
+        t_Rows[i] = de_casteljau(t_Row, t_DegV, a_V);
+    }
+    a_Point = de_casteljau(t_Rows, t_DegU, a_U);
+    a_TangentV = de_casteljau(t_RowTangents, t_DegU, a_U);
+
+    // u tangent: differences of the rows in u, reduced like the position
+    for(int i = 0; i <= t_DegU; ++i)
+    {
+        for(int j = 0; j <= t_DegV; ++j)
+        {
+            t_Row[j] = a_Patch.getPoint(i, j);
+        }
+        t_Rows[i] = de_casteljau(t_Row, t_DegV, a_V);
+    }
+    for(int i = 0; i < t_DegU; ++i)
+    {
+        t_Rows[i] = static_cast<float>(t_DegU) * (t_Rows[i + 1] - t_Rows[i]);
+    }
+    a_TangentU = de_casteljau(t_Rows, t_DegU - 1, a_U);
+}
+
+/*
+ *  Compares the vertex a_Vertex of a_Mesh with the reference evaluation of a_Patch at the parameters of the vertex.
+ *  Normals are only compared where the patch is not degenerate.
+ */
+static bool is_on_patch(const Patch& a_Patch, const TessellatedMesh& a_Mesh, size_t a_Vertex, float a_Tolerance, const std::string& a_Name)
+{
+    const float* t_UV = a_Mesh.m_UVs.data() + 2 * a_Vertex;
+    const float* t_Vertex = a_Mesh.m_Vertices.data() + 3 * a_Vertex;
+    const float* t_Normal = a_Mesh.m_Normals.data() + 3 * a_Vertex;
+    Point t_Point, t_TangentU, t_TangentV;
+    evaluate_reference(a_Patch, t_UV[0], t_UV[1], t_Point, t_TangentU, t_TangentV);
+
+    const Point t_Difference = Point(t_Vertex[0], t_Vertex[1], t_Vertex[2]) - t_Point;
+    if(t_Difference.norm() > a_Tolerance)
+    {
+        std::cerr << a_Name << ": vertex " << a_Vertex << " at (" << t_UV[0] << ", " << t_UV[1] << ") is "
+                  << t_Difference.norm() << " away from the patch\n";
+        return false;
+    }
+    // The normal of EvaluatedMeshWriter, only compared where the tangents are far from parallel
+    const Point t_ExpectedNormal = OpenMesh::cross(t_TangentU, t_TangentV);
+    const float t_Length = t_ExpectedNormal.norm();
+    if(t_Length > 0.01f * t_TangentU.norm() * t_TangentV.norm())
+    {
+        const float t_Cosine = OpenMesh::dot(Point(t_Normal[0], t_Normal[1], t_Normal[2]), t_ExpectedNormal) / t_Length;
+        if(t_Cosine < 0.999f)
+        {
+            std::cerr << a_Name << ": the normal of vertex " << a_Vertex << " at (" << t_UV[0] << ", " << t_UV[1]
+                      << ") is off by an angle with cosine " << t_Cosine << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ *  Uniform tessellation: the n x n grid of EvaluatedMeshWriter with its two triangles per cell.
+ */
+static bool check_uniform(const std::vector<Patch>& a_Patches, const Tessellator& a_Tessellator, float a_Tolerance, const std::string& a_Name)
+{
+    TessellatedMesh t_Mesh;
+    a_Tessellator.tessellate(a_Patches.data(), a_Patches.size(), t_Mesh, 0);
+
+    const int n = a_Tessellator.getResolution();
+    const size_t t_NumVertices = a_Tessellator.numVerticesPerPatch();
+    const size_t t_NumIndices = a_Tessellator.numIndicesPerPatch();
+    if(t_Mesh.m_Vertices.size() != 3 * t_NumVertices * a_Patches.size() || t_Mesh.m_Indices.size() != t_NumIndices * a_Patches.size())
+    {
+        std::cerr << a_Name << ": the uniform tessellation has the wrong size\n";
+        return false;
+    }
+    for(size_t p = 0; p < a_Patches.size(); ++p)
+    {
+        const uint32_t t_First = static_cast<uint32_t>(p * t_NumVertices);
+        const uint32_t* t_Indices = t_Mesh.m_Indices.data() + p * t_NumIndices;
+        for(int i = 0; i < n; ++i)
+        {
+            for(int j = 0; j < n; ++j)
+            {
+                const size_t t_Vertex = t_First + i * n + j;
+                const float* t_UV = t_Mesh.m_UVs.data() + 2 * t_Vertex;
+                if(t_UV[0] != static_cast<float>(i) / (n - 1) || t_UV[1] != static_cast<float>(j) / (n - 1))
+                {
+                    std::cerr << a_Name << ": vertex " << t_Vertex << " has the wrong parameters\n";
+                    return false;
+                }
+                if(!is_on_patch(a_Patches[p], t_Mesh, t_Vertex, a_Tolerance, a_Name + " (uniform)"))
+                {
+                    return false;
+                }
+                if(i == n - 1 || j == n - 1)
+                {
+                    continue;
+                }
+                const uint32_t t_V00 = t_First + i * n + j;
+                const uint32_t t_V10 = t_V00 + n;
+                const uint32_t t_V01 = t_V00 + 1;
+                const uint32_t t_V11 = t_V10 + 1;
+                const uint32_t t_Expected[6] = {t_V00, t_V10, t_V01, t_V10, t_V11, t_V01};
+                if(!std::equal(t_Expected, t_Expected + 6, t_Indices + (i * (n - 1) + j) * 6))
+                {
+                    std::cerr << a_Name << ": the triangles of cell (" << i << ", " << j << ") of patch " << p << " differ\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ *  Adaptive tessellation within a_Scale / 100: every vertex lies on its patch, every index is valid
+ *  and no patch gets more triangles than uniformly.
+ */
+static bool check_adaptive(const std::vector<Patch>& a_Patches, const Tessellator& a_Tessellator, float a_Tolerance, float a_Scale, const std::string& a_Name)
+{
+    const size_t t_MaxIndices = a_Tessellator.numIndicesPerPatch();
+    TessellatedMesh t_Mesh;
+    for(size_t p = 0; p < a_Patches.size(); ++p)
+    {
+        const size_t t_FirstVertex = t_Mesh.m_UVs.size() / 2;
+        const size_t t_FirstIndex = t_Mesh.m_Indices.size();
+        a_Tessellator.tessellateAdaptive(a_Patches[p], 0.01f * a_Scale, t_Mesh);
+
+        const size_t t_NumVertices = t_Mesh.m_UVs.size() / 2;
+        if(t_Mesh.m_Indices.size() - t_FirstIndex > t_MaxIndices)
+        {
+            std::cerr << a_Name << ": patch " << p << " has more triangles than the uniform tessellation\n";
+            return false;
+        }
+        for(size_t k = t_FirstIndex; k < t_Mesh.m_Indices.size(); ++k)
+        {
+            if(t_Mesh.m_Indices[k] < t_FirstVertex || t_Mesh.m_Indices[k] >= t_NumVertices)
+            {
+                std::cerr << a_Name << ": patch " << p << " has a triangle with a vertex of another patch\n";
+                return false;
+            }
+        }
+        for(size_t v = t_FirstVertex; v < t_NumVertices; ++v)
+        {
+            if(!is_on_patch(a_Patches[p], t_Mesh, v, a_Tolerance, a_Name + " (adaptive)"))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " file.obj [file.obj ...]\n";
+        return 1;
+    }
+
+    const Tessellator t_Tessellator(16);
+    int t_NumFailed = 0;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string t_File = argv[i];
+
+        MeshType t_Mesh;
+        if(!OpenMesh::IO::read_mesh(t_Mesh, t_File))
+        {
+            std::cerr << t_File << ": OpenMesh cannot read the file\n";
+            ++t_NumFailed;
+            continue;
+        }
+        PatchCollector t_Collector;
+        process_mesh(t_Mesh, &t_Collector, false);
+
+        // Float evaluation in a different order differs by a few units in the last place of the largest coordinate
+        float t_Scale = 1.0f;
+        for(const Patch& t_Patch : t_Collector.m_Patches)
+        {
+            for(float t_Coef : t_Patch.m_Coefs)
+            {
+                t_Scale = std::max(t_Scale, std::abs(t_Coef));
+            }
+        }
+        const float t_Tolerance = 1e-4f * t_Scale;
+
+        const bool t_IsSame = check_uniform(t_Collector.m_Patches, t_Tessellator, t_Tolerance, t_File)
+                           && check_adaptive(t_Collector.m_Patches, t_Tessellator, t_Tolerance, t_Scale, t_File);
+
+        std::cout << (t_IsSame ? "OK     " : "FAILED ") << t_File << " (" << t_Collector.m_Patches.size() << " patches)\n";
+        t_NumFailed += t_IsSame ? 0 : 1;
+    }
+    return t_NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+# copyright(c)Jorg Peters [jorg.peters@gmail.com]
+#
+# Converts the mask tables (CSV) into constexpr double arrays so that no text is parsed at run time.
+# Run in script mode:
+#   cmake -DTABLE_DIR=<dir with *.csv> -DOUTPUT=<generated .cpp> -P EmbedTables.cmake
+#
+# Lines that are empty or start with '#' are skipped. Missing values in a row are zero.
+
+if(NOT TABLE_DIR OR NOT OUTPUT)
+    message(FATAL_ERROR "EmbedTables.cmake requires TABLE_DIR and OUTPUT")
+endif()
+
+file(GLOB TABLE_FILES "${TABLE_DIR}/*.csv")
+list(SORT TABLE_FILES)
+
+set(TABLE_ARRAYS "")
+set(TABLE_ENTRIES "")
+set(TABLE_INDEX 0)
+foreach(TABLE_FILE ${TABLE_FILES})
+    get_filename_component(FILENAME ${TABLE_FILE} NAME)
+    file(STRINGS ${TABLE_FILE} LINES)
+
+    # First pass: table dimensions
+    set(ROWS 0)
+    set(COLS 0)
+    set(DATA_LINES "")
+    foreach(LINE IN LISTS LINES)
+        string(STRIP "${LINE}" LINE)
+        if(LINE STREQUAL "" OR LINE MATCHES "^#")
+            continue()
+        endif()
+        string(REPLACE "," ";" VALUES "${LINE}")
+        list(LENGTH VALUES NUM_VALUES)
+        if(NUM_VALUES GREATER COLS)
+            set(COLS ${NUM_VALUES})
+        endif()
+        math(EXPR ROWS "${ROWS} + 1")
+        list(APPEND DATA_LINES "${LINE}")
+    endforeach()
+
+    # Second pass: one line of the array per row, padded to COLS values
+    set(ARRAY_BODY "")
+    foreach(LINE IN LISTS DATA_LINES)
+        string(REPLACE "," ";" VALUES "${LINE}")
+        set(ROW_TEXT "")
+        set(NUM_WRITTEN 0)
+        foreach(VALUE IN LISTS VALUES)
+            string(STRIP "${VALUE}" VALUE)
+            if(VALUE STREQUAL "")
+                set(VALUE "0")
+            endif()
+            string(APPEND ROW_TEXT "${VALUE},")
+            math(EXPR NUM_WRITTEN "${NUM_WRITTEN} + 1")
+        endforeach()
+        while(NUM_WRITTEN LESS COLS)
+            string(APPEND ROW_TEXT "0,")
+            math(EXPR NUM_WRITTEN "${NUM_WRITTEN} + 1")
+        endwhile()
+        string(APPEND ARRAY_BODY "    ${ROW_TEXT}\n")
+    endforeach()
+
+    set(ARRAY_NAME "g_Table${TABLE_INDEX}")
+    string(APPEND TABLE_ARRAYS "// ${FILENAME}: ${ROWS} x ${COLS}\nconstexpr double ${ARRAY_NAME}[] = {\n${ARRAY_BODY}};\n\n")
+    string(APPEND TABLE_ENTRIES "    { \"${FILENAME}\", ${ROWS}, ${COLS}, ${ARRAY_NAME} },\n")
+    math(EXPR TABLE_INDEX "${TABLE_INDEX} + 1")
+endforeach()
+
+set(CONTENT "// Generated by cmake/EmbedTables.cmake from ${TABLE_DIR}. Do not edit.\n\n")
+string(APPEND CONTENT "#include \"Helper/EmbeddedTables.hpp\"\n#include <cstring>\n\n")
+string(APPEND CONTENT "namespace\n{\n\n${TABLE_ARRAYS}")
+string(APPEND CONTENT "constexpr EmbeddedTable g_Tables[] = {\n${TABLE_ENTRIES}};\n\n} // end of anonymous namespace\n\n")
+string(APPEND CONTENT "const EmbeddedTable* find_embedded_table(const char* a_Name)\n{\n")
+string(APPEND CONTENT "    for(const auto& t_Table : g_Tables)\n    {\n")
+string(APPEND CONTENT "        if(std::strcmp(t_Table.m_Name, a_Name) == 0)\n        {\n            return &t_Table;\n        }\n    }\n")
+string(APPEND CONTENT "    return nullptr;\n}\n")
+
+file(WRITE "${OUTPUT}" "${CONTENT}")
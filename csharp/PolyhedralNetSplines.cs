@@ -562,6 +562,8 @@ namespace PolyhedralNetSplines
 
         /// <summary>
         /// Indices of PNS patch neighborhood that are used to generate patches.
+        /// Entry i belongs to column i of the mask. For patches of a subdivided region
+        /// the order is not the order of first appearance, pair the entries with the mask columns.
         /// </summary>
         public int[] NeighborVerts
         {
@@ -807,6 +809,24 @@ namespace PolyhedralNetSplines
             return coefs;
         }
 
+        /// <summary>
+        /// Bernstein-Bézier control points as one flat array, copied in a single call.
+        /// </summary>
+        /// <returns>(DegU+1)*(DegV+1) control points of 3 floats each; coordinate k of [i][j] is at (i*(DegV+1)+j)*3+k</returns>
+        public float[] GetFlatBBCoefs()
+        {
+            int size = (DegU + 1) * (DegV + 1) * 3;
+            float[] flatCoefs = new float[size];
+            PatchGetBBCoefs_Interop(Handle, flatCoefs, size);
+            return flatCoefs;
+        }
+
+        /// <summary>
+        /// Pointer to the native coefficient buffer laid out as in <see cref="GetFlatBBCoefs"/>.
+        /// Valid until the patch is modified or disposed.
+        /// </summary>
+        public IntPtr BBCoefsPointer => PatchGetBBCoefsPtr_Interop(Handle);
+
         /// <summary>
         /// Elevate degree up to 3.
         /// </summary>
@@ -833,6 +853,9 @@ namespace PolyhedralNetSplines
         [DllImport("PolyhedralSplinesLib", CallingConvention = CallingConvention.Cdecl)]
         private static extern void PatchGetBBCoefs_Interop(IntPtr patch, [Out] float[] coefs, int size);
 
+        [DllImport("PolyhedralSplinesLib", CallingConvention = CallingConvention.Cdecl)]
+        private static extern IntPtr PatchGetBBCoefsPtr_Interop(IntPtr patch);
+
         [DllImport("PolyhedralSplinesLib", CallingConvention = CallingConvention.Cdecl)]
         private static extern void PatchDegRaise_Interop(IntPtr patch);
     }
@@ -1,5 +1,6 @@
 #include "ProcessMesh.hpp"
 #include "Helper/Helper.hpp"
+#include "Helper/MeshBuilder.hpp"
 #include "Patch/PatchBuilder.hpp"
 #include "PatchConsumer/PatchConsumer.hpp"
 #include "Patch/Patch.hpp"
@@ -12,6 +13,7 @@
 #include "api/PnSPatch_impl.hpp"
 
 #include <OpenMesh/Core/IO/MeshIO.hh>
+#include <algorithm>
 #include <vector>
 
 extern "C"
@@ -43,28 +45,16 @@ extern "C"
     MeshType* MeshFromData_Interop(const float* vertices, int vertexCount, const int* faceIndices, const int* faceSizes, int faceCount)
     {
         MeshType* mesh = new MeshType();
-        
-        std::vector<MeshType::VertexHandle> vertexHandles;
-        for (int i = 0; i < vertexCount; i++) {
-            float x = vertices[i*3];
-            float y = vertices[i*3+1];
-            float z = vertices[i*3+2];
-            vertexHandles.push_back(mesh->add_vertex(MeshType::Point(x, y, z)));
-        }
-        
-        int indexOffset = 0;
+
+        // Flat arrays for Helper::build_mesh, which skips faces with an index out of range
+        std::vector<double> points(vertices, vertices + 3 * static_cast<size_t>(vertexCount));
+        std::vector<uint64_t> offsets(faceCount + 1, 0);
         for (int i = 0; i < faceCount; i++) {
-            int size = faceSizes[i];
-            std::vector<MeshType::VertexHandle> faceVerts;
-            for (int j = 0; j < size; j++) {
-                int idx = faceIndices[indexOffset + j];
-                if (idx < 0 || idx >= vertexCount) continue;
-                faceVerts.push_back(vertexHandles[idx]);
-            }
-            mesh->add_face(faceVerts);
-            indexOffset += size;
+            offsets[i + 1] = offsets[i] + faceSizes[i];
         }
-        
+        std::vector<uint32_t> indices(faceIndices, faceIndices + offsets[faceCount]);
+        Helper::build_mesh(*mesh, points.data(), vertexCount, indices.data(), offsets.data(), faceCount);
+
         return mesh;
     }
     
@@ -145,27 +135,14 @@ extern "C"
                                              const int* faceIndices, const int* faceSizes, 
                                              int faceCount, bool degRaise)
     {
-        std::vector<std::array<double, 3>> controlPoints;
-        controlPoints.reserve(vertexCount);
-        for (int i = 0; i < vertexCount; i++) {
-            controlPoints.push_back({vertices[i*3], vertices[i*3+1], vertices[i*3+2]});
-        }
-
-        std::vector<std::vector<uint>> controlIndices;
-        controlIndices.reserve(faceCount);
-        
-        int offset = 0;
+        // The points and indices are passed in place, int and uint32_t indices share their representation
+        std::vector<uint64_t> faceOffsets(faceCount + 1, 0);
         for (int i = 0; i < faceCount; i++) {
-            std::vector<uint> face;
-            face.reserve(faceSizes[i]);
-            for (uint64_t j = 0; j < faceSizes[i]; j++) {
-                face.push_back(faceIndices[offset + j]);
-            }
-            controlIndices.push_back(face);
-            offset += faceSizes[i];
+            faceOffsets[i + 1] = faceOffsets[i] + faceSizes[i];
         }
 
-        return new PnSpline(controlPoints, controlIndices, degRaise);
+        return new PnSpline(vertices, vertexCount, reinterpret_cast<const uint32_t*>(faceIndices),
+                            faceOffsets.data(), faceCount, degRaise);
     }
 
     void PnSplineDestroy_Interop(PnSpline* spline)
@@ -206,14 +183,9 @@ extern "C"
 
         std::vector<uint32_t> indices(updateIndices, updateIndices + numIndices);
         
-        auto result = spline->updateControlMesh(updatedControlPoints, indices);
+        uint64_t numUpdated = spline->updateControlMesh(updatedControlPoints, indices, outPatchIndices, std::max(maxOut, 0));
         
-        uint32_t count = std::min(static_cast<uint32_t>(result.size()), static_cast<uint32_t>(maxOut));
-        for (uint32_t i = 0; i < count; i++) {
-            outPatchIndices[i] = result[i];
-        }
-        
-        return count;
+        return static_cast<uint32_t>(std::min<uint64_t>(numUpdated, std::max(maxOut, 0)));
     }
 
 //-----------------------------------------------------------------------------
@@ -360,7 +332,7 @@ extern "C"
     
     const char* PatchGetGroup_Interop(const Patch* patch) {
         if (!patch) return "";
-        return patch->m_Group.c_str();
+        return patch->getGroup().c_str();
     }
     
     bool PatchIsValid_Interop(const Patch* patch) {
@@ -369,22 +341,15 @@ extern "C"
     }
     
     void PatchGetBBCoefs_Interop(const Patch* patch, float* coefs, int size) {
-        if (!patch) return;
-        int rows = patch->m_BBcoefs.size();
-        if (rows == 0) return;
-        
-        int cols = patch->m_BBcoefs[0].size();
-        int index = 0;
-        
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                if (index + 2 >= size) return;
-                const auto& pt = patch->m_BBcoefs[i][j];
-                coefs[index++] = pt[0];
-                coefs[index++] = pt[1];
-                coefs[index++] = pt[2];
-            }
-        }
+        if (!patch || size <= 0) return;
+        // Whole control points only
+        size_t count = std::min(patch->size(), static_cast<size_t>(size) / 3 * 3);
+        std::copy_n(patch->data(), count, coefs);
+    }
+    
+    const float* PatchGetBBCoefsPtr_Interop(const Patch* patch) {
+        if (!patch) return nullptr;
+        return patch->data();
     }
     
     void PatchDegRaise_Interop(Patch* patch) {
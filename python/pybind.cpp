@@ -1,13 +1,17 @@
 #define OM_STATIC_BUILD
 #include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
 #include <pybind11/stl.h>
 
 #include "ProcessMesh.hpp"
 #include "Helper/Helper.hpp"
+#include "Helper/MeshBuilder.hpp"
+#include "Helper/Tessellator.hpp"
 #include "Patch/PatchBuilder.hpp"
 #include "PatchConsumer/PatchConsumer.hpp"
 #include "Patch/Patch.hpp"
 #include "PatchConsumer/BVWriter.hpp"
+#include "PatchConsumer/BinaryBVWriter.hpp"
 #include "PatchConsumer/IGSWriter.hpp"
 #include "PatchConsumer/STEPWriter.hpp"
 
@@ -39,21 +43,64 @@ PYBIND11_MODULE(polyhedral_net_splines, m) {
         )pbdoc")
         .def(py::init<>())
         .def_static("from_data",
-            [](py::list verts, py::list faces) {
+            [](py::array_t<double, py::array::c_style | py::array::forcecast> points,
+               py::array_t<uint32_t, py::array::c_style | py::array::forcecast> indices,
+               py::array_t<uint64_t, py::array::c_style | py::array::forcecast> offsets) {
+                if (points.ndim() != 2 || points.shape(1) != 3) {
+                    throw py::value_error("points must have shape (N, 3)");
+                }
+                if (indices.ndim() != 1 || offsets.ndim() != 1 || offsets.size() < 1) {
+                    throw py::value_error("indices and offsets must be one-dimensional, offsets needs at least one entry");
+                }
+                const uint64_t* t_Offsets = offsets.data();
+                for (py::ssize_t f = 0; f < offsets.size(); ++f) {
+                    if ((f == 0 && t_Offsets[f] != 0) || (f > 0 && t_Offsets[f] < t_Offsets[f - 1])) {
+                        throw py::value_error("offsets must start at 0 and be non-decreasing");
+                    }
+                }
+                if (t_Offsets[offsets.size() - 1] != static_cast<uint64_t>(indices.size())) {
+                    throw py::value_error("the last offset must be the number of indices");
+                }
                 MeshType mesh;
-                std::vector<MeshType::VertexHandle> vertex_handles;
+                Helper::build_mesh(mesh, points.data(), points.shape(0), indices.data(), t_Offsets, offsets.size() - 1);
+                return mesh;
+            }, py::arg("points"), py::arg("indices"), py::arg("offsets"), R"pbdoc(
+                Build a control mesh from numpy arrays, without a Python
+                loop over vertices or faces. Arrays of the listed types
+                that are C contiguous are used in place, others are
+                converted first.
+
+                Args:
+                    points (numpy.ndarray[float64]):
+                        (N, 3) vertex coordinates.
+                    indices (numpy.ndarray[uint32]):
+                        Vertex indices of all faces, one face after the other.
+                    offsets (numpy.ndarray[uint64]):
+                        F + 1 offsets into ``indices``. Face f has the
+                        vertices ``indices[offsets[f]:offsets[f+1]]``.
+
+                Returns:
+                    Pns_control_mesh: Newly-constructed control net.
+                )pbdoc")
+        .def_static("from_data",
+            [](py::list verts, py::list faces) {
+                std::vector<double> points;
+                points.reserve(3 * verts.size());
                 for (auto v: verts){
                     auto [x, y, z] = v.cast<std::tuple<double, double, double>>();
-                    vertex_handles.push_back(mesh.add_vertex({x, y, z}));
+                    points.insert(points.end(), {x, y, z});
                 }
+                std::vector<uint32_t> indices;
+                std::vector<uint64_t> offsets(1, 0);
+                offsets.reserve(faces.size() + 1);
                 for (auto f: faces){
-                    std::vector<int> indices = f.cast<std::vector<int>>();
-                    std::vector<MeshType::VertexHandle> face_handles;
-                    for (int i: indices){
-                        face_handles.push_back(vertex_handles[i]);
+                    for (int i: f.cast<std::vector<int>>()){
+                        indices.push_back(static_cast<uint32_t>(i));
                     }
-                    mesh.add_face(face_handles);
+                    offsets.push_back(indices.size());
                 }
+                MeshType mesh;
+                Helper::build_mesh(mesh, points.data(), verts.size(), indices.data(), offsets.data(), faces.size());
                 return mesh;
             }, R"pbdoc(
                 Build a control mesh from raw data.
@@ -146,20 +193,30 @@ PYBIND11_MODULE(polyhedral_net_splines, m) {
                     of one face.
                 )pbdoc");
     
-    py::class_<Patch>(m, "Patch", R"pbdoc(
+    py::class_<Patch>(m, "Patch", py::buffer_protocol(), R"pbdoc(
         Single Bézier patch produced by a ``PatchBuilder``.
+
+        The patch exposes its control points through the buffer protocol without copying:
+        ``memoryview(patch)`` or ``numpy.asarray(patch)`` is a float32 array of shape
+        ``(deg_u + 1, deg_v + 1, 3)``.
     )pbdoc")
+        .def_buffer([](Patch& p) -> py::buffer_info {
+            return py::buffer_info(
+                p.data(), sizeof(float), py::format_descriptor<float>::format(), 3,
+                { p.m_DegU + 1, p.m_DegV + 1, 3 },
+                { sizeof(float) * 3 * (p.m_DegV + 1), sizeof(float) * 3, sizeof(float) });
+        })
         .def_property_readonly("deg_u", [](Patch& p){ return p.m_DegU; })
         .def_property_readonly("deg_v", [](Patch& p){ return p.m_DegV; })
-        .def_property_readonly("group", [](Patch& p){ return p.m_Group; })
+        .def_property_readonly("group", [](Patch& p){ return p.getGroup(); })
         .def_property_readonly("is_valid", &Patch::isValid)
         .def_property_readonly("bb_coefs",
             [](Patch& p){
             py::list rows;
-            for(auto& row: p.m_BBcoefs) {
+            for(int i = 0; i <= p.m_DegU; i++) {
                 py::list cols;
-                for(auto& pt: row)
-                cols.append(py::make_tuple(pt[0],pt[1],pt[2]));
+                for(int j = 0; j <= p.m_DegV; j++)
+                cols.append(py::make_tuple(p(i,j,0),p(i,j,1),p(i,j,2)));
                 rows.append(cols);
             }
             return rows;
@@ -192,6 +249,9 @@ PYBIND11_MODULE(polyhedral_net_splines, m) {
                 return indices;
             }, R"pbdoc(
                 Indices of Pns patch neighborhood that are use to generate patches.
+                Entry i belongs to column i of ``mask``. For patches of a
+                subdivided region the order is not the order of first
+                appearance, pair the entries with the mask columns.
 
                 Returns:
                     List[int]
@@ -245,11 +305,14 @@ PYBIND11_MODULE(polyhedral_net_splines, m) {
     m.def("get_patch_builders",
             &getPatchBuilders,
             py::arg("mesh"),
+            py::arg("num_threads") = 1,
             R"pbdoc(
             Creates a ``PatchBuilder`` for each Pns patch type that are found in the control mesh.
 
             Args:
                 mesh (Pns_control_mesh)
+                num_threads (int, optional):
+                    Number of threads used to identify the patches. ``0`` uses all hardware threads. Default is ``1``.
 
             Returns:
                 List[PatchBuilder]
@@ -308,6 +371,14 @@ PYBIND11_MODULE(polyhedral_net_splines, m) {
         .def("start", &BVWriter::start)
         .def("stop", &BVWriter::stop)
         .def("consume", &BVWriter::consume);
+    py::class_<BinaryBVWriter, PatchConsumer>(m, "BinaryBVWriter", R"pbdoc(
+        Binary BV writer. The file can be memory mapped and read without parsing.
+    )pbdoc")
+        .def(py::init<const std::string&, bool>(), py::arg("filename"), py::arg("double_precision") = false,
+             "Args:\n    filename (str): Destination file.\n    double_precision (bool): Store float64 instead of float32 coefficients.")
+        .def("start", &BinaryBVWriter::start)
+        .def("stop", &BinaryBVWriter::stop)
+        .def("consume", &BinaryBVWriter::consume);
     py::class_<IGSWriter, PatchConsumer>(m, "IGSWriter", R"pbdoc(
         *.igs* (IGES) surface writer.
     )pbdoc")
@@ -322,11 +393,57 @@ PYBIND11_MODULE(polyhedral_net_splines, m) {
         .def("start", &STEPWriter::start)
         .def("stop", &STEPWriter::stop)
         .def("consume", &STEPWriter::consume);
+    m.def("tessellate",
+        [](const std::vector<Patch>& patches, float tolerance, int resolution, int num_threads) {
+            const Tessellator t_Tessellator(resolution);
+            TessellatedMesh t_Mesh;
+            if (tolerance > 0) {
+                t_Tessellator.tessellateAdaptive(patches.data(), patches.size(), tolerance, t_Mesh, num_threads);
+            } else {
+                t_Tessellator.tessellate(patches.data(), patches.size(), t_Mesh, num_threads);
+            }
+            const py::ssize_t t_NumVertices = t_Mesh.m_Vertices.size() / 3;
+            py::array_t<float> vertices({t_NumVertices, py::ssize_t(3)});
+            py::array_t<float> normals({t_NumVertices, py::ssize_t(3)});
+            py::array_t<float> uvs({t_NumVertices, py::ssize_t(2)});
+            py::array_t<uint32_t> indices({static_cast<py::ssize_t>(t_Mesh.m_Indices.size() / 3), py::ssize_t(3)});
+            std::copy(t_Mesh.m_Vertices.begin(), t_Mesh.m_Vertices.end(), vertices.mutable_data());
+            std::copy(t_Mesh.m_Normals.begin(), t_Mesh.m_Normals.end(), normals.mutable_data());
+            std::copy(t_Mesh.m_UVs.begin(), t_Mesh.m_UVs.end(), uvs.mutable_data());
+            std::copy(t_Mesh.m_Indices.begin(), t_Mesh.m_Indices.end(), indices.mutable_data());
+            return py::make_tuple(vertices, normals, uvs, indices);
+        },
+        py::arg("patches"),
+        py::arg("tolerance") = 0.0f,
+        py::arg("resolution") = 16,
+        py::arg("num_threads") = 1,
+        R"pbdoc(
+            Triangulates patches for display.
+
+            Args:
+                patches (List[Patch]):
+                    The patches, e.g. from ``PatchBuilder.build_patches``.
+                tolerance (float, optional):
+                    ``0`` samples every patch uniformly on a ``resolution`` x ``resolution`` grid. A positive value
+                    chooses the samples of each patch so that the triangles are within ``tolerance`` of it, using at
+                    most as many as the uniform grid. Adjacent patches meet without cracks. Default is ``0``.
+                resolution (int, optional):
+                    Samples per parameter direction of the uniform grid, at least 2. Default is ``16``.
+                num_threads (int, optional):
+                    Number of threads. ``0`` uses all hardware threads. Default is ``1``.
+
+            Returns:
+                Tuple[numpy.ndarray, numpy.ndarray, numpy.ndarray, numpy.ndarray]:
+                    float32 vertices (V, 3), float32 unit normals (V, 3), float32 patch parameters (V, 2)
+                    and uint32 triangles (T, 3). Patches do not share vertices.
+        )pbdoc");
     m.def("process_mesh",
         &process_mesh,
         py::arg("Pns_control_mesh"),
         py::arg("PatchConsumer"),
         py::arg("is_deg_raise") = false,
+        py::arg("num_threads") = 1,
+        py::arg("ordered") = true,
         R"pbdoc(
             Constructs a Pns surface using a control net and writes it using a give consumer.
 
@@ -337,6 +454,10 @@ PYBIND11_MODULE(polyhedral_net_splines, m) {
                     Active consumer instance (e.g. ``BVWriter``).
                 is_deg_raise (bool, optional):
                     Raise degree to 3. Default is ``False``.
+                num_threads (int, optional):
+                    Number of threads used to identify and build the patches. ``0`` uses all hardware threads. Default is ``1``.
+                ordered (bool, optional):
+                    With more than one thread, keep the order in which patches reach the consumer. Default is ``True``.
 
             Returns:
                 None
@@ -0,0 +1,33 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+/**
+ * \ingroup utility
+ * @brief A mask table compiled into the binary. The tables in src/Patch/Table are converted at build time
+ * by cmake/EmbedTables.cmake into constant arrays, so no text is parsed at run time.
+ */
+struct EmbeddedTable
+{
+    /**
+     * @brief File name of the source table, e.g. "eopSct3.csv".
+     */
+    const char* m_Name;
+    int m_Rows;
+    int m_Cols;
+    /**
+     * @brief m_Rows * m_Cols values in row-major order.
+     */
+    const double* m_Data;
+};
+
+/**
+ * \ingroup utility
+ * @brief Find an embedded table by the file name of its source table.
+ *
+ * Defined in the source file generated by cmake/EmbedTables.cmake.
+ *
+ * @param a_Name File name of the source table.
+ * @return The table, or nullptr if there is no table with that name.
+ */
+const EmbeddedTable* find_embedded_table(const char* a_Name);
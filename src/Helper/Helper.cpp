@@ -2,6 +2,7 @@
 
 #include "Helper.hpp"
 #include "HalfedgeOperation.hpp"
+#include "MeshTopologyCache.hpp"
 #include <iostream>
 #include <cmath>
 #include <unordered_set>
@@ -26,6 +27,10 @@ namespace Helper
  */
 int get_vert_valence(const MeshType& a_Mesh, const VertexHandle& a_VertexHandle)
 {
+    if(const MeshTopologyCache* t_Cache = MeshTopologyCache::current(a_Mesh))
+    {
+        return t_Cache->valence(a_VertexHandle);
+    }
     return a_Mesh.valence(a_VertexHandle);
 }
 
@@ -259,6 +264,16 @@ void set_vert_vector_to_default(const int a_Size, std::vector<VertexHandle>& a_V
 std::vector<FaceHandle> get_faces_around_vert_counterclock(const MeshType& a_Mesh, const VertexHandle& a_VertHandle)
 {
     std::vector<FaceHandle> t_Faces;
+    const MeshTopologyCache* t_Cache = MeshTopologyCache::current(a_Mesh);
+    if(t_Cache != nullptr && t_Cache->hasRings())
+    {
+        const uint32_t* t_Ring = t_Cache->facesAround(a_VertHandle);
+        for(size_t i = 0; i < t_Cache->numFacesAround(a_VertHandle); i++)
+        {
+            t_Faces.push_back(FaceHandle(t_Ring[i]));
+        }
+        return t_Faces;
+    }
     for(auto t_VFIt = a_Mesh.cvf_ccwiter(a_VertHandle); t_VFIt.is_valid(); ++t_VFIt)
     {
         t_Faces.push_back(*t_VFIt);
@@ -525,8 +540,18 @@ std::vector<FaceHandle> init_neighbor_faces(const MeshType& a_Mesh, const FaceHa
 {
     std::vector<FaceHandle> t_NBFaceHandles;
 
+    const MeshTopologyCache* t_Cache = MeshTopologyCache::current(a_Mesh);
     for (auto t_FVIt = a_Mesh.cfv_iter(a_FaceHandle); t_FVIt.is_valid(); ++t_FVIt)
     {
+        if (t_Cache != nullptr && t_Cache->hasRings())
+        {
+            const uint32_t* t_Ring = t_Cache->facesAround(*t_FVIt);
+            for (size_t i = 0; i < t_Cache->numFacesAround(*t_FVIt); ++i)
+            {
+                t_NBFaceHandles.push_back(FaceHandle(t_Ring[i]));
+            }
+            continue;
+        }
         for (auto t_VFIt = a_Mesh.cvf_iter(*t_FVIt); t_VFIt.is_valid(); ++t_VFIt)
         {
             t_NBFaceHandles.push_back(*t_VFIt);
@@ -633,6 +658,10 @@ bool is_only_surrounded_by_quad(const MeshType& a_Mesh, const VertexHandle& a_Ve
  */
 int get_num_of_verts_for_face(const MeshType& a_Mesh, const FaceHandle& a_FaceHandle)
 {
+    if(const MeshTopologyCache* t_Cache = MeshTopologyCache::current(a_Mesh))
+    {
+        return t_Cache->faceSize(a_FaceHandle);
+    }
     return a_Mesh.valence(a_FaceHandle);
 }
 
@@ -878,7 +907,15 @@ Matrix verthandles_to_points_mat(const MeshType& a_Mesh, const std::vector<Verte
 
     for(int i=0; i<t_NumOfVerts; i++)
     {
-        t_PointMat(i) = verthandles_to_point_vec(a_Mesh, a_VertHandle[i]);
+        // Invalid handles stay at the origin
+        if(a_VertHandle[i].is_valid())
+        {
+            const auto& t_Point = a_Mesh.point(a_VertHandle[i]);
+            double* t_Row = t_PointMat.row(i);
+            t_Row[0] = t_Point[0];
+            t_Row[1] = t_Point[1];
+            t_Row[2] = t_Point[2];
+        }
     }
     return t_PointMat;
 }
@@ -899,7 +936,10 @@ Patch points_mat_to_patch(const Matrix& a_PointMat)
     Patch t_Patch(t_PointsPerCol-1);
     for(int i=0; i<a_PointMat.getRows(); i++)
     {
-        t_Patch.m_BBcoefs[i/t_PointsPerCol][i%t_PointsPerCol] = {a_PointMat(i,0),a_PointMat(i,1),a_PointMat(i,2)};
+        for(int k=0; k<3; k++)
+        {
+            t_Patch(i/t_PointsPerCol, i%t_PointsPerCol, k) = a_PointMat(i,k);
+        }
     }
     return t_Patch;
 }
@@ -921,7 +961,10 @@ Patch points_mat_to_patch(const int a_PatchDegU, const int a_PatchDegV, const Ma
         for(int j=0; j<a_PatchDegV+1; j++)
         {
             int t_Index = i * (a_PatchDegV+1) + j;
-            t_Patch.m_BBcoefs[i][j] = {a_PointMat(t_Index,0),a_PointMat(t_Index,1),a_PointMat(t_Index,2)};
+            for(int k=0; k<3; k++)
+            {
+                t_Patch(i, j, k) = a_PointMat(t_Index,k);
+            }
         }
     }
     return t_Patch;
@@ -945,7 +988,10 @@ Patch points_mat_to_patch(const int a_PatchDegU, const int a_PatchDegV, const st
         for(int j=0; j<a_PatchDegV+1; j++)
         {
             int t_Index = i * (a_PatchDegV+1) + j;
-            t_Patch.m_BBcoefs[i][j] = {a_PointMat(t_Index,0),a_PointMat(t_Index,1),a_PointMat(t_Index,2)};
+            for(int k=0; k<3; k++)
+            {
+                t_Patch(i, j, k) = a_PointMat(t_Index,k);
+            }
         }
     }
     return t_Patch;
@@ -970,7 +1016,10 @@ Patch points_mat_to_patch(const int a_PatchDegU, const int a_PatchDegV, const st
         for(int j=0; j<a_PatchDegV+1; j++)
         {
             int t_Index = a_StartIndex + i * (a_PatchDegV+1) + j;
-            t_Patch.m_BBcoefs[i][j] = {a_PointMat(t_Index,0),a_PointMat(t_Index,1),a_PointMat(t_Index,2)};
+            for(int k=0; k<3; k++)
+            {
+                t_Patch(i, j, k) = a_PointMat(t_Index,k);
+            }
         }
     }
     return t_Patch;
@@ -0,0 +1,101 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#include "Matrix.hpp"
+#include <algorithm>
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+/*
+ * C(N×3) = A(N×K) * B(K×3), all row-major.
+ * B is padded to K×4 so that each row of B is one 4-wide vector (x, y, z, 0). Every row of C is then
+ * a sum of K broadcast-multiply-adds into a single accumulator, two rows of A are processed at a time.
+ */
+static void multiply_nx3(const double* a_A, const int a_N, const int a_K, const double* a_B, double* a_C)
+{
+    // Masks have at most a few dozen columns; keep the padded copy of B on the stack when possible.
+    const int t_MaxStackK = 64;
+    alignas(32) double t_StackB[4 * t_MaxStackK];
+    std::vector<double> t_HeapB;
+    double* t_B = t_StackB;
+    if(a_K > t_MaxStackK)
+    {
+        t_HeapB.resize(4 * static_cast<size_t>(a_K));
+        t_B = t_HeapB.data();
+    }
+    for(int k = 0; k < a_K; k++)
+    {
+        t_B[4*k+0] = a_B[3*k+0];
+        t_B[4*k+1] = a_B[3*k+1];
+        t_B[4*k+2] = a_B[3*k+2];
+        t_B[4*k+3] = 0.0;
+    }
+
+    int i = 0;
+#if defined(__AVX2__) && defined(__FMA__)
+    for(; i + 1 < a_N; i += 2)
+    {
+        const double* t_A0 = a_A + static_cast<size_t>(i) * a_K;
+        const double* t_A1 = t_A0 + a_K;
+        __m256d t_Acc0 = _mm256_setzero_pd();
+        __m256d t_Acc1 = _mm256_setzero_pd();
+        for(int k = 0; k < a_K; k++)
+        {
+            const __m256d t_Row = _mm256_loadu_pd(t_B + 4*k);
+            t_Acc0 = _mm256_fmadd_pd(_mm256_broadcast_sd(t_A0 + k), t_Row, t_Acc0);
+            t_Acc1 = _mm256_fmadd_pd(_mm256_broadcast_sd(t_A1 + k), t_Row, t_Acc1);
+        }
+        alignas(32) double t_Out[8];
+        _mm256_store_pd(t_Out, t_Acc0);
+        _mm256_store_pd(t_Out + 4, t_Acc1);
+        double* t_C = a_C + static_cast<size_t>(i) * 3;
+        t_C[0] = t_Out[0]; t_C[1] = t_Out[1]; t_C[2] = t_Out[2];
+        t_C[3] = t_Out[4]; t_C[4] = t_Out[5]; t_C[5] = t_Out[6];
+    }
+#endif
+    for(; i < a_N; i++)
+    {
+        const double* t_A = a_A + static_cast<size_t>(i) * a_K;
+        double t_Acc[4] = {0.0, 0.0, 0.0, 0.0};
+        for(int k = 0; k < a_K; k++)
+        {
+            const double t_Coef = t_A[k];
+            for(int c = 0; c < 4; c++)
+            {
+                t_Acc[c] += t_Coef * t_B[4*k+c];
+            }
+        }
+        double* t_C = a_C + static_cast<size_t>(i) * 3;
+        t_C[0] = t_Acc[0]; t_C[1] = t_Acc[1]; t_C[2] = t_Acc[2];
+    }
+}
+
+void Matrix::multiply(const Matrix& a_Lhs, const Matrix& a_Rhs, double* a_Out)
+{
+    const int t_N = a_Lhs.getRows();
+    const int t_K = a_Lhs.getCols();
+    const int t_M = a_Rhs.getCols();
+    if(t_M == 3)
+    {
+        multiply_nx3(a_Lhs.data(), t_N, t_K, a_Rhs.data(), a_Out);
+        return;
+    }
+
+    // General case: i-k-j order so that the inner loop streams over contiguous rows of a_Rhs and a_Out
+    std::fill(a_Out, a_Out + static_cast<size_t>(t_N) * t_M, 0.0);
+    for(int i = 0; i < t_N; i++)
+    {
+        const double* t_A = a_Lhs.row(i);
+        double* t_C = a_Out + static_cast<size_t>(i) * t_M;
+        for(int k = 0; k < t_K; k++)
+        {
+            const double t_Coef = t_A[k];
+            const double* t_B = a_Rhs.row(k);
+            for(int j = 0; j < t_M; j++)
+            {
+                t_C[j] += t_Coef * t_B[j];
+            }
+        }
+    }
+}
@@ -3,96 +3,96 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 #include <vector>
 
 typedef std::vector<std::vector<double>> MatNxNd;
 
+/**
+ * \ingroup utility
+ * @brief Dense matrix of doubles stored contiguously in row-major order.
+ *
+ * The masks of all patch types are multiplied with a K×3 matrix of control points,
+ * so the product with a matrix of 3 columns uses a dedicated kernel (AVX2 when enabled at compile time).
+ */
 class Matrix
 {
 public:
-    Matrix(){}
+    Matrix()
+        : m_Rows(0), m_Cols(0) {}
 
-    Matrix(const MatNxNd a_Mat)
-        : m_Mat(a_Mat), m_Rows(a_Mat.size()), m_Cols(a_Mat[0].size()){}
-
-    Matrix(const int a_Rows, const int a_Cols)
-        : m_Rows(a_Rows), m_Cols(a_Cols)
+    Matrix(const MatNxNd& a_Mat)
+        : m_Rows(a_Mat.size()), m_Cols(a_Mat.empty() ? 0 : a_Mat[0].size())
     {
-        initMatrix(m_Mat, m_Rows, m_Cols);
+        m_Data.reserve(static_cast<size_t>(m_Rows) * m_Cols);
+        for(const auto& t_Row : a_Mat)
+        {
+            m_Data.insert(m_Data.end(), t_Row.begin(), t_Row.end());
+        }
     }
 
+    Matrix(const int a_Rows, const int a_Cols)
+        : m_Rows(a_Rows), m_Cols(a_Cols), m_Data(static_cast<size_t>(a_Rows) * a_Cols, 0.0) {}
+
     int getRows() const { return m_Rows; }
     int getCols() const { return m_Cols; }
 
-    std::vector<double>& operator()(int a_Row)
+    /**
+     * @brief Pointer to the first element of a row. The row has getCols() consecutive elements.
+     */
+    double* row(int a_Row)
     {
-        return m_Mat[a_Row];
+        return m_Data.data() + static_cast<size_t>(a_Row) * m_Cols;
     }
 
-    const std::vector<double>& operator()(int a_Row) const
+    const double* row(int a_Row) const
     {
-        return m_Mat[a_Row];
+        return m_Data.data() + static_cast<size_t>(a_Row) * m_Cols;
     }
 
+    /**
+     * @brief Pointer to the row-major storage of getRows() * getCols() elements.
+     */
+    double* data() { return m_Data.data(); }
+    const double* data() const { return m_Data.data(); }
+
     double& operator()(int a_Row, int a_Col)
     {
-        return m_Mat[a_Row][a_Col];
+        return m_Data[static_cast<size_t>(a_Row) * m_Cols + a_Col];
     }
 
     const double& operator()(int a_Row, int a_Col) const
     {
-        return m_Mat[a_Row][a_Col];
+        return m_Data[static_cast<size_t>(a_Row) * m_Cols + a_Col];
     }
 
-    Matrix operator*(Matrix a_Input) const
+    Matrix operator*(const Matrix& a_Input) const
     {
         // check dimensions
         if(m_Cols!=a_Input.getRows())
         {
             std::cout << "Can't multiply two matrices!" << std::endl;
+            return Matrix(m_Rows, a_Input.getCols());
         }
 
-        Matrix t_Output = Matrix(m_Rows, a_Input.getCols());
-
-        for(int i=0; i < m_Rows; i++)
-        {
-            for(int j=0; j < a_Input.getCols(); j++)
-            {
-                for (int k=0; k < m_Cols; k++)
-                {
-                    t_Output(i, j) += m_Mat[i][k] * a_Input(k, j);
-                }
-            }
-        }
+        Matrix t_Output(m_Rows, a_Input.getCols());
+        multiply(*this, a_Input, t_Output.data());
         return t_Output;
     }
 
-    Matrix& operator=(const Matrix& a_Input)
-    {
-        if(this != &a_Input)
-        {
-            m_Rows = a_Input.getRows();
-            m_Cols = a_Input.getCols();
-            m_Mat = a_Input.m_Mat;
-        }
-        return *this;
-    }
+    /**
+     * @brief Computes a_Lhs * a_Rhs into a_Out, which must hold a_Lhs.getRows() * a_Rhs.getCols() elements in row-major order.
+     * The dimensions are not checked.
+     */
+    static void multiply(const Matrix& a_Lhs, const Matrix& a_Rhs, double* a_Out);
 
 private:
     int m_Rows, m_Cols;
-    MatNxNd m_Mat;
-
-    void initMatrix(MatNxNd& a_Mat, const int a_Rows, const int a_Cols)
-    {
-        for(int i=0; i<a_Rows; i++)
-        {
-            std::vector<double> t_RowVec;
-            for(int j=0; j<a_Cols; j++)
-            {
-                t_RowVec.push_back(0);
-            }
-            a_Mat.push_back(t_RowVec);
-        }
-    }
-
+    std::vector<double> m_Data;
 };
+
+/**
+ * \ingroup utility
+ * @brief Immutable matrix shared between owners, used for the masks of \ref PatchBuilder "PatchBuilders".
+ */
+typedef std::shared_ptr<const Matrix> SharedMatrix;
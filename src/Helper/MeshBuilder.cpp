@@ -0,0 +1,206 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#include "MeshBuilder.hpp"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+typedef MeshType::VertexHandle VertexHandle;
+typedef MeshType::EdgeHandle EdgeHandle;
+typedef MeshType::FaceHandle FaceHandle;
+typedef MeshType::HalfedgeHandle HalfedgeHandle;
+typedef MeshType::Point Point;
+
+namespace Helper
+{
+
+/*
+ * Add the points, then the faces one at a time with add_face, which handles non-manifold input.
+ * Faces with a vertex index out of range are skipped.
+ */
+static void build_mesh_incrementally(MeshType& a_Mesh, const double* a_Points, size_t a_NumPoints,
+                                     const uint32_t* a_FaceIndices, const uint64_t* a_FaceOffsets, size_t a_NumFaces)
+{
+    a_Mesh.clear();
+    for(size_t v = 0; v < a_NumPoints; v++)
+    {
+        a_Mesh.add_vertex(Point(a_Points[3 * v], a_Points[3 * v + 1], a_Points[3 * v + 2]));
+    }
+
+    std::vector<VertexHandle> t_FaceVerts;
+    for(size_t f = 0; f < a_NumFaces; f++)
+    {
+        t_FaceVerts.clear();
+        for(uint64_t c = a_FaceOffsets[f]; c < a_FaceOffsets[f + 1]; c++)
+        {
+            if(a_FaceIndices[c] >= a_NumPoints)
+            {
+                std::cerr << "Face " << f << " references vertex " << a_FaceIndices[c] << " out of range, skipped\n";
+                t_FaceVerts.clear();
+                break;
+            }
+            t_FaceVerts.push_back(VertexHandle(a_FaceIndices[c]));
+        }
+        if(!t_FaceVerts.empty())
+        {
+            a_Mesh.add_face(t_FaceVerts);
+        }
+    }
+}
+
+/**
+ * \ingroup helper
+ * @brief Build a mesh from a flat array of points and faces in compressed sparse row form.
+ *
+ * The storage of the mesh is reserved up front and the halfedge connectivity is built in one pass over the faces,
+ * finding shared edges through a table of the edges at their lower vertex instead of circulating around vertices.
+ * The result is the same mesh that adding the faces one at a time with add_face produces, including
+ * the order of edges and the halfedges stored at faces and vertices.
+ * Input that add_face has to repair or reject (faces with fewer than 3 or repeated vertices, indices out of range,
+ * edges with more than two faces, vertices with more than one boundary) falls back to add_face.
+ *
+ * @param a_Mesh The mesh to build, its previous content is removed
+ * @param a_Points x, y, z of a_NumPoints points
+ * @param a_NumPoints The number of points
+ * @param a_FaceIndices Vertex indices of all faces
+ * @param a_FaceOffsets a_NumFaces + 1 offsets, face f has the vertices a_FaceIndices[a_FaceOffsets[f]] to a_FaceIndices[a_FaceOffsets[f+1]-1]
+ * @param a_NumFaces The number of faces
+ */
+void build_mesh(MeshType& a_Mesh, const double* a_Points, size_t a_NumPoints,
+                const uint32_t* a_FaceIndices, const uint64_t* a_FaceOffsets, size_t a_NumFaces)
+{
+    // Validate the faces and count the face edges at their lower vertex
+    std::vector<uint64_t> t_EdgeStart(a_NumPoints + 1, 0);
+    for(size_t f = 0; f < a_NumFaces; f++)
+    {
+        const uint32_t* t_Face = a_FaceIndices + a_FaceOffsets[f];
+        const uint64_t t_Size = a_FaceOffsets[f + 1] - a_FaceOffsets[f];
+        if(a_FaceOffsets[f + 1] < a_FaceOffsets[f] || t_Size < 3)
+        {
+            build_mesh_incrementally(a_Mesh, a_Points, a_NumPoints, a_FaceIndices, a_FaceOffsets, a_NumFaces);
+            return;
+        }
+        for(uint64_t i = 0; i < t_Size; i++)
+        {
+            bool t_IsValid = t_Face[i] < a_NumPoints;
+            for(uint64_t j = 0; j < i && t_IsValid; j++)
+            {
+                t_IsValid = t_Face[j] != t_Face[i];
+            }
+            if(!t_IsValid)
+            {
+                build_mesh_incrementally(a_Mesh, a_Points, a_NumPoints, a_FaceIndices, a_FaceOffsets, a_NumFaces);
+                return;
+            }
+            t_EdgeStart[std::min(t_Face[i], t_Face[(i + 1) % t_Size]) + 1]++;
+        }
+    }
+    for(size_t v = 0; v < a_NumPoints; v++)
+    {
+        t_EdgeStart[v + 1] += t_EdgeStart[v];
+    }
+    const uint64_t t_NumCorners = t_EdgeStart[a_NumPoints];
+
+    a_Mesh.clear();
+    // Closed meshes have half as many edges as face corners, the boundary adds a few
+    a_Mesh.reserve(a_NumPoints, t_NumCorners / 2 + t_NumCorners / 16, a_NumFaces);
+    for(size_t v = 0; v < a_NumPoints; v++)
+    {
+        a_Mesh.add_vertex(Point(a_Points[3 * v], a_Points[3 * v + 1], a_Points[3 * v + 2]));
+    }
+
+    // Edges by their lower vertex, the edges of vertex v are t_Edges[t_EdgeStart[v]] to t_Edges[t_EdgeEnd[v]-1]
+    std::vector<uint32_t> t_Edges(t_NumCorners);
+    std::vector<uint64_t> t_EdgeEnd(t_EdgeStart.begin(), t_EdgeStart.end() - 1);
+    std::vector<HalfedgeHandle> t_Halfedges;
+    for(size_t f = 0; f < a_NumFaces; f++)
+    {
+        const uint32_t* t_Face = a_FaceIndices + a_FaceOffsets[f];
+        const uint64_t t_Size = a_FaceOffsets[f + 1] - a_FaceOffsets[f];
+        const FaceHandle t_FaceHandle = a_Mesh.new_face();
+        t_Halfedges.clear();
+        for(uint64_t i = 0; i < t_Size; i++)
+        {
+            const uint32_t t_From = t_Face[i];
+            const uint32_t t_To = t_Face[(i + 1) % t_Size];
+            const uint32_t t_Lower = std::min(t_From, t_To);
+
+            // Find the halfedge t_From -> t_To or create its edge, in the same order as add_face
+            HalfedgeHandle t_Halfedge;
+            for(uint64_t e = t_EdgeStart[t_Lower]; e < t_EdgeEnd[t_Lower]; e++)
+            {
+                const HalfedgeHandle t_First = a_Mesh.halfedge_handle(EdgeHandle(t_Edges[e]), 0);
+                if(a_Mesh.to_vertex_handle(t_First).idx() == static_cast<int>(t_To) &&
+                   a_Mesh.from_vertex_handle(t_First).idx() == static_cast<int>(t_From))
+                {
+                    t_Halfedge = t_First;
+                    break;
+                }
+                if(a_Mesh.to_vertex_handle(t_First).idx() == static_cast<int>(t_From) &&
+                   a_Mesh.from_vertex_handle(t_First).idx() == static_cast<int>(t_To))
+                {
+                    t_Halfedge = a_Mesh.opposite_halfedge_handle(t_First);
+                    break;
+                }
+            }
+            if(!t_Halfedge.is_valid())
+            {
+                t_Halfedge = a_Mesh.new_edge(VertexHandle(t_From), VertexHandle(t_To));
+                t_Edges[t_EdgeEnd[t_Lower]++] = a_Mesh.edge_handle(t_Halfedge).idx();
+            }
+            else if(a_Mesh.face_handle(t_Halfedge).is_valid())
+            {
+                // The edge already has a face on this side
+                build_mesh_incrementally(a_Mesh, a_Points, a_NumPoints, a_FaceIndices, a_FaceOffsets, a_NumFaces);
+                return;
+            }
+            a_Mesh.set_face_handle(t_Halfedge, t_FaceHandle);
+            t_Halfedges.push_back(t_Halfedge);
+        }
+
+        for(uint64_t i = 0; i < t_Size; i++)
+        {
+            a_Mesh.set_next_halfedge_handle(t_Halfedges[i], t_Halfedges[(i + 1) % t_Size]);
+            // add_face leaves an inner vertex at its outgoing halfedge in the last face around it
+            a_Mesh.set_halfedge_handle(VertexHandle(t_Face[i]), t_Halfedges[i]);
+        }
+        a_Mesh.set_halfedge_handle(t_FaceHandle, t_Halfedges[t_Size - 1]);
+    }
+
+    // Link the boundary loops, a boundary vertex stores its outgoing boundary halfedge
+    std::vector<HalfedgeHandle> t_BoundaryOut(a_NumPoints);
+    const size_t t_NumHalfedges = a_Mesh.n_halfedges();
+    for(size_t h = 0; h < t_NumHalfedges; h++)
+    {
+        const HalfedgeHandle t_Halfedge(static_cast<int>(h));
+        if(a_Mesh.face_handle(t_Halfedge).is_valid())
+        {
+            continue;
+        }
+        HalfedgeHandle& t_Out = t_BoundaryOut[a_Mesh.from_vertex_handle(t_Halfedge).idx()];
+        if(t_Out.is_valid())
+        {
+            // More than one boundary at this vertex
+            build_mesh_incrementally(a_Mesh, a_Points, a_NumPoints, a_FaceIndices, a_FaceOffsets, a_NumFaces);
+            return;
+        }
+        t_Out = t_Halfedge;
+    }
+    for(size_t v = 0; v < a_NumPoints; v++)
+    {
+        if(t_BoundaryOut[v].is_valid())
+        {
+            a_Mesh.set_halfedge_handle(VertexHandle(static_cast<int>(v)), t_BoundaryOut[v]);
+        }
+    }
+    for(size_t h = 0; h < t_NumHalfedges; h++)
+    {
+        const HalfedgeHandle t_Halfedge(static_cast<int>(h));
+        if(!a_Mesh.face_handle(t_Halfedge).is_valid())
+        {
+            a_Mesh.set_next_halfedge_handle(t_Halfedge, t_BoundaryOut[a_Mesh.to_vertex_handle(t_Halfedge).idx()]);
+        }
+    }
+}
+
+} // end of Helper namespace
@@ -0,0 +1,17 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+namespace Helper
+{
+
+void build_mesh(MeshType& a_Mesh, const double* a_Points, size_t a_NumPoints,
+                const uint32_t* a_FaceIndices, const uint64_t* a_FaceOffsets, size_t a_NumFaces);
+
+} // end of Helper namespace
@@ -0,0 +1,136 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#include "MeshTopologyCache.hpp"
+#include "Parallel.hpp"
+#include <array>
+#include <atomic>
+
+/*
+ * The active caches, one slot per mesh being processed, see MeshTopologyCache::Scope.
+ * s_NumActiveCaches lets find return without scanning while no cache is active.
+ */
+static const size_t s_MaxActiveCaches = 16;
+static std::array<std::atomic<const MeshTopologyCache*>, s_MaxActiveCaches> s_ActiveCaches{};
+static std::atomic<int> s_NumActiveCaches(0);
+
+// The mesh and cache of the innermost MeshTopologyCache::Lookup on this thread
+static thread_local const MeshType* s_LookupMesh = nullptr;
+static thread_local const MeshTopologyCache* s_LookupCache = nullptr;
+
+MeshTopologyCache::MeshTopologyCache(const MeshType& a_Mesh, const int a_NumThreads, const bool a_IsWithRings)
+    : m_Mesh(a_Mesh)
+{
+    const size_t t_NumVerts = a_Mesh.n_vertices();
+    const size_t t_NumFaces = a_Mesh.n_faces();
+    m_Valences.resize(t_NumVerts);
+    m_IsBoundary.resize(t_NumVerts);
+    m_FaceSizes.resize(t_NumFaces);
+
+    // Vertices are [0, t_NumVerts), faces follow
+    std::vector<uint32_t> t_RingSizes(a_IsWithRings ? t_NumVerts : 0);
+    Helper::parallel_for(0, t_NumVerts + t_NumFaces, a_NumThreads, [&](size_t i)
+    {
+        if (i < t_NumVerts)
+        {
+            const auto t_Vert = a_Mesh.vertex_handle(i);
+            m_Valences[i] = a_Mesh.valence(t_Vert);
+            m_IsBoundary[i] = a_Mesh.is_boundary(t_Vert) ? 1 : 0;
+            if (a_IsWithRings)
+            {
+                uint32_t t_NumRingFaces = 0;
+                for (auto t_VFIt = a_Mesh.cvf_ccwiter(t_Vert); t_VFIt.is_valid(); ++t_VFIt)
+                {
+                    ++t_NumRingFaces;
+                }
+                t_RingSizes[i] = t_NumRingFaces;
+            }
+        }
+        else
+        {
+            m_FaceSizes[i - t_NumVerts] = a_Mesh.valence(a_Mesh.face_handle(i - t_NumVerts));
+        }
+    }, 1024);
+
+    if (!a_IsWithRings)
+    {
+        return;
+    }
+    m_RingOffsets.resize(t_NumVerts + 1);
+    m_RingOffsets[0] = 0;
+    for (size_t v = 0; v < t_NumVerts; ++v)
+    {
+        m_RingOffsets[v + 1] = m_RingOffsets[v] + t_RingSizes[v];
+    }
+    m_RingFaces.resize(m_RingOffsets[t_NumVerts]);
+    Helper::parallel_for(0, t_NumVerts, a_NumThreads, [&](size_t v)
+    {
+        uint32_t* t_Ring = m_RingFaces.data() + m_RingOffsets[v];
+        for (auto t_VFIt = a_Mesh.cvf_ccwiter(a_Mesh.vertex_handle(v)); t_VFIt.is_valid(); ++t_VFIt)
+        {
+            *t_Ring++ = static_cast<uint32_t>(t_VFIt->idx());
+        }
+    }, 1024);
+}
+
+const MeshTopologyCache* MeshTopologyCache::find(const MeshType& a_Mesh)
+{
+    if (s_NumActiveCaches.load(std::memory_order_acquire) == 0)
+    {
+        return nullptr;
+    }
+    for (const auto& t_Slot : s_ActiveCaches)
+    {
+        const MeshTopologyCache* t_Cache = t_Slot.load(std::memory_order_acquire);
+        if (t_Cache != nullptr && &t_Cache->m_Mesh == &a_Mesh)
+        {
+            return t_Cache;
+        }
+    }
+    return nullptr;
+}
+
+const MeshTopologyCache* MeshTopologyCache::current(const MeshType& a_Mesh)
+{
+    if (s_LookupMesh == &a_Mesh)
+    {
+        return s_LookupCache;
+    }
+    return find(a_Mesh);
+}
+
+MeshTopologyCache::Lookup::Lookup(const MeshType& a_Mesh)
+    : m_Cache(current(a_Mesh)), m_PrevMesh(s_LookupMesh), m_PrevCache(s_LookupCache)
+{
+    s_LookupMesh = &a_Mesh;
+    s_LookupCache = m_Cache;
+}
+
+MeshTopologyCache::Lookup::~Lookup()
+{
+    s_LookupMesh = m_PrevMesh;
+    s_LookupCache = m_PrevCache;
+}
+
+MeshTopologyCache::Scope::Scope(const MeshTopologyCache& a_Cache)
+    : m_Slot(-1)
+{
+    for (size_t i = 0; i < s_MaxActiveCaches; ++i)
+    {
+        const MeshTopologyCache* t_Expected = nullptr;
+        if (s_ActiveCaches[i].compare_exchange_strong(t_Expected, &a_Cache, std::memory_order_acq_rel))
+        {
+            m_Slot = static_cast<int>(i);
+            s_NumActiveCaches.fetch_add(1, std::memory_order_acq_rel);
+            return;
+        }
+    }
+}
+
+MeshTopologyCache::Scope::~Scope()
+{
+    if (m_Slot >= 0)
+    {
+        s_ActiveCaches[m_Slot].store(nullptr, std::memory_order_release);
+        s_NumActiveCaches.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
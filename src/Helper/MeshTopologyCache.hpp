@@ -0,0 +1,137 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+/**
+ * \ingroup utility
+ * @brief Flat arrays of the topology queried while identifying PnS patches: vertex valences, boundary bits, face sizes
+ * and optionally the faces around every vertex, in compressed sparse row form.
+ *
+ * The arrays are filled in one pass over the mesh, in parallel, so that the \ref helper "Helper" predicates read an array
+ * instead of circulating around the same elements again and again. The cache is only consulted while it is activated
+ * for its mesh with a \ref Scope, see \ref find. The topology of the mesh must not change while the cache is in use.
+ * Marks are not topology and are not cached.
+ */
+class MeshTopologyCache
+{
+public:
+    /**
+     * @brief Build the cache of a mesh.
+     *
+     * @param a_Mesh The mesh. It must outlive the cache.
+     * @param a_NumThreads Number of threads, see \ref Helper::resolve_num_threads.
+     * @param a_IsWithRings If true, the faces around every vertex are stored as well.
+     */
+    explicit MeshTopologyCache(const MeshType& a_Mesh, int a_NumThreads = 1, bool a_IsWithRings = true);
+
+    MeshTopologyCache(const MeshTopologyCache&) = delete;
+    MeshTopologyCache& operator=(const MeshTopologyCache&) = delete;
+
+    const MeshType& mesh() const { return m_Mesh; }
+
+    /**
+     * @brief The number of edges at the vertex, as MeshType::valence.
+     */
+    int valence(const MeshType::VertexHandle& a_VertexHandle) const { return static_cast<int>(m_Valences[a_VertexHandle.idx()]); }
+
+    /**
+     * @brief True if the vertex is on the boundary, as MeshType::is_boundary.
+     */
+    bool isBoundary(const MeshType::VertexHandle& a_VertexHandle) const { return m_IsBoundary[a_VertexHandle.idx()] != 0; }
+
+    /**
+     * @brief The number of vertices of the face, as MeshType::valence.
+     */
+    int faceSize(const MeshType::FaceHandle& a_FaceHandle) const { return static_cast<int>(m_FaceSizes[a_FaceHandle.idx()]); }
+
+    bool hasRings() const { return !m_RingOffsets.empty(); }
+
+    /**
+     * @brief The number of faces around the vertex. Requires \ref hasRings.
+     */
+    size_t numFacesAround(const MeshType::VertexHandle& a_VertexHandle) const
+    {
+        return m_RingOffsets[a_VertexHandle.idx() + 1] - m_RingOffsets[a_VertexHandle.idx()];
+    }
+
+    /**
+     * @brief Indices of the faces around the vertex in counterclockwise order, starting where MeshType::cvf_ccwiter starts.
+     * There are \ref numFacesAround of them. Requires \ref hasRings.
+     */
+    const uint32_t* facesAround(const MeshType::VertexHandle& a_VertexHandle) const
+    {
+        return m_RingFaces.data() + m_RingOffsets[a_VertexHandle.idx()];
+    }
+
+    /**
+     * @brief The cache activated for a_Mesh, or nullptr if there is none and the mesh has to be queried directly.
+     */
+    static const MeshTopologyCache* find(const MeshType& a_Mesh);
+
+    /**
+     * @brief The cache of a_Mesh for the \ref helper "Helper" predicates: the one of the enclosing \ref Lookup on this thread
+     * if there is one for a_Mesh, otherwise \ref find.
+     */
+    static const MeshTopologyCache* current(const MeshType& a_Mesh);
+
+    /**
+     * @brief Looks the cache of a mesh up once, with \ref find, for the lifetime of the lookup.
+     *
+     * A classification or build of one element creates a lookup and reads the cache from \ref get. The predicates it calls
+     * on the same thread read it from \ref current instead of searching the active caches again. Lookups can be nested.
+     */
+    class Lookup
+    {
+    public:
+        explicit Lookup(const MeshType& a_Mesh);
+        ~Lookup();
+
+        Lookup(const Lookup&) = delete;
+        Lookup& operator=(const Lookup&) = delete;
+
+        const MeshTopologyCache* get() const { return m_Cache; }
+
+    private:
+        const MeshTopologyCache* m_Cache;
+        // The enclosing lookup on this thread, restored when this one ends
+        const MeshType* m_PrevMesh;
+        const MeshTopologyCache* m_PrevCache;
+    };
+
+    /**
+     * @brief Activates a cache for the lifetime of the scope, so that \ref find returns it for its mesh.
+     *
+     * Caches of different meshes can be active at the same time, e.g. when several meshes are processed on
+     * different threads. Up to 16 caches are active at once; beyond that the scope does nothing and queries on
+     * its mesh fall back to the mesh itself. A mesh should have at most one active cache.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(const MeshTopologyCache& a_Cache);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        // Index of the registry slot holding the cache, -1 if the cache could not be activated
+        int m_Slot;
+    };
+
+private:
+    const MeshType& m_Mesh;
+    std::vector<uint32_t> m_Valences;
+    std::vector<uint8_t> m_IsBoundary;
+    std::vector<uint32_t> m_FaceSizes;
+    // Faces around vertex v are m_RingFaces[m_RingOffsets[v], m_RingOffsets[v+1])
+    std::vector<size_t> m_RingOffsets;
+    std::vector<uint32_t> m_RingFaces;
+};
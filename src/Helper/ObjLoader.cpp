@@ -0,0 +1,277 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#include "ObjLoader.hpp"
+#include "MeshBuilder.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define OBJ_LOADER_USE_MMAP
+#endif
+
+namespace Helper
+{
+
+/*
+ * Vertices and faces of one chunk of an OBJ file.
+ * Face indices are stored 0-based. Negative (relative) indices depend on the number of vertices
+ * before the chunk, they are stored as their position relative to the chunk and resolved when the chunks are merged.
+ */
+struct ObjChunk
+{
+    std::vector<double> m_Points;
+    std::vector<int64_t> m_FaceIndices;
+    std::vector<uint64_t> m_FaceSizes;
+    std::vector<size_t> m_RelativeIndices;
+};
+
+static const char* skip_blanks(const char* a_Begin, const char* a_End)
+{
+    while(a_Begin < a_End && (*a_Begin == ' ' || *a_Begin == '\t' || *a_Begin == '\r'))
+    {
+        ++a_Begin;
+    }
+    return a_Begin;
+}
+
+static const char* parse_double(const char* a_Begin, const char* a_End, double& a_Value)
+{
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    if(a_Begin < a_End && *a_Begin == '+')
+    {
+        ++a_Begin;
+    }
+    const std::from_chars_result t_Result = std::from_chars(a_Begin, a_End, a_Value);
+    return t_Result.ec == std::errc() ? t_Result.ptr : nullptr;
+#else
+    // strtod needs a terminated string, numbers longer than the buffer are not valid OBJ anyway
+    char t_Text[64];
+    const size_t t_Length = std::min<size_t>(a_End - a_Begin, sizeof(t_Text) - 1);
+    std::memcpy(t_Text, a_Begin, t_Length);
+    t_Text[t_Length] = '\0';
+    char* t_Stop;
+    a_Value = std::strtod(t_Text, &t_Stop);
+    return t_Stop == t_Text ? nullptr : a_Begin + (t_Stop - t_Text);
+#endif
+}
+
+/*
+ * Parse the v and f records of the lines in [a_Begin, a_End), other records are ignored.
+ * Only the position index of a face corner (before the first '/') is used.
+ */
+static void parse_chunk(const char* a_Begin, const char* a_End, ObjChunk& a_Chunk)
+{
+    const char* t_Line = a_Begin;
+    while(t_Line < a_End)
+    {
+        const char* t_LineEnd = static_cast<const char*>(std::memchr(t_Line, '\n', a_End - t_Line));
+        if(t_LineEnd == nullptr)
+        {
+            t_LineEnd = a_End;
+        }
+        const char* t_Pos = skip_blanks(t_Line, t_LineEnd);
+
+        if(t_LineEnd - t_Pos > 1 && t_Pos[0] == 'v' && (t_Pos[1] == ' ' || t_Pos[1] == '\t'))
+        {
+            t_Pos += 2;
+            double t_Coords[3] = {0, 0, 0};
+            for(int k = 0; k < 3 && t_Pos != nullptr; ++k)
+            {
+                t_Pos = parse_double(skip_blanks(t_Pos, t_LineEnd), t_LineEnd, t_Coords[k]);
+            }
+            if(t_Pos == nullptr)
+            {
+                std::cerr << "Invalid vertex in OBJ: " << std::string(t_Line, t_LineEnd) << "\n";
+            }
+            a_Chunk.m_Points.insert(a_Chunk.m_Points.end(), t_Coords, t_Coords + 3);
+        }
+        else if(t_LineEnd - t_Pos > 1 && t_Pos[0] == 'f' && (t_Pos[1] == ' ' || t_Pos[1] == '\t'))
+        {
+            t_Pos += 2;
+            uint64_t t_Size = 0;
+            while((t_Pos = skip_blanks(t_Pos, t_LineEnd)) < t_LineEnd)
+            {
+                int64_t t_Index = 0;
+                const char* t_Number = t_Pos;
+                if(*t_Number == '+')
+                {
+                    ++t_Number;
+                }
+                const std::from_chars_result t_Result = std::from_chars(t_Number, t_LineEnd, t_Index);
+                if(t_Result.ec != std::errc())
+                {
+                    break;
+                }
+                if(t_Index < 0)
+                {
+                    // Position of the vertex relative to the start of this chunk
+                    a_Chunk.m_RelativeIndices.push_back(a_Chunk.m_FaceIndices.size());
+                    a_Chunk.m_FaceIndices.push_back(static_cast<int64_t>(a_Chunk.m_Points.size() / 3) + t_Index);
+                }
+                else
+                {
+                    a_Chunk.m_FaceIndices.push_back(t_Index - 1);
+                }
+                ++t_Size;
+                // Skip the texture and normal indices
+                t_Pos = t_Result.ptr;
+                while(t_Pos < t_LineEnd && *t_Pos != ' ' && *t_Pos != '\t' && *t_Pos != '\r')
+                {
+                    ++t_Pos;
+                }
+            }
+            a_Chunk.m_FaceSizes.push_back(t_Size);
+        }
+        t_Line = t_LineEnd + 1;
+    }
+}
+
+/**
+ * \ingroup helper
+ * @brief Read the vertices and faces of an OBJ file in memory into a mesh.
+ *
+ * The data is split into line aligned chunks that are parsed in parallel, the mesh is then built in bulk with \ref build_mesh.
+ * Only the vertex positions and the faces are read, texture coordinates, normals, groups and materials are ignored.
+ *
+ * @param a_Data The content of the OBJ file, need not be null terminated
+ * @param a_Size The size of the content in bytes
+ * @param a_Mesh The mesh to build, its previous content is removed
+ * @param a_NumThreads Number of threads, see \ref resolve_num_threads
+ * @return true if the data contains at least one vertex
+ */
+bool parse_obj(const char* a_Data, size_t a_Size, MeshType& a_Mesh, int a_NumThreads)
+{
+    // Line aligned chunks of at least 1 MiB, a few per thread so that uneven chunks are balanced
+    const int t_NumThreads = resolve_num_threads(a_NumThreads);
+    const size_t t_MinChunkSize = 1 << 20;
+    const size_t t_NumChunks = std::max<size_t>(1, std::min<size_t>(4 * t_NumThreads, a_Size / t_MinChunkSize));
+    std::vector<size_t> t_ChunkStart(t_NumChunks + 1, a_Size);
+    t_ChunkStart[0] = 0;
+    for(size_t c = 1; c < t_NumChunks; ++c)
+    {
+        size_t t_Start = std::max(t_ChunkStart[c - 1], a_Size / t_NumChunks * c);
+        const void* t_Newline = t_Start < a_Size ? std::memchr(a_Data + t_Start, '\n', a_Size - t_Start) : nullptr;
+        t_ChunkStart[c] = t_Newline != nullptr ? static_cast<const char*>(t_Newline) - a_Data + 1 : a_Size;
+    }
+
+    std::vector<ObjChunk> t_Chunks(t_NumChunks);
+    parallel_for(0, t_NumChunks, t_NumThreads, [&](size_t c)
+    {
+        parse_chunk(a_Data + t_ChunkStart[c], a_Data + t_ChunkStart[c + 1], t_Chunks[c]);
+    }, 1);
+
+    // Where the vertices, faces and face indices of each chunk go
+    std::vector<size_t> t_FirstPoint(t_NumChunks + 1, 0);
+    std::vector<size_t> t_FirstFace(t_NumChunks + 1, 0);
+    std::vector<size_t> t_FirstIndex(t_NumChunks + 1, 0);
+    for(size_t c = 0; c < t_NumChunks; ++c)
+    {
+        t_FirstPoint[c + 1] = t_FirstPoint[c] + t_Chunks[c].m_Points.size() / 3;
+        t_FirstFace[c + 1] = t_FirstFace[c] + t_Chunks[c].m_FaceSizes.size();
+        t_FirstIndex[c + 1] = t_FirstIndex[c] + t_Chunks[c].m_FaceIndices.size();
+    }
+    const size_t t_NumPoints = t_FirstPoint[t_NumChunks];
+    const size_t t_NumFaces = t_FirstFace[t_NumChunks];
+
+    std::vector<double> t_Points(3 * t_NumPoints);
+    std::vector<uint32_t> t_FaceIndices(t_FirstIndex[t_NumChunks]);
+    std::vector<uint64_t> t_FaceOffsets(t_NumFaces + 1);
+    t_FaceOffsets[t_NumFaces] = t_FaceIndices.size();
+    parallel_for(0, t_NumChunks, t_NumThreads, [&](size_t c)
+    {
+        ObjChunk& t_Chunk = t_Chunks[c];
+        std::copy(t_Chunk.m_Points.begin(), t_Chunk.m_Points.end(), t_Points.begin() + 3 * t_FirstPoint[c]);
+
+        for(size_t i : t_Chunk.m_RelativeIndices)
+        {
+            t_Chunk.m_FaceIndices[i] += t_FirstPoint[c];
+        }
+        // Indices that are out of range become invalid and their faces are skipped by build_mesh
+        for(size_t i = 0; i < t_Chunk.m_FaceIndices.size(); ++i)
+        {
+            const int64_t t_Index = t_Chunk.m_FaceIndices[i];
+            t_FaceIndices[t_FirstIndex[c] + i] = (t_Index >= 0 && t_Index < static_cast<int64_t>(UINT32_MAX)) ? static_cast<uint32_t>(t_Index) : UINT32_MAX;
+        }
+
+        uint64_t t_Offset = t_FirstIndex[c];
+        for(size_t f = 0; f < t_Chunk.m_FaceSizes.size(); ++f)
+        {
+            t_FaceOffsets[t_FirstFace[c] + f] = t_Offset;
+            t_Offset += t_Chunk.m_FaceSizes[f];
+        }
+        t_Chunk = ObjChunk();
+    }, 1);
+
+    build_mesh(a_Mesh, t_Points.data(), t_NumPoints, t_FaceIndices.data(), t_FaceOffsets.data(), t_NumFaces);
+    return t_NumPoints > 0;
+}
+
+/**
+ * \ingroup helper
+ * @brief Read an OBJ file into a mesh, see \ref parse_obj.
+ *
+ * The file is mapped into memory where the platform supports it and read into memory otherwise.
+ *
+ * @param a_File Path of the OBJ file
+ * @param a_Mesh The mesh to build, its previous content is removed
+ * @param a_NumThreads Number of threads, see \ref resolve_num_threads
+ * @return true if the file was read and contains at least one vertex
+ */
+bool load_obj(const std::string& a_File, MeshType& a_Mesh, int a_NumThreads)
+{
+#ifdef OBJ_LOADER_USE_MMAP
+    const int t_Fd = ::open(a_File.c_str(), O_RDONLY);
+    if(t_Fd < 0)
+    {
+        std::cerr << "Could not open " << a_File << "\n";
+        return false;
+    }
+    struct stat t_Stat;
+    if(::fstat(t_Fd, &t_Stat) != 0)
+    {
+        ::close(t_Fd);
+        std::cerr << "Could not read " << a_File << "\n";
+        return false;
+    }
+    const size_t t_Size = t_Stat.st_size;
+    if(t_Size == 0)
+    {
+        ::close(t_Fd);
+        return parse_obj(nullptr, 0, a_Mesh, a_NumThreads);
+    }
+    void* t_Mapping = ::mmap(nullptr, t_Size, PROT_READ, MAP_PRIVATE, t_Fd, 0);
+    ::close(t_Fd);
+    if(t_Mapping == MAP_FAILED)
+    {
+        std::cerr << "Could not map " << a_File << "\n";
+        return false;
+    }
+    const bool t_Result = parse_obj(static_cast<const char*>(t_Mapping), t_Size, a_Mesh, a_NumThreads);
+    ::munmap(t_Mapping, t_Size);
+    return t_Result;
+#else
+    std::ifstream t_File(a_File, std::ios::binary | std::ios::ate);
+    if(!t_File)
+    {
+        std::cerr << "Could not open " << a_File << "\n";
+        return false;
+    }
+    std::string t_Content(static_cast<size_t>(t_File.tellg()), '\0');
+    t_File.seekg(0);
+    t_File.read(&t_Content[0], t_Content.size());
+    return parse_obj(t_Content.data(), t_Content.size(), a_Mesh, a_NumThreads);
+#endif
+}
+
+} // end of Helper namespace
@@ -0,0 +1,17 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+
+typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
+
+namespace Helper
+{
+
+bool parse_obj(const char* a_Data, size_t a_Size, MeshType& a_Mesh, int a_NumThreads = 0);
+bool load_obj(const std::string& a_File, MeshType& a_Mesh, int a_NumThreads = 0);
+
+} // end of Helper namespace
@@ -0,0 +1,117 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Helper
+{
+
+/**
+ * \ingroup helper
+ * @brief Resolve a requested thread count to the number of threads that will actually be used.
+ *
+ * A value of 0 or less selects the number of hardware threads. Builds without thread support
+ * (WebAssembly without pthreads) always resolve to a single thread.
+ *
+ * @param a_NumThreads The requested number of threads
+ * @return The number of threads to use, at least 1
+ */
+inline int resolve_num_threads(int a_NumThreads)
+{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    return 1;
+#else
+    if(a_NumThreads > 0)
+    {
+        return a_NumThreads;
+    }
+    int t_HardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    return t_HardwareThreads > 0 ? t_HardwareThreads : 1;
+#endif
+}
+
+/**
+ * \ingroup helper
+ * @brief Call a_Func(i) for every i in [a_Begin, a_End) using up to a_NumThreads threads.
+ *
+ * Indices are handed out in chunks of a_Grain from a shared counter so that uneven work is balanced
+ * between threads. With a single thread (or a range smaller than one chunk) the loop runs inline on
+ * the calling thread. The first exception thrown by a_Func is rethrown on the calling thread.
+ *
+ * @param a_Begin First index
+ * @param a_End One past the last index
+ * @param a_NumThreads Number of threads to use, see \ref resolve_num_threads
+ * @param a_Func Callable invoked with each index
+ * @param a_Grain Number of consecutive indices claimed at once by a thread
+ */
+template <typename Func>
+void parallel_for(size_t a_Begin, size_t a_End, int a_NumThreads, Func&& a_Func, size_t a_Grain = 256)
+{
+    if(a_End <= a_Begin)
+    {
+        return;
+    }
+    a_Grain = std::max<size_t>(a_Grain, 1);
+    const size_t t_NumChunks = (a_End - a_Begin + a_Grain - 1) / a_Grain;
+    const size_t t_NumThreads = std::min<size_t>(resolve_num_threads(a_NumThreads), t_NumChunks);
+    if(t_NumThreads <= 1)
+    {
+        for(size_t i = a_Begin; i < a_End; ++i)
+        {
+            a_Func(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> t_Next(a_Begin);
+    std::exception_ptr t_Error;
+    std::mutex t_ErrorMutex;
+    auto t_Worker = [&]()
+    {
+        try
+        {
+            for(size_t t_Start = t_Next.fetch_add(a_Grain); t_Start < a_End; t_Start = t_Next.fetch_add(a_Grain))
+            {
+                const size_t t_Stop = std::min(t_Start + a_Grain, a_End);
+                for(size_t i = t_Start; i < t_Stop; ++i)
+                {
+                    a_Func(i);
+                }
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> t_Lock(t_ErrorMutex);
+            if(!t_Error)
+            {
+                t_Error = std::current_exception();
+            }
+            t_Next.store(a_End);
+        }
+    };
+
+    std::vector<std::thread> t_Threads;
+    t_Threads.reserve(t_NumThreads - 1);
+    for(size_t t = 1; t < t_NumThreads; ++t)
+    {
+        t_Threads.emplace_back(t_Worker);
+    }
+    t_Worker();
+    for(auto& t_Thread : t_Threads)
+    {
+        t_Thread.join();
+    }
+    if(t_Error)
+    {
+        std::rethrow_exception(t_Error);
+    }
+}
+
+} // end of Helper namespace
@@ -1,53 +1,39 @@
 /* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
 
 #include "ReadCSV2Matrix.hpp"
-#include <sstream>
+#include "EmbeddedTables.hpp"
+#include <algorithm>
 #include <iostream>
 #include <string>
-#include <unordered_map>
-
-// Forward-declared by embedded_tables.cpp (generated by CMake)
-const std::unordered_map<std::string, const char*>& get_embedded_tables();
 
 /**
  * \ingroup utility
- * @brief Read a CSV file embedded in the binary as a \ref Matrix. For the mask of patch types
+ * @brief Get a mask table embedded in the binary as a \ref Matrix. For the mask of patch types
+ * 
+ * The CSV tables are converted to constant arrays at build time, see \ref EmbeddedTable, so this only copies the values.
  * 
- * @param a_File The name of the embedded CSV file.
+ * @param a_File The name of the CSV file the table was generated from.
  * @param a_Rows The number of rows in the matrix.
  * @param a_Cols The number of columns in the matrix.
- * @return The matrix read from the CSV file.
+ * @return The matrix of the table. Entries not present in the table are zero.
  */
 Matrix read_csv_as_matrix(const std::string& a_File, const int a_Rows, const int a_Cols)
 {
-    const auto& table_map = get_embedded_tables();
-    auto it = table_map.find(a_File);
+    const EmbeddedTable* t_Table = find_embedded_table(a_File.c_str());
 
-    if (it == table_map.end())
+    if (t_Table == nullptr)
     {
         std::cerr << "Error: Embedded table '" << a_File << "' not found." << std::endl;
         std::terminate();  // or throw if preferred
     }
 
-    std::istringstream t_Stream(it->second);
-    std::string t_Line;
-    int t_Row = 0;
     Matrix t_Matrix(a_Rows, a_Cols);
-
-    while (std::getline(t_Stream, t_Line) && t_Row < a_Rows)
+    const int t_Rows = std::min(a_Rows, t_Table->m_Rows);
+    const int t_Cols = std::min(a_Cols, t_Table->m_Cols);
+    for (int t_Row = 0; t_Row < t_Rows; ++t_Row)
     {
-        if (t_Line.empty() || t_Line[0] == '#') continue;
-
-        std::stringstream ss(t_Line);
-        std::string value;
-        int t_Col = 0;
-
-        while (std::getline(ss, value, ',') && t_Col < a_Cols)
-        {
-            t_Matrix(t_Row, t_Col++) = std::atof(value.c_str());
-        }
-
-        ++t_Row;
+        const double* t_Values = t_Table->m_Data + static_cast<size_t>(t_Row) * t_Table->m_Cols;
+        std::copy(t_Values, t_Values + t_Cols, t_Matrix.row(t_Row));
     }
 
     return t_Matrix;
@@ -0,0 +1,187 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace Helper
+{
+
+/**
+ * \ingroup helper
+ * @brief A vector that stores up to N elements inline and only allocates on the heap when it grows beyond that.
+ *
+ * Meant for the many short lists created during subdivision, which would otherwise cost one allocation each.
+ * Elements are copied bytewise, so T must be trivially copyable.
+ *
+ * @tparam T The element type.
+ * @tparam N The number of elements stored without allocating.
+ */
+template <typename T, size_t N>
+class SmallVector
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector requires a trivially copyable type");
+
+public:
+    SmallVector() = default;
+
+    SmallVector(const SmallVector& a_Other)
+    {
+        assign(a_Other);
+    }
+
+    SmallVector(SmallVector&& a_Other) noexcept
+    {
+        take(a_Other);
+    }
+
+    SmallVector& operator=(const SmallVector& a_Other)
+    {
+        if(this != &a_Other)
+        {
+            m_Size = 0;
+            assign(a_Other);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& a_Other) noexcept
+    {
+        if(this != &a_Other)
+        {
+            release();
+            take(a_Other);
+        }
+        return *this;
+    }
+
+    ~SmallVector()
+    {
+        release();
+    }
+
+    size_t size() const { return m_Size; }
+    bool empty() const { return m_Size == 0; }
+    size_t capacity() const { return m_Capacity; }
+
+    T* data() { return m_Heap ? m_Heap : inlineData(); }
+    const T* data() const { return m_Heap ? m_Heap : inlineData(); }
+
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+    T* begin() { return data(); }
+    T* end() { return data() + m_Size; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + m_Size; }
+
+    T& back() { return data()[m_Size - 1]; }
+    const T& back() const { return data()[m_Size - 1]; }
+
+    void clear() { m_Size = 0; }
+
+    /**
+     * @brief Make room for at least a_Capacity elements. Never shrinks.
+     */
+    void reserve(size_t a_Capacity)
+    {
+        if(a_Capacity <= m_Capacity)
+        {
+            return;
+        }
+        T* t_Heap = static_cast<T*>(std::malloc(a_Capacity * sizeof(T)));
+        if(t_Heap == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        if(m_Size > 0)
+        {
+            std::memcpy(static_cast<void*>(t_Heap), data(), m_Size * sizeof(T));
+        }
+        std::free(m_Heap);
+        m_Heap = t_Heap;
+        m_Capacity = a_Capacity;
+    }
+
+    void push_back(const T& a_Value)
+    {
+        if(m_Size == m_Capacity)
+        {
+            // a_Value may live in this vector, so copy it before growing
+            const T t_Value = a_Value;
+            reserve(m_Capacity > 0 ? 2 * m_Capacity : 4);
+            data()[m_Size++] = t_Value;
+            return;
+        }
+        data()[m_Size++] = a_Value;
+    }
+
+    /**
+     * @brief Change the size to a_Size. New elements are copies of a_Value.
+     */
+    void resize(size_t a_Size, const T& a_Value = T())
+    {
+        reserve(a_Size);
+        for(size_t i = m_Size; i < a_Size; ++i)
+        {
+            data()[i] = a_Value;
+        }
+        m_Size = a_Size;
+    }
+
+private:
+    T* inlineData() { return reinterpret_cast<T*>(m_Inline); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(m_Inline); }
+
+    void assign(const SmallVector& a_Other)
+    {
+        reserve(a_Other.m_Size);
+        if(a_Other.m_Size > 0)
+        {
+            std::memcpy(static_cast<void*>(data()), a_Other.data(), a_Other.m_Size * sizeof(T));
+        }
+        m_Size = a_Other.m_Size;
+    }
+
+    // Move the content of a_Other into this empty vector, stealing its heap buffer if it has one
+    void take(SmallVector& a_Other)
+    {
+        if(a_Other.m_Heap)
+        {
+            m_Heap = a_Other.m_Heap;
+            m_Capacity = a_Other.m_Capacity;
+            a_Other.m_Heap = nullptr;
+            a_Other.m_Capacity = N;
+        }
+        else
+        {
+            m_Heap = nullptr;
+            m_Capacity = N;
+            if(a_Other.m_Size > 0)
+            {
+                std::memcpy(static_cast<void*>(inlineData()), a_Other.inlineData(), a_Other.m_Size * sizeof(T));
+            }
+        }
+        m_Size = a_Other.m_Size;
+        a_Other.m_Size = 0;
+    }
+
+    void release()
+    {
+        std::free(m_Heap);
+        m_Heap = nullptr;
+        m_Capacity = N;
+        m_Size = 0;
+    }
+
+    T* m_Heap = nullptr;
+    size_t m_Size = 0;
+    size_t m_Capacity = N;
+    alignas(T) unsigned char m_Inline[N * sizeof(T)];
+};
+
+} // end of namespace Helper
@@ -0,0 +1,582 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#include "Tessellator.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/*
+ * Bernstein polynomials of degree a_Degree and their derivatives at t.
+ */
+static void bernstein(const int a_Degree, const double t, double* a_Values, double* a_Derivatives)
+{
+    // Degree a_Degree - 1 by the triangular recurrence
+    std::fill(a_Values, a_Values + a_Degree + 1, 0.0);
+    a_Values[0] = 1.0;
+    for(int d = 1; d < a_Degree; d++)
+    {
+        for(int k = d; k > 0; k--)
+        {
+            a_Values[k] = (1.0 - t) * a_Values[k] + t * a_Values[k-1];
+        }
+        a_Values[0] *= (1.0 - t);
+    }
+    if(a_Degree == 0)
+    {
+        a_Derivatives[0] = 0.0;
+        return;
+    }
+    // Derivative: d/dt B_k^d = d (B_{k-1}^{d-1} - B_k^{d-1})
+    for(int k = 0; k <= a_Degree; k++)
+    {
+        const double t_Prev = k > 0 ? a_Values[k-1] : 0.0;
+        a_Derivatives[k] = a_Degree * (t_Prev - a_Values[k]);
+    }
+    // Raise to degree a_Degree
+    for(int k = a_Degree; k > 0; k--)
+    {
+        a_Values[k] = (1.0 - t) * a_Values[k] + t * a_Values[k-1];
+    }
+    a_Values[0] *= (1.0 - t);
+}
+
+/*
+ * Unit normal from the u and v tangents, zero where the patch is degenerate.
+ */
+static void unit_normal(const float a_DU[3], const float a_DV[3], float* a_Normal)
+{
+    const float t_Nx = a_DU[1] * a_DV[2] - a_DU[2] * a_DV[1];
+    const float t_Ny = a_DU[2] * a_DV[0] - a_DU[0] * a_DV[2];
+    const float t_Nz = a_DU[0] * a_DV[1] - a_DU[1] * a_DV[0];
+    const float t_Length = std::sqrt(t_Nx * t_Nx + t_Ny * t_Ny + t_Nz * t_Nz);
+    const float t_Scale = t_Length > 0.0f ? 1.0f / t_Length : 0.0f;
+    a_Normal[0] = t_Nx * t_Scale;
+    a_Normal[1] = t_Ny * t_Scale;
+    a_Normal[2] = t_Nz * t_Scale;
+}
+
+/*
+ * Position and normal of a patch at (u, v).
+ */
+static void evaluate_point(const Patch& a_Patch, const float a_U, const float a_V, float* a_Point, float* a_Normal)
+{
+    const int t_DegU = a_Patch.m_DegU;
+    const int t_DegV = a_Patch.m_DegV;
+    // Called once per snapped vertex, the basis of patches up to degree 15 stays on the stack
+    const size_t t_BasisSize = 2 * (t_DegU + 1) + 2 * (t_DegV + 1);
+    const size_t t_MaxStackSize = 64;
+    double t_StackBasis[t_MaxStackSize];
+    std::vector<double> t_HeapBasis;
+    double* t_BU = t_StackBasis;
+    if(t_BasisSize > t_MaxStackSize)
+    {
+        t_HeapBasis.resize(t_BasisSize);
+        t_BU = t_HeapBasis.data();
+    }
+    double* t_dBU = t_BU + t_DegU + 1;
+    double* t_BV = t_dBU + t_DegU + 1;
+    double* t_dBV = t_BV + t_DegV + 1;
+    bernstein(t_DegU, a_U, t_BU, t_dBU);
+    bernstein(t_DegV, a_V, t_BV, t_dBV);
+
+    const float* t_Coefs = a_Patch.data();
+    double t_Pos[3] = {0.0, 0.0, 0.0};
+    double t_DU[3] = {0.0, 0.0, 0.0};
+    double t_DV[3] = {0.0, 0.0, 0.0};
+    for(int i = 0; i <= t_DegU; i++)
+    {
+        for(int j = 0; j <= t_DegV; j++)
+        {
+            const float* t_P = t_Coefs + (i * (t_DegV + 1) + j) * 3;
+            for(int c = 0; c < 3; c++)
+            {
+                t_Pos[c] += t_BU[i] * t_BV[j] * t_P[c];
+                t_DU[c] += t_dBU[i] * t_BV[j] * t_P[c];
+                t_DV[c] += t_BU[i] * t_dBV[j] * t_P[c];
+            }
+        }
+    }
+    const float t_TangentU[3] = {float(t_DU[0]), float(t_DU[1]), float(t_DU[2])};
+    const float t_TangentV[3] = {float(t_DV[0]), float(t_DV[1]), float(t_DV[2])};
+    for(int c = 0; c < 3; c++)
+    {
+        a_Point[c] = t_Pos[c];
+    }
+    unit_normal(t_TangentU, t_TangentV, a_Normal);
+}
+
+/*
+ * Number of segments for which the polyline through uniform samples of a Bézier curve is within a_Tolerance of the curve.
+ * The curve has a_Degree + 1 control points a_Stride floats apart. The result does not depend on the orientation of the curve.
+ */
+static int curve_segments(const float* a_Points, const int a_Stride, const int a_Degree, const double a_Tolerance, const int a_MaxSegments)
+{
+    std::vector<double> t_Points(3 * (a_Degree + 1));
+    for(int i = 0; i <= a_Degree; i++)
+    {
+        for(int c = 0; c < 3; c++)
+        {
+            t_Points[3*i+c] = a_Points[i * a_Stride + c];
+        }
+    }
+    // Raise to degree 3 so that a curve and its degree raised copy are measured the same way.
+    // The weights i/(d+1) and (d+1-i)/(d+1) are symmetric, so the reversed curve is raised to the reversed result.
+    int t_Degree = a_Degree;
+    while(t_Degree < 3)
+    {
+        std::vector<double> t_Raised(3 * (t_Degree + 2));
+        for(int i = 0; i <= t_Degree + 1; i++)
+        {
+            const double t_A = static_cast<double>(i) / (t_Degree + 1);
+            const double t_B = static_cast<double>(t_Degree + 1 - i) / (t_Degree + 1);
+            for(int c = 0; c < 3; c++)
+            {
+                const double t_Prev = i > 0 ? t_Points[3*(i-1)+c] : 0.0;
+                const double t_Curr = i <= t_Degree ? t_Points[3*i+c] : 0.0;
+                t_Raised[3*i+c] = t_A * t_Prev + t_B * t_Curr;
+            }
+        }
+        t_Points.swap(t_Raised);
+        t_Degree++;
+    }
+
+    // Second differences, (P_i + P_{i+2}) - 2 P_{i+1} is the same for both orientations
+    double t_MaxDiff = 0.0;
+    for(int i = 0; i + 2 <= t_Degree; i++)
+    {
+        double t_Sq = 0.0;
+        for(int c = 0; c < 3; c++)
+        {
+            const double t_Diff = (t_Points[3*i+c] + t_Points[3*(i+2)+c]) - 2.0 * t_Points[3*(i+1)+c];
+            t_Sq += t_Diff * t_Diff;
+        }
+        t_MaxDiff = std::max(t_MaxDiff, std::sqrt(t_Sq));
+    }
+    const double t_Bound = t_Degree * (t_Degree - 1) * t_MaxDiff;
+    const double t_Segments = std::ceil(std::sqrt(t_Bound / (8.0 * a_Tolerance)));
+    return static_cast<int>(std::min<double>(std::max(t_Segments, 1.0), a_MaxSegments));
+}
+
+Tessellator::Tessellator(int a_Resolution) : m_Resolution(a_Resolution)
+{
+    if(a_Resolution < 2)
+    {
+        throw std::runtime_error("Tessellator resolution must be at least 2");
+    }
+    m_Bases.resize(a_Resolution + 1);
+    m_BasesOnce = std::make_unique<std::once_flag[]>(a_Resolution + 1);
+
+    // The triangles are the same for every patch, up to the index of its first vertex
+    const int n = a_Resolution;
+    m_Indices.reserve(numIndicesPerPatch());
+    for(int i = 0; i < n - 1; i++)
+    {
+        for(int j = 0; j < n - 1; j++)
+        {
+            const uint32_t t_V00 = i * n + j;
+            const uint32_t t_V10 = t_V00 + n;
+            const uint32_t t_V01 = t_V00 + 1;
+            const uint32_t t_V11 = t_V10 + 1;
+            // First triangle
+            m_Indices.insert(m_Indices.end(), {t_V00, t_V10, t_V01});
+            // Second triangle
+            m_Indices.insert(m_Indices.end(), {t_V10, t_V11, t_V01});
+        }
+    }
+}
+
+Tessellator::BasisTable Tessellator::makeBasis(int a_Degree, int a_NumSamples)
+{
+    const int n = a_NumSamples;
+    BasisTable t_Table;
+    t_Table.m_Values.resize(static_cast<size_t>(a_Degree + 1) * n);
+    t_Table.m_Derivatives.resize(static_cast<size_t>(a_Degree + 1) * n);
+    std::vector<double> t_Values(a_Degree + 1);
+    std::vector<double> t_Derivatives(a_Degree + 1);
+    for(int s = 0; s < n; s++)
+    {
+        bernstein(a_Degree, static_cast<double>(s) / (n - 1), t_Values.data(), t_Derivatives.data());
+        for(int k = 0; k <= a_Degree; k++)
+        {
+            t_Table.m_Values[static_cast<size_t>(k) * n + s] = static_cast<float>(t_Values[k]);
+            t_Table.m_Derivatives[static_cast<size_t>(k) * n + s] = static_cast<float>(t_Derivatives[k]);
+        }
+    }
+    return t_Table;
+}
+
+const Tessellator::BasisTable& Tessellator::getBasis(int a_NumSamples, int a_Degree) const
+{
+    // Tables for the degrees PnS patches have, with or without degree raising
+    const int t_NumTabulatedDegrees = 8;
+    if(a_Degree < t_NumTabulatedDegrees)
+    {
+        std::call_once(m_BasesOnce[a_NumSamples], [&]()
+        {
+            for(int t_Degree = 0; t_Degree < t_NumTabulatedDegrees; t_Degree++)
+            {
+                m_Bases[a_NumSamples].push_back(makeBasis(t_Degree, a_NumSamples));
+            }
+        });
+        return m_Bases[a_NumSamples][a_Degree];
+    }
+    // Higher degrees are rare, build them on first use
+    std::lock_guard<std::mutex> t_Lock(m_HighDegreeMutex);
+    auto& t_Basis = m_HighDegreeBases[std::make_pair(a_NumSamples, a_Degree)];
+    if(!t_Basis)
+    {
+        t_Basis = std::make_unique<const BasisTable>(makeBasis(a_Degree, a_NumSamples));
+    }
+    return *t_Basis;
+}
+
+void Tessellator::evaluateGrid(const Patch& a_Patch, int a_NumU, int a_NumV, float* a_Vertices, float* a_Normals, float* a_UVs) const
+{
+    const int t_DegU = a_Patch.m_DegU;
+    const int t_DegV = a_Patch.m_DegV;
+    const int n = a_NumV;
+    const BasisTable& t_BasisU = getBasis(a_NumU, t_DegU);
+    const BasisTable& t_BasisV = getBasis(a_NumV, t_DegV);
+    const float* t_Coefs = a_Patch.data();
+    // The derivatives are only needed for the normals
+    const bool t_HasNormals = a_Normals != nullptr;
+
+    // Scratch: the patch contracted in v (and its v derivative) for each row i of coefficients, then one row of the grid.
+    // Layout of the contracted patch: [(i * 3 + c) * n + t]
+    const size_t t_ContractedSize = static_cast<size_t>(t_DegU + 1) * 3 * n;
+    const size_t t_ScratchSize = 2 * t_ContractedSize + 9 * static_cast<size_t>(n);
+    const size_t t_MaxStackSize = 4096;
+    float t_StackScratch[t_MaxStackSize];
+    std::vector<float> t_HeapScratch;
+    float* t_Scratch = t_StackScratch;
+    if(t_ScratchSize > t_MaxStackSize)
+    {
+        t_HeapScratch.resize(t_ScratchSize);
+        t_Scratch = t_HeapScratch.data();
+    }
+    float* t_Q = t_Scratch;
+    float* t_dQ = t_Q + t_ContractedSize;
+    float* t_Pos = t_dQ + t_ContractedSize;
+    float* t_DU = t_Pos + 3 * n;
+    float* t_DV = t_DU + 3 * n;
+
+    // Contract in v: Q[i][c][t] = sum_j Bv_j(t) P[i][j][c], dQ with the derivatives
+    std::fill(t_Q, t_Q + 2 * t_ContractedSize, 0.0f);
+    for(int i = 0; i <= t_DegU; i++)
+    {
+        for(int j = 0; j <= t_DegV; j++)
+        {
+            const float* t_BV = t_BasisV.m_Values.data() + static_cast<size_t>(j) * n;
+            const float* t_dBV = t_BasisV.m_Derivatives.data() + static_cast<size_t>(j) * n;
+            for(int c = 0; c < 3; c++)
+            {
+                const float t_P = t_Coefs[(i * (t_DegV + 1) + j) * 3 + c];
+                float* t_QRow = t_Q + (static_cast<size_t>(i) * 3 + c) * n;
+                float* t_dQRow = t_dQ + (static_cast<size_t>(i) * 3 + c) * n;
+                for(int t = 0; t < n; t++)
+                {
+                    t_QRow[t] += t_P * t_BV[t];
+                }
+                if(t_HasNormals)
+                {
+                    for(int t = 0; t < n; t++)
+                    {
+                        t_dQRow[t] += t_P * t_dBV[t];
+                    }
+                }
+            }
+        }
+    }
+
+    // Contract in u, one row s of the grid at a time
+    for(int s = 0; s < a_NumU; s++)
+    {
+        std::fill(t_Pos, t_Pos + 9 * n, 0.0f);
+        for(int i = 0; i <= t_DegU; i++)
+        {
+            const float t_BU = t_BasisU.m_Values[static_cast<size_t>(i) * a_NumU + s];
+            const float t_dBU = t_BasisU.m_Derivatives[static_cast<size_t>(i) * a_NumU + s];
+            for(int c = 0; c < 3; c++)
+            {
+                const float* t_QRow = t_Q + (static_cast<size_t>(i) * 3 + c) * n;
+                const float* t_dQRow = t_dQ + (static_cast<size_t>(i) * 3 + c) * n;
+                float* t_PosRow = t_Pos + c * n;
+                float* t_DURow = t_DU + c * n;
+                float* t_DVRow = t_DV + c * n;
+                for(int t = 0; t < n; t++)
+                {
+                    t_PosRow[t] += t_BU * t_QRow[t];
+                }
+                if(t_HasNormals)
+                {
+                    for(int t = 0; t < n; t++)
+                    {
+                        t_DURow[t] += t_dBU * t_QRow[t];
+                        t_DVRow[t] += t_BU * t_dQRow[t];
+                    }
+                }
+            }
+        }
+
+        const size_t t_First = static_cast<size_t>(s) * n;
+        for(int t = 0; t < n; t++)
+        {
+            const size_t t_Vertex = t_First + t;
+            if(a_Vertices)
+            {
+                a_Vertices[3*t_Vertex+0] = t_Pos[t];
+                a_Vertices[3*t_Vertex+1] = t_Pos[n + t];
+                a_Vertices[3*t_Vertex+2] = t_Pos[2*n + t];
+            }
+            if(t_HasNormals)
+            {
+                const float t_TangentU[3] = {t_DU[t], t_DU[n + t], t_DU[2*n + t]};
+                const float t_TangentV[3] = {t_DV[t], t_DV[n + t], t_DV[2*n + t]};
+                unit_normal(t_TangentU, t_TangentV, a_Normals + 3*t_Vertex);
+            }
+            if(a_UVs)
+            {
+                a_UVs[2*t_Vertex+0] = static_cast<float>(s) / (a_NumU - 1);
+                a_UVs[2*t_Vertex+1] = static_cast<float>(t) / (n - 1);
+            }
+        }
+    }
+}
+
+void Tessellator::tessellate(const Patch& a_Patch, float* a_Vertices, float* a_Normals, float* a_UVs, uint32_t* a_Indices, uint32_t a_BaseVertex) const
+{
+    evaluateGrid(a_Patch, m_Resolution, m_Resolution, a_Vertices, a_Normals, a_UVs);
+    if(a_Indices)
+    {
+        for(size_t k = 0; k < m_Indices.size(); k++)
+        {
+            a_Indices[k] = a_BaseVertex + m_Indices[k];
+        }
+    }
+}
+
+void Tessellator::tessellate(const Patch* a_Patches, size_t a_NumPatches, TessellatedMesh& a_Mesh, int a_NumThreads) const
+{
+    const size_t t_NumVertices = numVerticesPerPatch();
+    const size_t t_NumIndices = numIndicesPerPatch();
+    a_Mesh.m_Vertices.resize(3 * t_NumVertices * a_NumPatches);
+    a_Mesh.m_Normals.resize(3 * t_NumVertices * a_NumPatches);
+    a_Mesh.m_UVs.resize(2 * t_NumVertices * a_NumPatches);
+    a_Mesh.m_Indices.resize(t_NumIndices * a_NumPatches);
+
+    // Each patch writes its own range of every buffer
+    Helper::parallel_for(0, a_NumPatches, a_NumThreads, [&](size_t p)
+    {
+        tessellate(a_Patches[p],
+                   a_Mesh.m_Vertices.data() + 3 * t_NumVertices * p,
+                   a_Mesh.m_Normals.data() + 3 * t_NumVertices * p,
+                   a_Mesh.m_UVs.data() + 2 * t_NumVertices * p,
+                   a_Mesh.m_Indices.data() + t_NumIndices * p,
+                   static_cast<uint32_t>(t_NumVertices * p));
+    }, 64);
+}
+
+TessellationLevels Tessellator::chooseLevels(const Patch& a_Patch, float a_Tolerance) const
+{
+    const int t_MaxSegments = m_Resolution - 1;
+    TessellationLevels t_Levels;
+    if(a_Tolerance <= 0.0f)
+    {
+        t_Levels.m_SegmentsU = t_Levels.m_SegmentsV = t_MaxSegments;
+        std::fill(t_Levels.m_EdgeSegments, t_Levels.m_EdgeSegments + 4, t_MaxSegments);
+        return t_Levels;
+    }
+
+    const int t_DegU = a_Patch.m_DegU;
+    const int t_DegV = a_Patch.m_DegV;
+    const float* t_Coefs = a_Patch.data();
+    auto t_Point = [&](int i, int j) { return t_Coefs + (i * (t_DegV + 1) + j) * 3; };
+    auto t_Norm = [](const double a_Vec[3]) { return std::sqrt(a_Vec[0] * a_Vec[0] + a_Vec[1] * a_Vec[1] + a_Vec[2] * a_Vec[2]); };
+
+    // Bounds of the second derivatives from the second differences of the coefficients
+    double t_MaxUU = 0.0, t_MaxVV = 0.0, t_MaxUV = 0.0;
+    for(int i = 0; i <= t_DegU; i++)
+    {
+        for(int j = 0; j <= t_DegV; j++)
+        {
+            double t_Diff[3];
+            if(i + 2 <= t_DegU)
+            {
+                for(int c = 0; c < 3; c++)
+                {
+                    t_Diff[c] = (double(t_Point(i, j)[c]) + t_Point(i+2, j)[c]) - 2.0 * t_Point(i+1, j)[c];
+                }
+                t_MaxUU = std::max(t_MaxUU, t_Norm(t_Diff));
+            }
+            if(j + 2 <= t_DegV)
+            {
+                for(int c = 0; c < 3; c++)
+                {
+                    t_Diff[c] = (double(t_Point(i, j)[c]) + t_Point(i, j+2)[c]) - 2.0 * t_Point(i, j+1)[c];
+                }
+                t_MaxVV = std::max(t_MaxVV, t_Norm(t_Diff));
+            }
+            if(i + 1 <= t_DegU && j + 1 <= t_DegV)
+            {
+                for(int c = 0; c < 3; c++)
+                {
+                    t_Diff[c] = (double(t_Point(i+1, j+1)[c]) + t_Point(i, j)[c]) - (double(t_Point(i+1, j)[c]) + t_Point(i, j+1)[c]);
+                }
+                t_MaxUV = std::max(t_MaxUV, t_Norm(t_Diff));
+            }
+        }
+    }
+    const double t_MUU = t_DegU * (t_DegU - 1) * t_MaxUU;
+    const double t_MVV = t_DegV * (t_DegV - 1) * t_MaxVV;
+    const double t_MUV = t_DegU * t_DegV * t_MaxUV;
+
+    // 2 h_u h_v M_uv <= (h_u² + h_v²) M_uv, each direction gets half the tolerance
+    auto t_Segments = [&](double a_Bound)
+    {
+        const double t_Segments = std::ceil(std::sqrt(a_Bound / (4.0 * a_Tolerance)));
+        return static_cast<int>(std::min<double>(std::max(t_Segments, 1.0), t_MaxSegments));
+    };
+    t_Levels.m_SegmentsU = t_Segments(t_MUU + t_MUV);
+    t_Levels.m_SegmentsV = t_Segments(t_MVV + t_MUV);
+
+    // Boundary curves v = 0, u = 1, v = 1, u = 0
+    t_Levels.m_EdgeSegments[0] = curve_segments(t_Point(0, 0), (t_DegV + 1) * 3, t_DegU, a_Tolerance, t_MaxSegments);
+    t_Levels.m_EdgeSegments[1] = curve_segments(t_Point(t_DegU, 0), 3, t_DegV, a_Tolerance, t_MaxSegments);
+    t_Levels.m_EdgeSegments[2] = curve_segments(t_Point(0, t_DegV), (t_DegV + 1) * 3, t_DegU, a_Tolerance, t_MaxSegments);
+    t_Levels.m_EdgeSegments[3] = curve_segments(t_Point(0, 0), 3, t_DegV, a_Tolerance, t_MaxSegments);
+
+    // Every sample of a boundary curve must be a grid vertex
+    t_Levels.m_SegmentsU = std::max({t_Levels.m_SegmentsU, t_Levels.m_EdgeSegments[0], t_Levels.m_EdgeSegments[2]});
+    t_Levels.m_SegmentsV = std::max({t_Levels.m_SegmentsV, t_Levels.m_EdgeSegments[1], t_Levels.m_EdgeSegments[3]});
+    return t_Levels;
+}
+
+void Tessellator::tessellateAdaptive(const Patch& a_Patch, float a_Tolerance, TessellatedMesh& a_Mesh) const
+{
+    const TessellationLevels t_Levels = chooseLevels(a_Patch, a_Tolerance);
+    const int t_NumU = t_Levels.m_SegmentsU + 1;
+    const int t_NumV = t_Levels.m_SegmentsV + 1;
+    const size_t t_NumVertices = static_cast<size_t>(t_NumU) * t_NumV;
+    const size_t t_FirstVertex = a_Mesh.m_Vertices.size() / 3;
+
+    a_Mesh.m_Vertices.resize(3 * (t_FirstVertex + t_NumVertices));
+    a_Mesh.m_Normals.resize(3 * (t_FirstVertex + t_NumVertices));
+    a_Mesh.m_UVs.resize(2 * (t_FirstVertex + t_NumVertices));
+    float* t_Vertices = a_Mesh.m_Vertices.data() + 3 * t_FirstVertex;
+    float* t_Normals = a_Mesh.m_Normals.data() + 3 * t_FirstVertex;
+    float* t_UVs = a_Mesh.m_UVs.data() + 2 * t_FirstVertex;
+    evaluateGrid(a_Patch, t_NumU, t_NumV, t_Vertices, t_Normals, t_UVs);
+
+    // Grid vertices moved onto the same boundary sample are merged, t_Merged leads to the vertex that is kept
+    std::vector<uint32_t> t_Merged(t_NumVertices);
+    for(size_t v = 0; v < t_NumVertices; v++)
+    {
+        t_Merged[v] = v;
+    }
+    auto t_Find = [&](uint32_t v)
+    {
+        while(t_Merged[v] != v)
+        {
+            v = t_Merged[v];
+        }
+        return v;
+    };
+
+    // Boundaries v = 0, u = 1, v = 1, u = 0: first vertex, step between vertices, number of vertices, grid segments along it
+    const int t_Edges[4][4] = {
+        {0, t_NumV, t_NumU, t_Levels.m_SegmentsU},
+        {(t_NumU - 1) * t_NumV, 1, t_NumV, t_Levels.m_SegmentsV},
+        {t_NumV - 1, t_NumV, t_NumU, t_Levels.m_SegmentsU},
+        {0, 1, t_NumV, t_Levels.m_SegmentsV}};
+    for(int e = 0; e < 4; e++)
+    {
+        const int k = t_Levels.m_EdgeSegments[e];
+        const int t_GridSegments = t_Edges[e][3];
+        if(k == t_GridSegments)
+        {
+            continue;
+        }
+        int t_PrevSample = -1;
+        uint32_t t_Kept = 0;
+        for(int i = 0; i < t_Edges[e][2]; i++)
+        {
+            const uint32_t t_Vertex = t_Edges[e][0] + i * t_Edges[e][1];
+            // Nearest of the k+1 samples. The grid is at least as fine as the samples, so every sample is taken by some vertex.
+            const int t_Sample = (2 * i * k + t_GridSegments) / (2 * t_GridSegments);
+            if(t_Sample == t_PrevSample)
+            {
+                const uint32_t t_Root = t_Find(t_Vertex);
+                if(t_Root != t_Kept)
+                {
+                    t_Merged[t_Root] = t_Kept;
+                }
+                continue;
+            }
+            t_PrevSample = t_Sample;
+            t_Kept = t_Find(t_Vertex);
+
+            const float t_Param = static_cast<float>(t_Sample) / k;
+            float* t_UV = t_UVs + 2 * t_Vertex;
+            t_UV[e % 2 == 0 ? 0 : 1] = t_Param;
+            evaluate_point(a_Patch, t_UV[0], t_UV[1], t_Vertices + 3 * t_Vertex, t_Normals + 3 * t_Vertex);
+        }
+    }
+
+    // Two triangles per grid cell, without the triangles that collapsed on a boundary
+    for(int i = 0; i < t_NumU - 1; i++)
+    {
+        for(int j = 0; j < t_NumV - 1; j++)
+        {
+            const uint32_t t_V00 = t_Find(i * t_NumV + j);
+            const uint32_t t_V10 = t_Find((i + 1) * t_NumV + j);
+            const uint32_t t_V01 = t_Find(i * t_NumV + j + 1);
+            const uint32_t t_V11 = t_Find((i + 1) * t_NumV + j + 1);
+            const uint32_t t_Triangles[2][3] = {{t_V00, t_V10, t_V01}, {t_V10, t_V11, t_V01}};
+            for(const auto& t_Triangle : t_Triangles)
+            {
+                if(t_Triangle[0] == t_Triangle[1] || t_Triangle[1] == t_Triangle[2] || t_Triangle[2] == t_Triangle[0])
+                {
+                    continue;
+                }
+                for(int c = 0; c < 3; c++)
+                {
+                    a_Mesh.m_Indices.push_back(t_FirstVertex + t_Triangle[c]);
+                }
+            }
+        }
+    }
+}
+
+void Tessellator::tessellateAdaptive(const Patch* a_Patches, size_t a_NumPatches, float a_Tolerance, TessellatedMesh& a_Mesh, int a_NumThreads) const
+{
+    // Tessellate every patch on its own, then concatenate
+    std::vector<TessellatedMesh> t_Parts(a_NumPatches);
+    Helper::parallel_for(0, a_NumPatches, a_NumThreads, [&](size_t p)
+    {
+        tessellateAdaptive(a_Patches[p], a_Tolerance, t_Parts[p]);
+    }, 64);
+
+    std::vector<size_t> t_FirstVertex(a_NumPatches + 1, 0);
+    std::vector<size_t> t_FirstIndex(a_NumPatches + 1, 0);
+    for(size_t p = 0; p < a_NumPatches; p++)
+    {
+        t_FirstVertex[p+1] = t_FirstVertex[p] + t_Parts[p].m_Vertices.size() / 3;
+        t_FirstIndex[p+1] = t_FirstIndex[p] + t_Parts[p].m_Indices.size();
+    }
+    a_Mesh.m_Vertices.resize(3 * t_FirstVertex[a_NumPatches]);
+    a_Mesh.m_Normals.resize(3 * t_FirstVertex[a_NumPatches]);
+    a_Mesh.m_UVs.resize(2 * t_FirstVertex[a_NumPatches]);
+    a_Mesh.m_Indices.resize(t_FirstIndex[a_NumPatches]);
+
+    Helper::parallel_for(0, a_NumPatches, a_NumThreads, [&](size_t p)
+    {
+        const TessellatedMesh& t_Part = t_Parts[p];
+        std::copy(t_Part.m_Vertices.begin(), t_Part.m_Vertices.end(), a_Mesh.m_Vertices.begin() + 3 * t_FirstVertex[p]);
+        std::copy(t_Part.m_Normals.begin(), t_Part.m_Normals.end(), a_Mesh.m_Normals.begin() + 3 * t_FirstVertex[p]);
+        std::copy(t_Part.m_UVs.begin(), t_Part.m_UVs.end(), a_Mesh.m_UVs.begin() + 2 * t_FirstVertex[p]);
+        const uint32_t t_Offset = t_FirstVertex[p];
+        std::transform(t_Part.m_Indices.begin(), t_Part.m_Indices.end(), a_Mesh.m_Indices.begin() + t_FirstIndex[p],
+                       [t_Offset](uint32_t a_Index) { return a_Index + t_Offset; });
+    }, 64);
+}
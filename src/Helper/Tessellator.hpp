@@ -0,0 +1,178 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../Patch/Patch.hpp"
+
+/**
+ * \ingroup utility
+ * @brief Triangle mesh of tessellated patches stored in flat buffers, ready to be uploaded to a GPU.
+ */
+struct TessellatedMesh
+{
+    /**
+     * @brief Vertex positions, x, y, z per vertex.
+     */
+    std::vector<float> m_Vertices;
+    /**
+     * @brief Unit normals, x, y, z per vertex.
+     */
+    std::vector<float> m_Normals;
+    /**
+     * @brief Patch parameters, u, v per vertex.
+     */
+    std::vector<float> m_UVs;
+    /**
+     * @brief Vertex indices, 3 per triangle.
+     */
+    std::vector<uint32_t> m_Indices;
+};
+
+/**
+ * \ingroup utility
+ * @brief The number of segments an adaptive tessellation uses for one patch.
+ */
+struct TessellationLevels
+{
+    /**
+     * @brief Number of segments of the grid in u direction.
+     */
+    int m_SegmentsU = 1;
+    /**
+     * @brief Number of segments of the grid in v direction.
+     */
+    int m_SegmentsV = 1;
+    /**
+     * @brief Number of segments of the boundary curves v = 0, u = 1, v = 1 and u = 0.
+     */
+    int m_EdgeSegments[4] = {1, 1, 1, 1};
+};
+
+/**
+ * \ingroup utility
+ * @brief Evaluates \ref Patch "Patches" on a grid of parameters and triangulates the grid.
+ *
+ * The Bernstein polynomials and their derivatives are tabulated once per degree and number of samples, so evaluating a
+ * patch is two tensor-product contractions of its coefficients with these tables instead of a De Casteljau evaluation per grid point.
+ * The contractions run over the samples in the innermost loop so that they are vectorized by the compiler.
+ *
+ * The uniform tessellation gives every patch n×n vertices, with vertex (i, j) at u = i/(n-1), v = j/(n-1), and 2(n-1)² triangles.
+ * The adaptive tessellation chooses the number of segments of each patch from a bound on the distance between the patch and
+ * its triangulation, see \ref chooseLevels. Patches do not share vertices.
+ */
+class Tessellator
+{
+public:
+    /**
+     * @brief Construct a Tessellator.
+     *
+     * @param a_Resolution The number of samples n per parameter direction of the uniform tessellation, at least 2.
+     * The adaptive tessellation uses at most n-1 segments per direction.
+     */
+    explicit Tessellator(int a_Resolution = 16);
+
+    int getResolution() const { return m_Resolution; }
+    size_t numVerticesPerPatch() const { return static_cast<size_t>(m_Resolution) * m_Resolution; }
+    size_t numIndicesPerPatch() const { return static_cast<size_t>(m_Resolution - 1) * (m_Resolution - 1) * 6; }
+
+    /**
+     * @brief Tessellate one patch uniformly into caller provided buffers.
+     *
+     * Any of the buffers may be null to skip it.
+     *
+     * @param a_Patch The patch to tessellate.
+     * @param a_Vertices 3 * \ref numVerticesPerPatch floats.
+     * @param a_Normals 3 * \ref numVerticesPerPatch floats.
+     * @param a_UVs 2 * \ref numVerticesPerPatch floats.
+     * @param a_Indices \ref numIndicesPerPatch indices.
+     * @param a_BaseVertex Added to every index, the index of the first vertex of this patch in the vertex buffer.
+     */
+    void tessellate(const Patch& a_Patch, float* a_Vertices, float* a_Normals, float* a_UVs, uint32_t* a_Indices, uint32_t a_BaseVertex = 0) const;
+
+    /**
+     * @brief Tessellate several patches uniformly into one mesh. The patches are tessellated in parallel.
+     *
+     * @param a_Patches Pointer to the first of a_NumPatches patches.
+     * @param a_NumPatches The number of patches.
+     * @param a_Mesh The output mesh. Its buffers are resized, the vertices of patch p start at p * \ref numVerticesPerPatch.
+     * @param a_NumThreads Number of threads, see \ref Helper::resolve_num_threads.
+     */
+    void tessellate(const Patch* a_Patches, size_t a_NumPatches, TessellatedMesh& a_Mesh, int a_NumThreads = 1) const;
+
+    /**
+     * @brief Choose the number of segments of a patch so that its triangulation is within a_Tolerance of the patch.
+     *
+     * The distance between a Bézier patch and the triangulation of a grid with steps h_u, h_v is at most
+     * 1/8 (h_u² M_uu + 2 h_u h_v M_uv + h_v² M_vv), where the M bound the second derivatives and are obtained from the
+     * second differences of the coefficients. The segments of each boundary curve are chosen from the curve alone,
+     * so two patches sharing a boundary curve choose the same segments for it. Curves below degree 3 are degree raised first,
+     * so that a curve shared with a degree raised neighbor gives the same result.
+     * The grid has at least as many segments as the boundary curves along it, and at most n-1 in either direction.
+     *
+     * @param a_Patch The patch.
+     * @param a_Tolerance The allowed distance between patch and triangulation. 0 or less selects n-1 segments everywhere.
+     * @return TessellationLevels
+     */
+    TessellationLevels chooseLevels(const Patch& a_Patch, float a_Tolerance) const;
+
+    /**
+     * @brief Tessellate one patch adaptively and append it to a mesh.
+     *
+     * The grid of \ref chooseLevels is evaluated, then the vertices on each boundary are moved to the nearest of the
+     * uniformly spaced samples of that boundary curve and triangles that collapse are dropped. A boundary is therefore
+     * triangulated exactly at its own samples, and adjacent patches meet without cracks or T-junctions.
+     *
+     * @param a_Patch The patch to tessellate.
+     * @param a_Tolerance The allowed distance between patch and triangulation, see \ref chooseLevels.
+     * @param a_Mesh The mesh the vertices and triangles are appended to.
+     */
+    void tessellateAdaptive(const Patch& a_Patch, float a_Tolerance, TessellatedMesh& a_Mesh) const;
+
+    /**
+     * @brief Tessellate several patches adaptively into one mesh. The patches are tessellated in parallel.
+     *
+     * @param a_Patches Pointer to the first of a_NumPatches patches.
+     * @param a_NumPatches The number of patches.
+     * @param a_Tolerance The allowed distance between patch and triangulation, see \ref chooseLevels.
+     * @param a_Mesh The output mesh. Its previous content is replaced, the patches follow each other in order.
+     * @param a_NumThreads Number of threads, see \ref Helper::resolve_num_threads.
+     */
+    void tessellateAdaptive(const Patch* a_Patches, size_t a_NumPatches, float a_Tolerance, TessellatedMesh& a_Mesh, int a_NumThreads = 1) const;
+
+private:
+    /*
+     * Bernstein polynomials of one degree and their derivatives at n uniform samples,
+     * the value of polynomial k at sample s is at [k * n + s].
+     */
+    struct BasisTable
+    {
+        std::vector<float> m_Values;
+        std::vector<float> m_Derivatives;
+    };
+
+    static BasisTable makeBasis(int a_Degree, int a_NumSamples);
+    const BasisTable& getBasis(int a_NumSamples, int a_Degree) const;
+
+    /*
+     * Evaluate positions, normals and parameters on a grid of a_NumU x a_NumV uniform samples, vertex (i, j) at i * a_NumV + j.
+     */
+    void evaluateGrid(const Patch& a_Patch, int a_NumU, int a_NumV, float* a_Vertices, float* a_Normals, float* a_UVs) const;
+
+    int m_Resolution;
+    /*
+     * Tables of the low degrees for every number of samples up to m_Resolution, built on first use
+     */
+    mutable std::vector<std::vector<BasisTable>> m_Bases;
+    std::unique_ptr<std::once_flag[]> m_BasesOnce;
+    mutable std::mutex m_HighDegreeMutex;
+    mutable std::map<std::pair<int, int>, std::unique_ptr<const BasisTable>> m_HighDegreeBases;
+    /*
+     * Vertex indices of the triangles of one uniformly tessellated patch whose first vertex is 0
+     */
+    std::vector<uint32_t> m_Indices;
+};
@@ -85,8 +85,6 @@ bool ExtraordinaryPatchConstructor::isSamePatchType(const VertexHandle& a_Vertex
     //     }
     // }
 
-    std::cout << t_Valence << "-valent EOP" << std::endl;
-
     return true;
 }
 
@@ -154,26 +152,24 @@ PatchBuilder ExtraordinaryPatchConstructor::getPatchBuilder(const VertexHandle&
     // Get neighbor verts
     auto t_NBVerts = initNeighborVerts(a_VertexHandle, a_Mesh);
 
-    // Convert neighbor verts to matrix type
-    auto t_NBVertsMat = Helper::verthandles_to_points_mat(a_Mesh, t_NBVerts);
 
-    Matrix t_mask;
+    SharedMatrix t_mask;
     switch(t_ExtrPointValence)
     {
         case 3:
-            t_mask = m_MaskSct3;
+            t_mask = m_MaskSct3.get();
             break;
         case 5:
-            t_mask = m_MaskSct5;
+            t_mask = m_MaskSct5.get();
             break;
         case 6:
-            t_mask = m_MaskSct6;
+            t_mask = m_MaskSct6.get();
             break;
         case 7:
-            t_mask = m_MaskSct7;
+            t_mask = m_MaskSct7.get();
             break;
         case 8:
-            t_mask = m_MaskSct8;
+            t_mask = m_MaskSct8.get();
             break;
     }
 
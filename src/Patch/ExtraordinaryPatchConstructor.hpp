@@ -4,6 +4,7 @@
 
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 #include "PatchConstructor.hpp"
+#include "LazyMask.hpp"
 #include "../Helper/Helper.hpp"
 
 typedef Matrix Mat48x7d;
@@ -20,11 +21,11 @@ class ExtraordinaryPatchConstructor : public PatchConstructor
 {
 public:
     ExtraordinaryPatchConstructor()
-        : m_MaskSct3(getMaskSct3()),
-          m_MaskSct5(getMaskSct5()),
-          m_MaskSct6(getMaskSct6()),
-          m_MaskSct7(getMaskSct7()),
-          m_MaskSct8(getMaskSct8()) {};
+        : m_MaskSct3([this]() { return getMaskSct3(); }),
+          m_MaskSct5([this]() { return getMaskSct5(); }),
+          m_MaskSct6([this]() { return getMaskSct6(); }),
+          m_MaskSct7([this]() { return getMaskSct7(); }),
+          m_MaskSct8([this]() { return getMaskSct8(); }) {};
 
     bool isSamePatchType(const VertexHandle& a_VertexHandle, MeshType& a_Mesh, bool check_marked = false) override;
     PatchBuilder getPatchBuilder(const VertexHandle& a_VertexHandle, MeshType& a_Mesh, bool mark_gathered = false) override;
@@ -34,23 +35,23 @@ private:
     /**
      * @brief The mask for the extraordinary patch with valence = 3.
      */
-    const Mat48x7d m_MaskSct3;
+    const LazyMask m_MaskSct3;
     /**
      * @brief The mask for the extraordinary patch with valence = 5.
      */
-    const Mat80x11d m_MaskSct5;
+    const LazyMask m_MaskSct5;
     /**
      * @brief The mask for the extraordinary patch with valence = 6.
      */
-    const Mat384x13d m_MaskSct6;
+    const LazyMask m_MaskSct6;
     /**
      * @brief The mask for the extraordinary patch with valence = 7.
      */
-    const Mat448x15d m_MaskSct7;
+    const LazyMask m_MaskSct7;
     /**
      * @brief The mask for the extraordinary patch with valence = 8.
      */
-    const Mat512x17d m_MaskSct8;
+    const LazyMask m_MaskSct8;
 
     /**
      * @brief Retrieves the mask for the extraordinary patch with valence = 3.
@@ -0,0 +1,46 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "../Helper/Matrix.hpp"
+
+/**
+ * \ingroup patch_build
+ * @brief A mask of a \ref PatchConstructor that is only loaded when it is first used.
+ *
+ * A mesh usually only has a few valences, so the masks of the other valences are never loaded.
+ * Loading is thread safe: concurrent first uses load the mask once and all callers get the same shared matrix.
+ */
+class LazyMask
+{
+public:
+    /**
+     * @brief Construct a LazyMask.
+     *
+     * @param a_Loader Called once, on first use, to produce the mask.
+     */
+    explicit LazyMask(std::function<Matrix()> a_Loader)
+        : m_Loader(std::move(a_Loader)) {};
+
+    LazyMask(const LazyMask&) = delete;
+    LazyMask& operator=(const LazyMask&) = delete;
+
+    /**
+     * @brief Get the mask, loading it on first use.
+     *
+     * @return const SharedMatrix& The mask, shared by all \ref PatchBuilder "PatchBuilders" using it.
+     */
+    const SharedMatrix& get() const
+    {
+        std::call_once(m_Once, [this]() { m_Mask = std::make_shared<const Matrix>(m_Loader()); });
+        return m_Mask;
+    }
+
+private:
+    std::function<Matrix()> m_Loader;
+    mutable std::once_flag m_Once;
+    mutable SharedMatrix m_Mask;
+};
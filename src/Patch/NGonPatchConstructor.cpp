@@ -65,45 +65,40 @@ bool NGonPatchConstructor::isSamePatchType(const FaceHandle& a_FaceHandle, MeshT
         return false;
     }
 
-    std::cout << t_FaceValence << "-gon" << std::endl;
-
     return true;
 }
 
 PatchBuilder NGonPatchConstructor::getPatchBuilder(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, bool mark_gathered)
 {
-    m_FaceValence = Helper::get_num_of_verts_for_face(a_Mesh, a_FaceHandle);
+    const int t_FaceValence = Helper::get_num_of_verts_for_face(a_Mesh, a_FaceHandle);
 
     // Get neighbor verts
-    auto t_NBVerts = initNeighborVerts(a_FaceHandle, a_Mesh);
-
-    // Convert Neighbor Verts to matrix type
-    auto t_NBVertsMat = Helper::verthandles_to_points_mat(a_Mesh, t_NBVerts);
+    auto t_NBVerts = initNeighborVerts(a_FaceHandle, a_Mesh, t_FaceValence);
 
     // Generate patch
-    Matrix t_mask;
-    switch(m_FaceValence)
+    SharedMatrix t_mask;
+    switch(t_FaceValence)
     {
         case 3:
-            t_mask = m_MaskSct3;
+            t_mask = m_MaskSct3.get();
             break;
         case 5:
-            t_mask = m_MaskSct5;
+            t_mask = m_MaskSct5.get();
             break;
         case 6:
-            t_mask = m_MaskSct6;
+            t_mask = m_MaskSct6.get();
             break;
         case 7:
-            t_mask = m_MaskSct7;
+            t_mask = m_MaskSct7.get();
             break;
         case 8:
-            t_mask = m_MaskSct8;
+            t_mask = m_MaskSct8.get();
             break;
     }
 
     // Only one bi3 patch for each sector when n = 3,5 other wise four per sector
-    int a_NumOfPatch = m_FaceValence;
-    if(m_FaceValence!=3 && m_FaceValence!=5)
+    int a_NumOfPatch = t_FaceValence;
+    if(t_FaceValence!=3 && t_FaceValence!=5)
     {
         a_NumOfPatch = a_NumOfPatch * 4;
     }
@@ -127,10 +122,10 @@ PatchBuilder NGonPatchConstructor::getPatchBuilder(const FaceHandle& a_FaceHandl
  *    |   |   |   |
  *    0 - 1 - 6 - 4
  */
-std::vector<VertexHandle> NGonPatchConstructor::initNeighborVerts(const FaceHandle& a_FaceHandle, MeshType& a_Mesh)
+std::vector<VertexHandle> NGonPatchConstructor::initNeighborVerts(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, const int a_FaceValence)
 {
     // Init vector for neighbor points
-    const int t_NumOfVerts = 4 * m_FaceValence;
+    const int t_NumOfVerts = 4 * a_FaceValence;
     std::vector<VertexHandle> t_NBVerts;
     Helper::set_vert_vector_to_default(t_NumOfVerts, t_NBVerts);
 
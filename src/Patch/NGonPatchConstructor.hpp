@@ -4,6 +4,7 @@
 
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 #include "PatchConstructor.hpp"
+#include "LazyMask.hpp"
 #include "../Helper/Helper.hpp"
 
 typedef Matrix Mat48x12d;
@@ -20,11 +21,11 @@ class NGonPatchConstructor : public PatchConstructor
 {
 public:
     NGonPatchConstructor()
-        : m_MaskSct3(getMaskSct3()),
-          m_MaskSct5(getMaskSct5()),
-          m_MaskSct6(getMaskSct6()),
-          m_MaskSct7(getMaskSct7()),
-          m_MaskSct8(getMaskSct8()) {};
+        : m_MaskSct3([this]() { return getMaskSct3(); }),
+          m_MaskSct5([this]() { return getMaskSct5(); }),
+          m_MaskSct6([this]() { return getMaskSct6(); }),
+          m_MaskSct7([this]() { return getMaskSct7(); }),
+          m_MaskSct8([this]() { return getMaskSct8(); }) {};
 
     bool isSamePatchType(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, bool check_marked = false) override;
     PatchBuilder getPatchBuilder(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, bool mark_gathered = false) override;
@@ -33,24 +34,23 @@ private:
     /**
      * @brief The mask for the n-gon patch with 3 sides
      */
-    const Mat48x12d m_MaskSct3;
+    const LazyMask m_MaskSct3;
     /**
      * @brief The mask for the n-gon patch with 5 sides
      */
-    const Mat80x20d m_MaskSct5;
+    const LazyMask m_MaskSct5;
     /**
      * @brief The mask for the n-gon patch with 6 sides
      */
-    const Mat384x24d m_MaskSct6;
+    const LazyMask m_MaskSct6;
     /**
      * @brief The mask for the n-gon patch with 7 sides
      */
-    const Mat448x28d m_MaskSct7;
+    const LazyMask m_MaskSct7;
     /**
      * @brief The mask for the n-gon patch with 8 sides
      */
-    const Mat512x32d m_MaskSct8;
-    int m_FaceValence;
+    const LazyMask m_MaskSct8;
 
     /**
      * @brief Retrieves the mask for the n-gon patch with 3 sides.
@@ -98,8 +98,9 @@ private:
      * 
      * @param a_FaceHandle The face handle around for which to initialize neighbors.
      * @param a_Mesh The mesh to which the face belongs.
+     * @param a_FaceValence The number of vertices of the face.
      * @return A vector of neighboring vertex handles.
      */
-    std::vector<VertexHandle> initNeighborVerts(const FaceHandle& a_FaceHandle, MeshType& a_Mesh);
+    std::vector<VertexHandle> initNeighborVerts(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, const int a_FaceValence);
     std::string getGroupName() const;
 };
@@ -3,69 +3,132 @@
 #pragma once
 
 #include "Patch.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<>::Point Point;
 
+/*
+ * Process-wide table of group names. Names are never removed, so references to them stay valid.
+ * Names live in fixed size chunks that are never moved once published, so groupName reads
+ * without the mutex: an id is only known after internGroup has written its name.
+ */
+struct GroupTable
+{
+    static constexpr uint32_t s_ChunkSize = 1024;
+    static constexpr uint32_t s_NumChunks = 4096;
+
+    std::mutex m_Mutex; // serializes internGroup
+    std::array<std::atomic<std::string*>, s_NumChunks> m_Chunks{};
+    std::vector<std::unique_ptr<std::string[]>> m_Storage;
+    std::unordered_map<std::string, uint32_t> m_Ids;
+
+    GroupTable()
+    {
+        append("Group 0 default");
+    }
+
+    // Caller holds m_Mutex
+    uint32_t append(const std::string& a_Name)
+    {
+        const uint32_t t_Id = m_Ids.size();
+        const uint32_t t_Chunk = t_Id / s_ChunkSize;
+        if(t_Chunk >= s_NumChunks)
+        {
+            throw std::length_error("Too many group names");
+        }
+        if(t_Id % s_ChunkSize == 0)
+        {
+            m_Storage.emplace_back(new std::string[s_ChunkSize]);
+            m_Chunks[t_Chunk].store(m_Storage.back().get(), std::memory_order_release);
+        }
+        m_Storage.back()[t_Id % s_ChunkSize] = a_Name;
+        m_Ids.emplace(a_Name, t_Id);
+        return t_Id;
+    }
+
+    const std::string& name(uint32_t a_Id) const
+    {
+        return m_Chunks[a_Id / s_ChunkSize].load(std::memory_order_acquire)[a_Id % s_ChunkSize];
+    }
+};
+
+static GroupTable& groupTable()
+{
+    static GroupTable s_Table;
+    return s_Table;
+}
+
+uint32_t Patch::internGroup(const std::string& a_Group)
+{
+    GroupTable& t_Table = groupTable();
+    std::lock_guard<std::mutex> t_Lock(t_Table.m_Mutex);
+    auto t_It = t_Table.m_Ids.find(a_Group);
+    if(t_It != t_Table.m_Ids.end())
+    {
+        return t_It->second;
+    }
+    return t_Table.append(a_Group);
+}
+
+const std::string& Patch::groupName(uint32_t a_GroupId)
+{
+    return groupTable().name(a_GroupId);
+}
+
+const std::string& Patch::getGroup() const
+{
+    return groupName(m_GroupId);
+}
+
+void Patch::setGroup(const std::string& a_Group)
+{
+    m_GroupId = internGroup(a_Group);
+}
+
 Patch::Patch() {};
 Patch::Patch(int a_BiDeg) : m_DegU(a_BiDeg), m_DegV(a_BiDeg)
 {
-    m_BBcoefs.resize(a_BiDeg+1);
-    for(int row=0; row<a_BiDeg+1; ++row){
-        m_BBcoefs[row].resize(a_BiDeg+1);
-    }
     initBBcoefs();
 };
 
-Patch::Patch(int a_BiDeg, std::string a_Group) : m_DegU(a_BiDeg), m_DegV(a_BiDeg), m_Group(a_Group)
+Patch::Patch(int a_BiDeg, std::string a_Group) : m_DegU(a_BiDeg), m_DegV(a_BiDeg), m_GroupId(internGroup(a_Group))
 {
-    m_BBcoefs.resize(a_BiDeg+1);
-    for(int row=0; row<a_BiDeg+1; ++row){
-        m_BBcoefs[row].resize(a_BiDeg+1);
-    }
     initBBcoefs();
 };
 
 Patch::Patch(int a_DegU, int a_DegV) : m_DegU(a_DegU), m_DegV(a_DegV)
 {
-    m_BBcoefs.resize(a_DegU+1);
-    for(int row=0; row<a_DegU+1; ++row){
-        m_BBcoefs[row].resize(a_DegV+1);
-    }
     initBBcoefs();
 };
 
-Patch::Patch(int a_DegU, int a_DegV, std::string a_Group) : m_DegU(a_DegU), m_DegV(a_DegV), m_Group(a_Group)
+Patch::Patch(int a_DegU, int a_DegV, std::string a_Group) : m_DegU(a_DegU), m_DegV(a_DegV), m_GroupId(internGroup(a_Group))
+{
+    initBBcoefs();
+};
+
+Patch::Patch(int a_DegU, int a_DegV, uint32_t a_GroupId) : m_DegU(a_DegU), m_DegV(a_DegV), m_GroupId(a_GroupId)
 {
-    m_BBcoefs.resize(a_DegU+1);
-    for(int row=0; row<a_DegU+1; ++row){
-        m_BBcoefs[row].resize(a_DegV+1);
-    }
     initBBcoefs();
 };
 
 bool Patch::isValid() const
 {
-    int t_NumCpts = 0;
-    for(size_t row=0; row<m_BBcoefs.size(); ++row){
-        t_NumCpts += m_BBcoefs[row].size();
-    }
     int t_OrderU = m_DegU+1;
     int t_OrderV = m_DegV+1;
     int t_ExpectedCpts = t_OrderU*t_OrderV;
 
-    return (t_NumCpts == t_ExpectedCpts);
+    return (m_Coefs.size() == static_cast<size_t>(t_ExpectedCpts) * 3);
 }
 
 // Init each cpts as {0,0,0}
 void Patch::initBBcoefs()
 {
-    for(int i=0; i<m_BBcoefs.size(); i++)
-    {
-        for(int j=0; j<m_BBcoefs[0].size(); j++)
-        {
-            m_BBcoefs[i][j] = {0,0,0};
-        }
-    }
+    m_Coefs.assign(static_cast<size_t>(m_DegU+1) * (m_DegV+1) * 3, 0.0f);
 }
 
 void Patch::degRaise()
@@ -83,6 +146,7 @@ void Patch::degRaise()
     int t_VR = t_IsRaiseV ? m_DegV+1 : m_DegV;
 
     std::vector<std::vector<Point>> t_BBUR(t_UR+1, std::vector<Point>(m_DegV+1, {0,0,0})); // u-direction deg raised BB-coef
+    std::vector<std::vector<Point>> t_BBcoefs; // deg raised BB-coef
 
     // deg raise u direction
     if(t_IsRaiseU)
@@ -94,12 +158,12 @@ void Patch::degRaise()
             {
                 int a = (i-1 < 0) ? 0 : i-1;
                 int b = (i > m_DegU) ? i-1 : i;
-                t_BBUR[i][j] = (i*m_BBcoefs[a][j] + k*m_BBcoefs[b][j]) / t_UR;
+                t_BBUR[i][j] = (i*getPoint(a, j) + k*getPoint(b, j)) / t_UR;
             }
         }
         if(!t_IsRaiseV)
         {
-            m_BBcoefs = t_BBUR;
+            t_BBcoefs = t_BBUR;
         }
     }
 
@@ -113,13 +177,13 @@ void Patch::degRaise()
             for(int i=0; i<=m_DegU; i++)
             {
                 int a = (j-1 < 0) ? 0 : j-1;
-                int b = (j > m_DegU) ? j-1 : j;
-                t_BBVR[i][j] = (j*m_BBcoefs[i][a] + k*m_BBcoefs[i][b]) / t_VR;
+                int b = (j > m_DegV) ? j-1 : j;
+                t_BBVR[i][j] = (j*getPoint(i, a) + k*getPoint(i, b)) / t_VR;
             }
         }
-        m_BBcoefs = t_BBVR;
+        t_BBcoefs = t_BBVR;
     }
-    else  // deg raise u & v direction
+    else if(t_IsRaiseV) // deg raise u & v direction
     {
         std::vector<std::vector<Point>> t_BBR(t_UR+1, std::vector<Point>(t_VR+1, {0,0,0})); // both-direction deg raised BB-coef
         for(int j=0; j<=t_VR; j++)
@@ -128,24 +192,32 @@ void Patch::degRaise()
             for(int i=0; i<=t_UR; i++)
             {
                 int a = (j-1 < 0) ? 0 : j-1;
-                int b = (j > t_UR) ? j-1 : j;
+                int b = (j > m_DegV) ? j-1 : j;
                 t_BBR[i][j] = (j*t_BBUR[i][a] + k*t_BBUR[i][b]) / t_VR;
             }
         }
-        m_BBcoefs = t_BBR;
+        t_BBcoefs = t_BBR;
     }
 
     // update member deg
     m_DegU = t_UR;
     m_DegV = t_VR;
+    initBBcoefs();
+    for(int i=0; i<=m_DegU; i++)
+    {
+        for(int j=0; j<=m_DegV; j++)
+        {
+            setPoint(i, j, t_BBcoefs[i][j]);
+        }
+    }
 }
 
 Patch& Patch::operator=(const Patch& other) {
     if (this != &other) {
         m_DegU = other.m_DegU;
         m_DegV = other.m_DegV;
-        m_Group = other.m_Group;
-        m_BBcoefs = other.m_BBcoefs;
+        m_GroupId = other.m_GroupId;
+        m_Coefs = other.m_Coefs;
     }
     return *this;
 }
@@ -154,8 +226,8 @@ Patch& Patch::operator=(Patch&& other) noexcept {
     if (this != &other) {
         m_DegU = other.m_DegU;
         m_DegV = other.m_DegV;
-        m_Group = std::move(other.m_Group);
-        m_BBcoefs = std::move(other.m_BBcoefs);
+        m_GroupId = other.m_GroupId;
+        m_Coefs = std::move(other.m_Coefs);
     }
     return *this;
-}
\ No newline at end of file
+}
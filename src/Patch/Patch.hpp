@@ -3,7 +3,10 @@
 #pragma once
 
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+#include <cstdint>
 #include <iostream>
+#include <string>
+#include <vector>
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<>::Point Point;
 
@@ -15,6 +18,10 @@ extern "C" {
  * 
  * The Patch class encapsulates the properties and control points of a Bézier patch.
  * It includes methods for initialization, validation, and degree elevation.
+ *
+ * The control points are stored in one contiguous buffer of (m_DegU+1)*(m_DegV+1)*3 floats.
+ * The coordinate k of control point [i][j] is at index (i*(m_DegV+1) + j)*3 + k, see \ref data.
+ * The group name is interned: patches only store an id into a process-wide table of group names.
  */
 struct Patch
 {
@@ -24,6 +31,15 @@ struct Patch
      */
     Patch();
 
+    /**
+     * @brief Construct a new Patch object
+     * 
+     * @param a_DegU The degree of the patch in the u direction.
+     * @param a_DegV The degree of the patch in the v direction.
+     * @param a_GroupId The id of the group name associated with the patch, see \ref internGroup.
+     */
+    Patch(int a_DegU, int a_DegV, uint32_t a_GroupId);
+
     /**
      * @brief Construct a new Patch object
      * 
@@ -86,6 +102,66 @@ struct Patch
      */
     Patch& operator=(Patch&& other) noexcept;
 
+    /**
+     * @brief Pointer to the (m_DegU+1)*(m_DegV+1)*3 coefficients, control point by control point, row by row.
+     */
+    float* data() { return m_Coefs.data(); }
+    const float* data() const { return m_Coefs.data(); }
+
+    /**
+     * @brief The number of floats in \ref data.
+     */
+    size_t size() const { return m_Coefs.size(); }
+
+    /**
+     * @brief Coordinate a_K of control point [a_I][a_J].
+     */
+    float& operator()(int a_I, int a_J, int a_K) { return m_Coefs[(static_cast<size_t>(a_I) * (m_DegV + 1) + a_J) * 3 + a_K]; }
+    const float& operator()(int a_I, int a_J, int a_K) const { return m_Coefs[(static_cast<size_t>(a_I) * (m_DegV + 1) + a_J) * 3 + a_K]; }
+
+    /**
+     * @brief Get control point [a_I][a_J].
+     */
+    Point getPoint(int a_I, int a_J) const
+    {
+        const float* t_Coef = &(*this)(a_I, a_J, 0);
+        return Point(t_Coef[0], t_Coef[1], t_Coef[2]);
+    }
+
+    /**
+     * @brief Set control point [a_I][a_J].
+     */
+    void setPoint(int a_I, int a_J, const Point& a_Point)
+    {
+        float* t_Coef = &(*this)(a_I, a_J, 0);
+        t_Coef[0] = a_Point[0];
+        t_Coef[1] = a_Point[1];
+        t_Coef[2] = a_Point[2];
+    }
+
+    /**
+     * @brief Get the group name associated with the patch.
+     */
+    const std::string& getGroup() const;
+
+    /**
+     * @brief Set the group name associated with the patch.
+     */
+    void setGroup(const std::string& a_Group);
+
+    /**
+     * @brief Id of a group name in the table of group names. Equal names get equal ids.
+     * 
+     * @param a_Group The group name.
+     * @return uint32_t The id, valid for the lifetime of the process.
+     */
+    static uint32_t internGroup(const std::string& a_Group);
+
+    /**
+     * @brief The group name of an id returned by \ref internGroup. Does not lock, so consumers can call it per patch.
+     */
+    static const std::string& groupName(uint32_t a_GroupId);
+
     /**
      * @brief Checks if a patch is valid.
      * @return true if the patch is valid, false otherwise.
@@ -108,7 +184,7 @@ struct Patch
      * Please find patch type at
      * https://www.cise.ufl.edu/research/SurfLab/bview/#file-format
      */ 
-    const std::string m_PatchType = "5";
+    inline static const std::string m_PatchType = "5";
 
     /**
      * @brief Degree in u direction.
@@ -122,17 +198,16 @@ struct Patch
     int m_DegV;
 
     /**
-     * @brief Group name associated with the patch.
-     * 
+     * @brief Id of the group name associated with the patch, see \ref getGroup.
+     * Id 0 is "Group 0 default".
      */
-    std::string m_Group = "Group 0 default";
+    uint32_t m_GroupId = 0;
 
     /**
      * @brief Control points of the Bézier patch.
      * 
-     * This is a 2D vector where each element represents a control point in 3D space.
-     * The size of the outer vector is (m_DegU + 1) and the size of the inner vectors is (m_DegV + 1).
+     * Flat buffer of (m_DegU + 1) * (m_DegV + 1) control points with 3 coordinates each, see \ref data.
      */
-    std::vector<std::vector<Point>> m_BBcoefs;
+    std::vector<float> m_Coefs;
 };
 }
\ No newline at end of file
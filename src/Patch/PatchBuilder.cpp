@@ -2,23 +2,29 @@
 
 #include "PatchBuilder.hpp"
 #include "PatchConstructor.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
 
-PatchBuilder::PatchBuilder(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, const Matrix& a_Mask, PatchConstructor* a_PatchConstructor, int a_NumOfPatches){
+PatchBuilder::PatchBuilder(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, SharedMatrix a_Mask, PatchConstructor* a_PatchConstructor, int a_NumOfPatches){
     m_NumOfPatches = a_NumOfPatches;
-    int t_NumOfCCPtsPerPatch = a_Mask.getRows() / m_NumOfPatches;
+    int t_NumOfCCPtsPerPatch = a_Mask->getRows() / m_NumOfPatches;
     const int t_Deg = sqrt(t_NumOfCCPtsPerPatch) - 1;
     m_DegU = t_Deg;
     m_DegV = t_Deg;
     m_PatchConstructor = a_PatchConstructor;
-    initializeMaskAndNeighborVertices(a_Mesh, a_NBVertexHandles, a_Mask);
+    initializeMaskAndNeighborVertices(a_Mesh, a_NBVertexHandles, std::move(a_Mask));
 };
-PatchBuilder::PatchBuilder(const MeshType& a_Mesh,std::vector<VertexHandle> a_NBVertexHandles, const Matrix& a_Mask, PatchConstructor* a_PatchConstructor, int a_DegU, int a_DegV){
+PatchBuilder::PatchBuilder(const MeshType& a_Mesh,std::vector<VertexHandle> a_NBVertexHandles, SharedMatrix a_Mask, PatchConstructor* a_PatchConstructor, int a_DegU, int a_DegV){
     m_DegU = a_DegU;
     m_DegV = a_DegV;
     int t_NumOfCCPtsPerPatch = (m_DegU + 1) * (m_DegV + 1);
-    m_NumOfPatches = a_Mask.getRows() / t_NumOfCCPtsPerPatch;
+    m_NumOfPatches = a_Mask->getRows() / t_NumOfCCPtsPerPatch;
     m_PatchConstructor = a_PatchConstructor;
-    initializeMaskAndNeighborVertices(a_Mesh, a_NBVertexHandles, a_Mask);
+    initializeMaskAndNeighborVertices(a_Mesh, a_NBVertexHandles, std::move(a_Mask));
 };
 
 PatchBuilder& PatchBuilder::operator=(const PatchBuilder& a_PatchBuilder){
@@ -29,112 +35,269 @@ PatchBuilder& PatchBuilder::operator=(const PatchBuilder& a_PatchBuilder){
         m_NumOfPatches = a_PatchBuilder.m_NumOfPatches;
         m_DegU = a_PatchBuilder.m_DegU;
         m_DegV = a_PatchBuilder.m_DegV;
+        m_IsMaskShared = a_PatchBuilder.m_IsMaskShared;
     }
     return *this;
 }
 
 std::vector<VertexHandle> PatchBuilder::getNeighborVerts() const { return m_NBVertexHandles; }
 
-Matrix PatchBuilder::getMask() const { return m_Mask; }
+const Matrix& PatchBuilder::getMask() const { return *m_Mask; }
 
 const PatchConstructor* PatchBuilder::getPatchConstructor() const { return m_PatchConstructor; }
 
 std::vector<Patch> PatchBuilder::buildPatches(const MeshType& a_Mesh) const{
     auto t_NBVertsMat = Helper::verthandles_to_points_mat(a_Mesh, m_NBVertexHandles);
-    auto t_BBcoefs = m_Mask * t_NBVertsMat;
+    auto t_BBcoefs = *m_Mask * t_NBVertsMat;
     return Helper::points_mat_to_patches(m_DegU, m_DegV, m_PatchConstructor->getGroupName(), t_BBcoefs);
 }
 
+void PatchBuilder::applyDelta(int a_Column, const Point& a_Delta, Patch* const* a_Patches) const{
+    const Matrix& t_Mask = *m_Mask;
+    const int t_NumOfCCPtsPerPatch = (m_DegU + 1) * (m_DegV + 1);
+    for(int t_Patch = 0; t_Patch < m_NumOfPatches; t_Patch++)
+    {
+        float* t_Coefs = a_Patches[t_Patch]->data();
+        const int t_FirstRow = t_Patch * t_NumOfCCPtsPerPatch;
+        for(int r = 0; r < t_NumOfCCPtsPerPatch; r++)
+        {
+            const double t_Weight = t_Mask(t_FirstRow + r, a_Column);
+            if(t_Weight == 0.0)
+            {
+                continue;
+            }
+            for(int k = 0; k < 3; k++)
+            {
+                t_Coefs[3*r+k] += t_Weight * a_Delta[k];
+            }
+        }
+    }
+}
+
+std::vector<Patch> PatchBuilder::buildPatchesBatched(const MeshType& a_Mesh, const PatchBuilder* a_PatchBuilders, size_t a_NumBuilders)
+{
+    // Index of the first output patch of every builder
+    std::vector<size_t> t_PatchOffsets(a_NumBuilders + 1, 0);
+    for(size_t b = 0; b < a_NumBuilders; b++)
+    {
+        t_PatchOffsets[b+1] = t_PatchOffsets[b] + a_PatchBuilders[b].m_NumOfPatches;
+    }
+
+    // Group the builders that share a mask. Builders gathered on the original mesh share the mask of their constructor.
+    std::vector<std::vector<size_t>> t_Groups;
+    std::map<std::pair<const Matrix*, const PatchConstructor*>, size_t> t_GroupIndices;
+    for(size_t b = 0; b < a_NumBuilders; b++)
+    {
+        auto t_Key = std::make_pair(a_PatchBuilders[b].m_Mask.get(), a_PatchBuilders[b].getPatchConstructor());
+        auto t_It = t_GroupIndices.find(t_Key);
+        if(t_It == t_GroupIndices.end())
+        {
+            t_GroupIndices.emplace(t_Key, t_Groups.size());
+            t_Groups.push_back({b});
+        }
+        else
+        {
+            t_Groups[t_It->second].push_back(b);
+        }
+    }
+
+    // Bound the size of the gathered point matrix so that it stays in cache
+    const size_t t_MaxBatch = 256;
+    std::vector<Patch> t_Patches(t_PatchOffsets[a_NumBuilders]);
+    for(const auto& t_Group : t_Groups)
+    {
+        const PatchBuilder& t_First = a_PatchBuilders[t_Group[0]];
+        const Matrix& t_Mask = *t_First.m_Mask;
+        const int t_NumRows = t_Mask.getRows();
+        const int t_NumCols = t_Mask.getCols();
+        const int t_NumOfCCPtsPerPatch = (t_First.m_DegU + 1) * (t_First.m_DegV + 1);
+        const uint32_t t_GroupId = Patch::internGroup(t_First.m_PatchConstructor->getGroupName());
+
+        for(size_t t_Begin = 0; t_Begin < t_Group.size(); t_Begin += t_MaxBatch)
+        {
+            const int t_Batch = static_cast<int>(std::min(t_MaxBatch, t_Group.size() - t_Begin));
+
+            // Column 3b+c of the panel holds coordinate c of the neighbor points of the b-th builder
+            Matrix t_Panel(t_NumCols, 3 * t_Batch);
+            for(int b = 0; b < t_Batch; b++)
+            {
+                const auto& t_NBVertexHandles = a_PatchBuilders[t_Group[t_Begin + b]].m_NBVertexHandles;
+                for(int k = 0; k < t_NumCols; k++)
+                {
+                    if(!t_NBVertexHandles[k].is_valid())
+                    {
+                        continue;
+                    }
+                    const auto& t_Point = a_Mesh.point(t_NBVertexHandles[k]);
+                    double* t_Row = t_Panel.row(k) + 3 * b;
+                    t_Row[0] = t_Point[0];
+                    t_Row[1] = t_Point[1];
+                    t_Row[2] = t_Point[2];
+                }
+            }
+
+            Matrix t_BBcoefs(t_NumRows, 3 * t_Batch);
+            Matrix::multiply(t_Mask, t_Panel, t_BBcoefs.data());
+
+            for(int b = 0; b < t_Batch; b++)
+            {
+                const size_t t_Builder = t_Group[t_Begin + b];
+                for(int p = 0; p < a_PatchBuilders[t_Builder].m_NumOfPatches; p++)
+                {
+                    Patch& t_Patch = t_Patches[t_PatchOffsets[t_Builder] + p];
+                    t_Patch = Patch(t_First.m_DegU, t_First.m_DegV, t_GroupId);
+                    float* t_Out = t_Patch.data();
+                    for(int c = 0; c < t_NumOfCCPtsPerPatch; c++)
+                    {
+                        const double* t_Coef = t_BBcoefs.row(p * t_NumOfCCPtsPerPatch + c) + 3 * b;
+                        t_Out[3*c+0] = t_Coef[0];
+                        t_Out[3*c+1] = t_Coef[1];
+                        t_Out[3*c+2] = t_Coef[2];
+                    }
+                }
+            }
+        }
+    }
+    return t_Patches;
+}
+
 static int getCPIndex(int a_DegU, int a_DegV, int patchIdx, int i, int j){
     int t_NumOfCCPtsPerPatch = (a_DegU + 1) * (a_DegV + 1);
     return patchIdx * t_NumOfCCPtsPerPatch + i * (a_DegV+1) + j;
 }
-void PatchBuilder::degRaise(){
-    int t_NumOfPatches = m_NumOfPatches;
-    int t_NumOfCCPtsPerPatch  = m_Mask.getRows() / m_NumOfPatches;
-    bool t_IsRaiseU = m_DegU < 3;
-    bool t_IsRaiseV = m_DegV < 3;
-    if(!t_IsRaiseU && !t_IsRaiseV)
-    {
-        return;
-    }
-    int t_UR = t_IsRaiseU ? m_DegU+1 : m_DegU;
-    int t_VR = t_IsRaiseV ? m_DegV+1 : m_DegV;
-    
-    Matrix t_BBUR((t_UR+1) * (m_DegV+1) * t_NumOfPatches, m_Mask.getCols());
+/*
+ * Raise the degree of the patches produced by a_Mask by one in each direction of degree less than 3
+ */
+static Matrix raiseMask(const Matrix& a_Mask, int a_NumOfPatches, int a_DegU, int a_DegV, int a_DegUR, int a_DegVR){
+    bool t_IsRaiseU = a_DegUR > a_DegU;
+    bool t_IsRaiseV = a_DegVR > a_DegV;
+    int t_UR = a_DegUR;
+    int t_VR = a_DegVR;
+
+    Matrix t_BBUR((t_UR+1) * (a_DegV+1) * a_NumOfPatches, a_Mask.getCols());
     if(t_IsRaiseU)
     {
-        for(int patchIdx = 0; patchIdx < t_NumOfPatches; patchIdx++){
+        for(int patchIdx = 0; patchIdx < a_NumOfPatches; patchIdx++){
             for(int i=0; i<=t_UR; i++)
             {
                 int k = t_UR - i;
-                for(int j=0; j<=m_DegV; j++)
+                for(int j=0; j<=a_DegV; j++)
                 {
                     int a = (i-1 < 0) ? 0 : i-1;
-                    int b = (i > m_DegU) ? i-1 : i;
+                    int b = (i > a_DegU) ? i-1 : i;
 
-                    int ajIdx = getCPIndex(m_DegU, m_DegV, patchIdx, a, j);
-                    int bjIdx = getCPIndex(m_DegU, m_DegV, patchIdx, b, j);
-                    int ijIdx = getCPIndex(t_UR, m_DegV, patchIdx, i, j);
-                    for(int colIdx = 0; colIdx < m_Mask.getCols(); colIdx++)
+                    int ajIdx = getCPIndex(a_DegU, a_DegV, patchIdx, a, j);
+                    int bjIdx = getCPIndex(a_DegU, a_DegV, patchIdx, b, j);
+                    int ijIdx = getCPIndex(t_UR, a_DegV, patchIdx, i, j);
+                    for(int colIdx = 0; colIdx < a_Mask.getCols(); colIdx++)
                     {
-                        t_BBUR(ijIdx, colIdx) = (i * m_Mask(ajIdx, colIdx) + k * m_Mask(bjIdx, colIdx)) / t_UR;
+                        t_BBUR(ijIdx, colIdx) = (i * a_Mask(ajIdx, colIdx) + k * a_Mask(bjIdx, colIdx)) / t_UR;
                     }
 
                 }
             }
         }
+        // Only raised in u, the combined pass below would mix the rows again
         if(!t_IsRaiseV)
         {
-            m_Mask = t_BBUR;
+            return t_BBUR;
         }
     }
     if(t_IsRaiseV && !t_IsRaiseU)
     {
-        Matrix t_BBVR((m_DegU+1) * (t_VR+1) * t_NumOfPatches, m_Mask.getCols());
-        for(int patchIdx = 0; patchIdx < t_NumOfPatches; patchIdx++){
+        Matrix t_BBVR((a_DegU+1) * (t_VR+1) * a_NumOfPatches, a_Mask.getCols());
+        for(int patchIdx = 0; patchIdx < a_NumOfPatches; patchIdx++){
             for(int j=0; j<=t_VR; j++)
             {
                 int k = t_VR - j;
-                for(int i=0; i<=m_DegU; i++)
+                for(int i=0; i<=a_DegU; i++)
                 {
                     int a = (j-1 < 0) ? 0 : j-1;
-                    int b = (j > m_DegV) ? j-1 : j;
-                    int iaIdx = getCPIndex(m_DegU, m_DegV, patchIdx, i, a);
-                    int ibIdx = getCPIndex(m_DegU, m_DegV, patchIdx, i, b);
-                    int ijIdx = getCPIndex(m_DegU, t_VR, patchIdx, i, j);
-                    for(int colIdx = 0; colIdx < m_Mask.getCols(); colIdx++)
+                    int b = (j > a_DegV) ? j-1 : j;
+                    int iaIdx = getCPIndex(a_DegU, a_DegV, patchIdx, i, a);
+                    int ibIdx = getCPIndex(a_DegU, a_DegV, patchIdx, i, b);
+                    int ijIdx = getCPIndex(a_DegU, t_VR, patchIdx, i, j);
+                    for(int colIdx = 0; colIdx < a_Mask.getCols(); colIdx++)
                     {
-                        t_BBVR(ijIdx, colIdx) = (j * m_Mask(iaIdx, colIdx) + k * m_Mask(ibIdx, colIdx)) / t_VR;
+                        t_BBVR(ijIdx, colIdx) = (j * a_Mask(iaIdx, colIdx) + k * a_Mask(ibIdx, colIdx)) / t_VR;
                     }
                 }
             }
         }
-        m_Mask = t_BBVR;
+        return t_BBVR;
     }
-    else  // deg raise u & v direction
-    {
-        Matrix t_BBR((t_UR+1) * (t_VR+1) * t_NumOfPatches, m_Mask.getCols());
-        for(int patchIdx = 0; patchIdx < t_NumOfPatches; patchIdx++){
-            for(int j=0; j<=t_VR; j++)
+    // deg raise u & v direction
+    Matrix t_BBR((t_UR+1) * (t_VR+1) * a_NumOfPatches, a_Mask.getCols());
+    for(int patchIdx = 0; patchIdx < a_NumOfPatches; patchIdx++){
+        for(int j=0; j<=t_VR; j++)
+        {
+            int k = t_VR - j;
+            for(int i=0; i<=t_UR; i++)
             {
-                int k = t_VR - j;
-                for(int i=0; i<=t_UR; i++)
-                {
-                    int a = (j-1 < 0) ? 0 : j-1;
-                    int b = (j > m_DegV) ? j-1 : j;
+                int a = (j-1 < 0) ? 0 : j-1;
+                int b = (j > a_DegV) ? j-1 : j;
 
-                    int iaIdx = getCPIndex(t_UR, m_DegV, patchIdx, i, a);
-                    int ibIdx = getCPIndex(t_UR, m_DegV, patchIdx, i, b);
-                    int ijIdx = getCPIndex(t_UR, t_VR, patchIdx, i, j);
-                    for(int colIdx = 0; colIdx < m_Mask.getCols(); colIdx++)
-                    {
-                        t_BBR(ijIdx, colIdx) = (j * t_BBUR(iaIdx, colIdx) + k * t_BBUR(ibIdx, colIdx)) / t_VR;
-                    }
+                int iaIdx = getCPIndex(t_UR, a_DegV, patchIdx, i, a);
+                int ibIdx = getCPIndex(t_UR, a_DegV, patchIdx, i, b);
+                int ijIdx = getCPIndex(t_UR, t_VR, patchIdx, i, j);
+                for(int colIdx = 0; colIdx < a_Mask.getCols(); colIdx++)
+                {
+                    t_BBR(ijIdx, colIdx) = (j * t_BBUR(iaIdx, colIdx) + k * t_BBUR(ibIdx, colIdx)) / t_VR;
                 }
             }
         }
-        m_Mask = t_BBR;
+    }
+    return t_BBR;
+}
+
+/*
+ * Raised versions of shared masks, so that builders sharing a mask also share the raised mask.
+ * Entries refer to the masks weakly and are dropped once the source mask is no longer used.
+ */
+struct RaisedMaskCache
+{
+    std::mutex m_Mutex;
+    std::map<std::tuple<const Matrix*, int, int, int>, std::pair<std::weak_ptr<const Matrix>, std::weak_ptr<const Matrix>>> m_Entries;
+};
+
+static SharedMatrix getRaisedMask(const SharedMatrix& a_Mask, int a_NumOfPatches, int a_DegU, int a_DegV, int a_DegUR, int a_DegVR){
+    static RaisedMaskCache s_Cache;
+    std::lock_guard<std::mutex> t_Lock(s_Cache.m_Mutex);
+    auto t_Key = std::make_tuple(a_Mask.get(), a_NumOfPatches, a_DegU, a_DegV);
+    auto t_It = s_Cache.m_Entries.find(t_Key);
+    if(t_It != s_Cache.m_Entries.end() && t_It->second.first.lock() == a_Mask)
+    {
+        if(auto t_Raised = t_It->second.second.lock())
+        {
+            return t_Raised;
+        }
+    }
+    for(auto t_Entry = s_Cache.m_Entries.begin(); t_Entry != s_Cache.m_Entries.end();)
+    {
+        t_Entry = t_Entry->second.first.expired() ? s_Cache.m_Entries.erase(t_Entry) : std::next(t_Entry);
+    }
+    auto t_Raised = std::make_shared<const Matrix>(raiseMask(*a_Mask, a_NumOfPatches, a_DegU, a_DegV, a_DegUR, a_DegVR));
+    s_Cache.m_Entries[t_Key] = std::make_pair(std::weak_ptr<const Matrix>(a_Mask), std::weak_ptr<const Matrix>(t_Raised));
+    return t_Raised;
+}
+
+void PatchBuilder::degRaise(){
+    bool t_IsRaiseU = m_DegU < 3;
+    bool t_IsRaiseV = m_DegV < 3;
+    if(!t_IsRaiseU && !t_IsRaiseV)
+    {
+        return;
+    }
+    int t_UR = t_IsRaiseU ? m_DegU+1 : m_DegU;
+    int t_VR = t_IsRaiseV ? m_DegV+1 : m_DegV;
+
+    if(m_IsMaskShared)
+    {
+        m_Mask = getRaisedMask(m_Mask, m_NumOfPatches, m_DegU, m_DegV, t_UR, t_VR);
+    }
+    else
+    {
+        m_Mask = std::make_shared<const Matrix>(raiseMask(*m_Mask, m_NumOfPatches, m_DegU, m_DegV, t_UR, t_VR));
     }
     // update member deg
     m_DegU = t_UR;
@@ -145,32 +308,119 @@ int PatchBuilder::numPatches() const{
     return m_NumOfPatches;
 }
 
-void PatchBuilder::initializeMaskAndNeighborVertices(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, const Matrix& a_Mask) {
+/*
+ * Masks rewritten with respect to the original control points, keyed by the mask they were folded from and the signature
+ * of the neighborhood. Repeated irregular configurations of a subdivided mesh fold to the same mask, which is then shared.
+ * Entries refer to the masks weakly and are dropped once neither mask is used.
+ */
+struct FoldedMaskCache
+{
+    std::mutex m_Mutex;
+    std::map<std::pair<const Matrix*, std::vector<uint64_t>>, std::pair<std::weak_ptr<const Matrix>, std::weak_ptr<const Matrix>>> m_Entries;
+    // Expired entries are removed when the cache grows beyond this size
+    size_t m_SweepSize = 1024;
+};
+
+static FoldedMaskCache s_FoldedMaskCache;
+
+void PatchBuilder::initializeMaskAndNeighborVertices(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, SharedMatrix a_Mask) {
     if (!OpenMesh::hasProperty<OpenMesh::VertexHandle, VertexMapping>(a_Mesh, "vertex_mapping")) { 
         m_NBVertexHandles = a_NBVertexHandles;
-        m_Mask = a_Mask;
+        m_Mask = std::move(a_Mask);
+        m_IsMaskShared = true;
         return;
     }
     OpenMesh::VPropHandleT<VertexMapping> vertexMapping;
     a_Mesh.get_property_handle(vertexMapping, "vertex_mapping");
-    // auto vertexMapping = OpenMesh::VProp<VertexMapping>(a_Mesh, "vertex_mapping");
-    std::set<VertexHandle> uniqueHandles;
+
+    // Rank the original vertices by their appearances in the neighborhood: the position of every neighbor whose mapping
+    // contains the vertex, with its weight. This depends only on the local traversal, not on the vertex handles, so equal
+    // neighborhoods anywhere in the mesh rank their vertices alike. Vertices with equal appearances contribute to the mask
+    // in the same way, so their relative order does not matter.
+    std::map<VertexHandle, size_t> slots;
+    std::vector<VertexHandle> originals;
+    std::vector<std::vector<uint64_t>> appearances;
+    for (size_t i = 0; i < a_NBVertexHandles.size(); ++i) {
+        const VertexMapping& vm = a_Mesh.property(vertexMapping, a_NBVertexHandles[i]);
+        for (size_t j = 0; j < vm.indices.size(); ++j) {
+            auto t_It = slots.emplace(vm.indices[j], originals.size()).first;
+            if (t_It->second == originals.size()) {
+                originals.push_back(vm.indices[j]);
+                appearances.emplace_back();
+            }
+            uint64_t weightBits;
+            std::memcpy(&weightBits, &vm.mapping[j], sizeof(weightBits));
+            appearances[t_It->second].push_back(i);
+            appearances[t_It->second].push_back(weightBits);
+        }
+    }
+    std::vector<size_t> order(originals.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+        order[k] = k;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return appearances[a] < appearances[b]; });
+    std::vector<uint64_t> ranks(originals.size());
+    m_NBVertexHandles.resize(originals.size());
+    for (size_t r = 0; r < order.size(); ++r) {
+        ranks[order[r]] = r;
+        m_NBVertexHandles[r] = originals[order[r]];
+    }
+
+    // Record, for every neighbor, the columns and weights it contributes to in column order.
+    // This signature determines the folded mask, independently of where in the mesh the neighborhood is.
+    std::vector<uint64_t> signature;
+    std::vector<std::pair<uint64_t, uint64_t>> entries;
     for (auto vh : a_NBVertexHandles) {
-        for (auto originalVh : a_Mesh.property(vertexMapping, vh).indices) {
-            uniqueHandles.insert(originalVh);
+        const VertexMapping& vm = a_Mesh.property(vertexMapping, vh);
+        entries.clear();
+        for (size_t j = 0; j < vm.indices.size(); ++j) {
+            uint64_t weightBits;
+            std::memcpy(&weightBits, &vm.mapping[j], sizeof(weightBits));
+            entries.emplace_back(ranks[slots[vm.indices[j]]], weightBits);
+        }
+        std::sort(entries.begin(), entries.end());
+        signature.push_back(entries.size());
+        for (const auto& entry : entries) {
+            signature.push_back(entry.first);
+            signature.push_back(entry.second);
         }
     }
-    m_NBVertexHandles.assign(uniqueHandles.begin(), uniqueHandles.end());
-    m_Mask = Matrix(a_Mask.getRows(), m_NBVertexHandles.size());
-    for (int row = 0; row < a_Mask.getRows(); ++row) {
+    m_IsMaskShared = true;
+
+    auto t_Key = std::make_pair(a_Mask.get(), std::move(signature));
+    {
+        std::lock_guard<std::mutex> t_Lock(s_FoldedMaskCache.m_Mutex);
+        auto t_It = s_FoldedMaskCache.m_Entries.find(t_Key);
+        if (t_It != s_FoldedMaskCache.m_Entries.end() && t_It->second.first.lock() == a_Mask) {
+            if (auto t_Folded = t_It->second.second.lock()) {
+                m_Mask = std::move(t_Folded);
+                return;
+            }
+        }
+    }
+
+    // Fold the mask, walking the signature for the columns and weights of each neighbor
+    Matrix t_Mask(a_Mask->getRows(), m_NBVertexHandles.size());
+    for (int row = 0; row < a_Mask->getRows(); ++row) {
+        const uint64_t* entry = t_Key.second.data();
         for (int i = 0; i < a_NBVertexHandles.size(); ++i) {
-            auto vh = a_NBVertexHandles[i];
-            for (int j = 0; j < a_Mesh.property(vertexMapping, vh).indices.size(); ++j) {
-                auto originalVh = a_Mesh.property(vertexMapping, vh).indices[j];
-                int colIdx = std::distance(uniqueHandles.begin(), uniqueHandles.find(originalVh));
-                m_Mask(row, colIdx) += a_Mask(row, i) * a_Mesh.property(vertexMapping, vh).mapping[j];
+            const uint64_t count = *entry++;
+            for (uint64_t j = 0; j < count; ++j, entry += 2) {
+                double weight;
+                std::memcpy(&weight, entry + 1, sizeof(weight));
+                t_Mask(row, entry[0]) += (*a_Mask)(row, i) * weight;
             }
         }
     }
-    
-}
\ No newline at end of file
+    m_Mask = std::make_shared<const Matrix>(std::move(t_Mask));
+
+    std::lock_guard<std::mutex> t_Lock(s_FoldedMaskCache.m_Mutex);
+    auto& t_Entries = s_FoldedMaskCache.m_Entries;
+    if (t_Entries.size() >= s_FoldedMaskCache.m_SweepSize) {
+        for (auto t_Entry = t_Entries.begin(); t_Entry != t_Entries.end();) {
+            t_Entry = (t_Entry->second.first.expired() || t_Entry->second.second.expired()) ? t_Entries.erase(t_Entry) : std::next(t_Entry);
+        }
+        s_FoldedMaskCache.m_SweepSize = std::max<size_t>(1024, 2 * t_Entries.size());
+    }
+    t_Entries[std::move(t_Key)] = std::make_pair(std::weak_ptr<const Matrix>(a_Mask), std::weak_ptr<const Matrix>(m_Mask));
+}
@@ -35,8 +35,12 @@ class PatchBuilder
         /**
          * @brief The mask used to construct the patch.
          * 
+         * Builders gathered on the original mesh share the mask of their \ref PatchConstructor.
+         * Builders gathered after \ref subdivision use a mask rewritten with respect to the original control points.
+         * Neighborhoods with the same mask, vertex mappings and weights share one rewritten mask, whose columns follow
+         * the order in which the original vertices first appear in the vertex mappings.
          */
-        Matrix m_Mask;
+        SharedMatrix m_Mask;
         /**
          * @brief The patch constructor that created this patch builder.
          * 
@@ -64,23 +68,23 @@ class PatchBuilder
          * 
          * @param a_Mesh The mesh to which the vertex handles belong. Used to validate the vertex handles.
          * @param a_NBVertexHandles The neighboring vertex handles used to construct the patch.
-         * @param a_Mask The mask used to construct the patch.
+         * @param a_Mask The mask used to construct the patch. It is shared, not copied, unless it has to be rewritten for a subdivided mesh.
          * @param a_PatchConstructor The patch constructor that created this patch builder.
          * @param a_NumOfPatches The number of bézier patches this PnS patch type outputs.
          */
-        PatchBuilder(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, const Matrix& a_Mask, PatchConstructor* a_PatchConstructor, int a_NumOfPatches);
+        PatchBuilder(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, SharedMatrix a_Mask, PatchConstructor* a_PatchConstructor, int a_NumOfPatches);
         
         /**
          * @brief Constructs a PatchBuilder with the given neighboring vertex handles, mask, patch constructor, and degrees.
          * 
          * @param a_Mesh The mesh to which the vertex handles belong. Used to validate the vertex handles.
          * @param a_NBVertexHandles The neighboring vertex handles used to construct the patch.
-         * @param a_Mask The mask used to construct the patch.
+         * @param a_Mask The mask used to construct the patch. It is shared, not copied, unless it has to be rewritten for a subdivided mesh.
          * @param a_PatchConstructor The patch constructor that created this patch builder.
          * @param a_DegU The degree in u direction of each bézier patch this PnS patch type outputs.
          * @param a_DegV The degree in v direction of each bézier patch this PnS patch type outputs.
          */
-        PatchBuilder(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, const Matrix& a_Mask, PatchConstructor* a_PatchConstructor, int a_DegU, int a_DegV);
+        PatchBuilder(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, SharedMatrix a_Mask, PatchConstructor* a_PatchConstructor, int a_DegU, int a_DegV);
         
         /**
          * @brief Construct a new Patch Builder object
@@ -88,12 +92,22 @@ class PatchBuilder
          * @param a_PatchBuilder 
          */
         PatchBuilder(const PatchBuilder& a_PatchBuilder)
-            : m_NBVertexHandles(a_PatchBuilder.m_NBVertexHandles), m_Mask(a_PatchBuilder.m_Mask), m_PatchConstructor(a_PatchBuilder.m_PatchConstructor), m_NumOfPatches(a_PatchBuilder.m_NumOfPatches), m_DegU(a_PatchBuilder.m_DegU), m_DegV(a_PatchBuilder.m_DegV) {};
+            : m_NBVertexHandles(a_PatchBuilder.m_NBVertexHandles), m_Mask(a_PatchBuilder.m_Mask), m_PatchConstructor(a_PatchBuilder.m_PatchConstructor), m_NumOfPatches(a_PatchBuilder.m_NumOfPatches), m_DegU(a_PatchBuilder.m_DegU), m_DegV(a_PatchBuilder.m_DegV), m_IsMaskShared(a_PatchBuilder.m_IsMaskShared) {};
+        /**
+         * @brief Move constructor
+         * 
+         */
+        PatchBuilder(PatchBuilder&& a_PatchBuilder) = default;
         /**
          * @brief Assignment operator
          * 
          */
         PatchBuilder& operator=(const PatchBuilder& a_PatchBuilder);
+        /**
+         * @brief Move assignment operator
+         * 
+         */
+        PatchBuilder& operator=(PatchBuilder&& a_PatchBuilder) = default;
         /**
          * @brief Builds the Bézier patches using the current vertex positions in the given mesh.
          * 
@@ -102,9 +116,39 @@ class PatchBuilder
          * @note The connectivity of the mesh must not change, only the vertex positions.
          */
         std::vector<Patch> buildPatches(const MeshType& a_Mesh) const;
-        
+
+        /**
+         * @brief Builds the Bézier patches of several patch builders at once.
+         *
+         * Builders created by the same \ref PatchConstructor with an identical mask (e.g. all regular patches, or all
+         * extraordinary patches of one valence) are evaluated together: the neighbor points of a group are gathered into one
+         * K×3B matrix and multiplied with the shared mask in a single product instead of one small product per builder.
+         *
+         * @param a_Mesh The mesh containing the current vertex positions.
+         * @param a_PatchBuilders Pointer to the first of a_NumBuilders consecutive patch builders.
+         * @param a_NumBuilders The number of patch builders.
+         * @return The Bézier patches of all builders, in the same order as calling \ref buildPatches on each builder in turn.
+         */
+        static std::vector<Patch> buildPatchesBatched(const MeshType& a_Mesh, const PatchBuilder* a_PatchBuilders, size_t a_NumBuilders);
+
+        /**
+         * @brief Updates patches built by this builder in place after one of its neighbor vertices moved.
+         *
+         * The mask is linear, so a displacement d of the vertex in column c changes every coefficient row r by mask(r,c) * d.
+         * Only that column of the mask is applied and rows with a zero entry are skipped, instead of rebuilding the patches from all neighbor points.
+         * Repeated updates accumulate floating-point error in the patches; rebuild them with \ref buildPatches from time to time.
+         *
+         * @param a_Column The index into \ref m_NBVertexHandles of the vertex that moved.
+         * @param a_Delta The displacement of the vertex.
+         * @param a_Patches The \ref numPatches patches previously built by this builder, in output order.
+         */
+        void applyDelta(int a_Column, const Point& a_Delta, Patch* const* a_Patches) const;
+
         /**
          * @brief Get the Neighbor Verts object that are used to construct the bezier patches for this PnS patch.
+         * The vertices are in the order of the columns of \ref getMask. For patches of a subdivided mesh these are vertices of
+         * the original mesh, ranked by where they appear in the subdivided neighborhood rather than by first appearance,
+         * so that equal neighborhoods share their mask. Pair them with the mask columns instead of relying on their order.
          * 
          * @return std::vector<VertexHandle> 
          */
@@ -113,9 +157,9 @@ class PatchBuilder
         /**
          * @brief Get the Mask object. The linear transformation that maps the neighboring vertices to the coefficients of the bezier patches.
          * 
-         * @return Matrix 
+         * @return const Matrix& 
          */
-        Matrix getMask() const;
+        const Matrix& getMask() const;
 
         /**
          * @brief Get the PatchConstructor object that created this PatchBuilder.
@@ -126,7 +170,7 @@ class PatchBuilder
 
         /**
          * @brief Raises the degree of the bezier patches by upto degree 3 in each direction. Nothing happens if the degree is already 3 or higher in a direction.
-         * The mask is modified to produce patches with a higher degree
+         * The mask is replaced by one that produces patches with a higher degree. Builders sharing a mask also share the raised mask.
          */
         void degRaise();
 
@@ -137,5 +181,11 @@ class PatchBuilder
          */
         int numPatches() const;
     private:
-        void initializeMaskAndNeighborVertices(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, const Matrix& a_Mask);
+        /**
+         * @brief False if the mask was rewritten for this builder alone.
+         * 
+         */
+        bool m_IsMaskShared = true;
+
+        void initializeMaskAndNeighborVertices(const MeshType& a_Mesh, std::vector<VertexHandle> a_NBVertexHandles, SharedMatrix a_Mask);
 };
\ No newline at end of file
@@ -65,6 +65,8 @@ typedef MeshType::FaceHandle FaceHandle;
 class PatchConstructor
 {
 public:
+    virtual ~PatchConstructor() = default;
+
     /**
      * @brief Given a vertex, checks wither the vertex and the neighborhood arund the vertex of this patch type.
      * 
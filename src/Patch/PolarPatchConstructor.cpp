@@ -50,15 +50,10 @@ bool PolarPatchConstructor::isSamePatchType(const VertexHandle& a_VertexHandle,
     {
         return false;
     }
-    int t_Valence = Helper::get_vert_valence(a_Mesh, a_VertexHandle);
     if(!Helper::is_polar(a_Mesh, a_VertexHandle)){
         return false;
     }
 
-    std::cout << "Polar" << std::endl;
-
-    m_NumOfSct = t_Valence;
-
     return true;
 }
 
@@ -67,27 +62,30 @@ PatchBuilder PolarPatchConstructor::getPatchBuilder(const VertexHandle& a_Vertex
 {
     auto a_NBVertexHandles = initNeighborVerts(a_VertexHandle, a_Mesh);
 
+    // The number of sections is the valence of the polar vertex
+    int t_NumOfSct = Helper::get_vert_valence(a_Mesh, a_VertexHandle);
+
     // Get mask
-    Matrix t_mask;
-    switch (m_NumOfSct)
+    SharedMatrix t_mask;
+    switch (t_NumOfSct)
     {
         case 3:
-            t_mask = m_MaskSct3;
+            t_mask = m_MaskSct3.get();
             break;
         case 4:
-            t_mask = m_MaskSct4;
+            t_mask = m_MaskSct4.get();
             break;
         case 5:
-            t_mask = m_MaskSct5;
+            t_mask = m_MaskSct5.get();
             break;
         case 6:
-            t_mask = m_MaskSct6;
+            t_mask = m_MaskSct6.get();
             break;
         case 7:
-            t_mask = m_MaskSct7;
+            t_mask = m_MaskSct7.get();
             break;
         case 8:
-            t_mask = m_MaskSct8;
+            t_mask = m_MaskSct8.get();
             break;
     }
 
@@ -2,6 +2,7 @@
 
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 #include "PatchConstructor.hpp"
+#include "LazyMask.hpp"
 #include "../Helper/Helper.hpp"
 
 typedef Matrix Mat36x4d;
@@ -19,12 +20,12 @@ class PolarPatchConstructor : public PatchConstructor
 {
 public:
     PolarPatchConstructor()
-        : m_MaskSct3(getMaskSct3()),
-          m_MaskSct4(getMaskSct4()),
-          m_MaskSct5(getMaskSct5()),
-          m_MaskSct6(getMaskSct6()),
-          m_MaskSct7(getMaskSct7()),
-          m_MaskSct8(getMaskSct8()) {};
+        : m_MaskSct3([this]() { return getMaskSct3(); }),
+          m_MaskSct4([this]() { return getMaskSct4(); }),
+          m_MaskSct5([this]() { return getMaskSct5(); }),
+          m_MaskSct6([this]() { return getMaskSct6(); }),
+          m_MaskSct7([this]() { return getMaskSct7(); }),
+          m_MaskSct8([this]() { return getMaskSct8(); }) {};
 
     bool isSamePatchType(const VertexHandle& a_VertexHandle, MeshType& a_Mesh, bool check_marked = false) override;
     PatchBuilder getPatchBuilder(const VertexHandle& a_VertexHandle, MeshType& a_Mesh, bool mark_gathered = false) override;
@@ -33,37 +34,32 @@ private:
     /**
      * @brief The mask for the polar patch with valence = 3.
      */
-    const Mat36x4d m_MaskSct3;
+    const LazyMask m_MaskSct3;
 
     /**
      * @brief The mask for the polar patch with valence = 4.
      */
-    const Mat48x5d m_MaskSct4;
+    const LazyMask m_MaskSct4;
 
     /**
      * @brief The mask for the polar patch with valence = 5.
      */
-    const Mat60x6d m_MaskSct5;
+    const LazyMask m_MaskSct5;
 
     /**
      * @brief The mask for the polar patch with valence = 6.
      */
-    const Mat72x7d m_MaskSct6;
+    const LazyMask m_MaskSct6;
 
     /**
      * @brief The mask for the polar patch with valence = 7.
      */
-    const Mat84x8d m_MaskSct7;
+    const LazyMask m_MaskSct7;
 
     /**
      * @brief The mask for the polar patch with valence = 8.
      */
-    const Mat96x9d m_MaskSct8;
-
-    /**
-     * @brief The number of sections in the polar patch.
-     */
-    int m_NumOfSct = 0;
+    const LazyMask m_MaskSct8;
 
     /**
      * @brief Retrieves the mask for the polar patch with valence = 3.
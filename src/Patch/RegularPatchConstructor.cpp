@@ -48,7 +48,7 @@ bool RegularPatchConstructor::isSamePatchType(const VertexHandle& a_VertHandle,
 PatchBuilder RegularPatchConstructor::getPatchBuilder(const VertexHandle& a_VertHandle, MeshType& a_Mesh, bool mark_gathered)
 {
     auto t_NBVertexHandles = initNeighborVerts(a_VertHandle, a_Mesh);
-    Matrix t_mask = m_Mask;
+    SharedMatrix t_mask = m_Mask;
     const int t_PatchDegU = 2;
     const int t_PatchDegV = 2;
     if(mark_gathered)
@@ -25,7 +25,7 @@ public:
     Matrix getPatchMat(const std::vector<VertexHandle>& a_NBVertexHandles, MeshType& a_Mesh);
 
 private:
-    const Mat9x9d m_Mask = Matrix({
+    const SharedMatrix m_Mask = std::make_shared<const Matrix>(MatNxNd{
         {0.25, 0.25, 0, 0.25, 0.25, 0, 0, 0, 0},
         {0, 0.5, 0, 0, 0.5, 0, 0, 0, 0},
         {0, 0.25, 0.25, 0, 0.25, 0.25, 0, 0, 0},
@@ -59,8 +59,6 @@ bool T0PatchConstructor::isSamePatchType(const FaceHandle& a_FaceHandle, MeshTyp
         return false;
     }
 
-    std::cout << "T0" << std::endl;
-
     return true;
 }
 
@@ -75,7 +73,7 @@ PatchBuilder T0PatchConstructor::getPatchBuilder(const FaceHandle& a_FaceHandle,
     {
         Helper::mark_face_verts(a_Mesh, a_FaceHandle);
     }
-    return PatchBuilder(a_Mesh, t_NBVerts, m_Mask, this, a_NumOfPatch);
+    return PatchBuilder(a_Mesh, t_NBVerts, m_Mask.get(), this, a_NumOfPatch);
 }
 
 
@@ -46,8 +46,6 @@ bool T1PatchConstructor::isSamePatchType(const FaceHandle& a_FaceHandle, MeshTyp
         return false;
     }
 
-    std::cout << "T1" << std::endl;
-
     return true;
 }
 
@@ -87,7 +85,7 @@ PatchBuilder T1PatchConstructor::getPatchBuilder(const FaceHandle& a_FaceHandle,
     {
         Helper::mark_face_verts(a_Mesh, a_FaceHandle);
     }
-    return PatchBuilder(a_Mesh, t_NBVerts, m_Mask, this, a_NumOfPatch);
+    return PatchBuilder(a_Mesh, t_NBVerts, m_Mask.get(), this, a_NumOfPatch);
 }
 
 
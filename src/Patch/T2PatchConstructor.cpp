@@ -81,8 +81,6 @@ bool T2PatchConstructor::isSamePatchType(const FaceHandle& a_FaceHandle, MeshTyp
         return false;
     }
 
-    std::cout << "T2" << std::endl;
-
     return true;
 }
 
@@ -98,7 +96,7 @@ PatchBuilder T2PatchConstructor::getPatchBuilder(const FaceHandle& a_FaceHandle,
     {
         Helper::mark_face_verts(a_Mesh, a_FaceHandle);
     }
-    return PatchBuilder(a_Mesh, t_NBVerts, m_Mask, this, a_NumOfPatch);
+    return PatchBuilder(a_Mesh, t_NBVerts, m_Mask.get(), this, a_NumOfPatch);
 }
 
 
@@ -4,6 +4,7 @@
 
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 #include "PatchConstructor.hpp"
+#include "LazyMask.hpp"
 #include "../Helper/Helper.hpp"
 
 typedef Matrix Mat256x20d;
@@ -16,7 +17,7 @@ class T2PatchConstructor : public PatchConstructor
 {
 public:
     T2PatchConstructor()
-        : m_Mask(getMask()) {};
+        : m_Mask([this]() { return getMask(); }) {};
 
     bool isSamePatchType(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, bool check_marked = false) override;
     PatchBuilder getPatchBuilder(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, bool mark_gathered = false) override;
@@ -25,7 +26,7 @@ private:
     /**
      * @brief The mask for the T2 patch.
      */
-    const Mat256x20d m_Mask;
+    const LazyMask m_Mask;
 
     /**
      * @brief Retrieves the mask for the T2 patch.
@@ -1,9 +1,9 @@
 /* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
 
 #include <assert.h>
-#include <iomanip>
+#include <charconv>
+#include <cstdio>
 #include <thread>
-#include <cmath>
 
 #include "BVWriter.hpp"
 
@@ -13,7 +13,9 @@
  */
 BVWriter::BVWriter(const std::string a_OutFile)
 {
-    m_OutFile.open(a_OutFile);
+    m_OutFile.open(a_OutFile, std::ios::binary);
+    const size_t t_BufferSize = 1 << 20;
+    m_Buffer.reserve(t_BufferSize + 4096);
 }
 
 /*
@@ -22,6 +24,7 @@ BVWriter::BVWriter(const std::string a_OutFile)
  */
 BVWriter::~BVWriter()
 {
+    flushBuffer();
     m_OutFile.close();
 }
 
@@ -44,9 +47,8 @@ void BVWriter::start()
  */
 void BVWriter::stop()
 {
-    /*
-     *  Do nothing
-     */
+    flushBuffer();
+    m_OutFile.flush();
     return;
 }
 
@@ -54,19 +56,50 @@ void BVWriter::stop()
  *  Adds a patch to the queue in a
  *  thread-safe way.
  */
-void BVWriter::consume(const Patch a_Patch)
+void BVWriter::consume(const Patch& a_Patch)
 {
     writePatch(a_Patch);
     return;
 }
 
+/*
+ *  Writes the buffered text to the file.
+ */
+void BVWriter::flushBuffer()
+{
+    if(!m_Buffer.empty())
+    {
+        m_OutFile.write(m_Buffer.data(), m_Buffer.size());
+        m_Buffer.clear();
+    }
+}
+
+/*
+ *  Appends the shortest fixed-point decimal representation that reads back as exactly a_Value, without
+ *  exponent as before. Without std::to_chars, nine significant digits also read back exactly, but very
+ *  small and very large values are written with an exponent.
+ */
+void BVWriter::appendFloat(float a_Value)
+{
+    // Fixed notation of FLT_MAX or of the smallest denormal takes about 50 characters
+    char t_Chars[128];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const std::to_chars_result t_Result = std::to_chars(t_Chars, t_Chars + sizeof(t_Chars), a_Value, std::chars_format::fixed);
+    m_Buffer.append(t_Chars, t_Result.ptr);
+#else
+    const int t_Length = std::snprintf(t_Chars, sizeof(t_Chars), "%.9g", a_Value);
+    m_Buffer.append(t_Chars, t_Length);
+#endif
+}
+
 /*
  *  Writes out a patch into a bv file with the correct format.
+ *  The text is collected in m_Buffer and written once it exceeds 1 MiB.
  *
  *  See https://www.cise.ufl.edu/research/SurfLab/bview/
  *  for information on the file format.
  */
-void BVWriter::writePatch(Patch a_Patch)
+void BVWriter::writePatch(const Patch& a_Patch)
 {
     // Check that the patch has the correct
     // number of control points for its degree
@@ -77,31 +110,39 @@ void BVWriter::writePatch(Patch a_Patch)
     }
 
     // Patch Group
-    m_OutFile << a_Patch.m_Group << std::endl;
+    m_Buffer += a_Patch.getGroup();
+    m_Buffer += '\n';
 
     // Patch Type
-    m_OutFile << a_Patch.m_PatchType << std::endl;
+    m_Buffer += a_Patch.m_PatchType;
+    m_Buffer += '\n';
 
     // Degree in u and v directions
-    const int t_NumOfFloatingDigit = 15;
-    m_OutFile << std::fixed << std::setprecision(t_NumOfFloatingDigit) <<
-        std::to_string(a_Patch.m_DegU) << " " << std::to_string(a_Patch.m_DegV) << std::endl;
+    char t_Chars[16];
+    m_Buffer.append(t_Chars, std::to_chars(t_Chars, t_Chars + sizeof(t_Chars), a_Patch.m_DegU).ptr);
+    m_Buffer += ' ';
+    m_Buffer.append(t_Chars, std::to_chars(t_Chars, t_Chars + sizeof(t_Chars), a_Patch.m_DegV).ptr);
+    m_Buffer += '\n';
 
     // Control points
-    double fd = pow(10,t_NumOfFloatingDigit);
-    std::vector<double> t_BB = {0, 0, 0};
     for(int row=0; row<a_Patch.m_DegU+1; ++row)
     {
         for(int column=0; column<a_Patch.m_DegV+1; ++column)
         {
-            for(int i=0; i<t_BB.size(); i++)
-            {
-                t_BB[i] = round(a_Patch.m_BBcoefs[row][column][i] * fd);
-                t_BB[i] = (long int)(t_BB[i])%2==0 ? t_BB[i]/fd : (t_BB[i]+1)/fd;
-            }
-            m_OutFile << t_BB[0] << " " << t_BB[1] << " " << t_BB[2] << std::endl;
+            appendFloat(a_Patch(row, column, 0));
+            m_Buffer += ' ';
+            appendFloat(a_Patch(row, column, 1));
+            m_Buffer += ' ';
+            appendFloat(a_Patch(row, column, 2));
+            m_Buffer += '\n';
         }
     }
 
+    const size_t t_BufferSize = 1 << 20;
+    if(m_Buffer.size() >= t_BufferSize)
+    {
+        flushBuffer();
+    }
+
     return;
 }
@@ -17,8 +17,12 @@ public:
     ~BVWriter();
     void start();
     void stop();
-    void consume(const Patch a_Patch);
+    void consume(const Patch& a_Patch);
 private:
     std::ofstream m_OutFile;
-    void writePatch(const Patch a_Patch);
+    // Formatted text waiting to be written, flushed to m_OutFile in large chunks
+    std::string m_Buffer;
+    void writePatch(const Patch& a_Patch);
+    void appendFloat(float a_Value);
+    void flushBuffer();
 };
@@ -0,0 +1,123 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+/*
+ *  Layout of the binary BV format written by BinaryBVWriter and read by BinaryBVReader.
+ *  All integers and coefficients are little-endian.
+ *
+ *  offset 0                   BinaryBVHeader
+ *  m_CoefOffset               coefficients of all patches, float32 or float64 depending on m_ScalarSize,
+ *                             patch by patch in the order of Patch::m_Coefs
+ *  m_PatchTableOffset         m_NumPatches x BinaryBVPatchRecord
+ *  m_GroupTableOffset         m_NumGroups x BinaryBVGroupRecord
+ *  m_GroupNamesOffset         the group names, not null terminated
+ *
+ *  Every section starts at a multiple of 8 bytes, so a file mapped into memory
+ *  can be read in place through the structs below.
+ */
+
+/*
+ *  "PNSB"
+ */
+static const char BINARY_BV_MAGIC[4] = {'P', 'N', 'S', 'B'};
+static const uint32_t BINARY_BV_VERSION = 1;
+
+struct BinaryBVHeader
+{
+    char m_Magic[4];
+    uint32_t m_Version;
+    // 4 for float32 coefficients, 8 for float64
+    uint32_t m_ScalarSize;
+    uint32_t m_NumGroups;
+    uint64_t m_NumPatches;
+    // Total number of scalars, 3 per control point
+    uint64_t m_NumCoefs;
+    uint64_t m_CoefOffset;
+    uint64_t m_PatchTableOffset;
+    uint64_t m_GroupTableOffset;
+    uint64_t m_GroupNamesOffset;
+};
+static_assert(sizeof(BinaryBVHeader) == 64, "BinaryBVHeader must be packed");
+
+struct BinaryBVPatchRecord
+{
+    uint32_t m_DegU;
+    uint32_t m_DegV;
+    // Index into the group table
+    uint32_t m_Group;
+    uint32_t m_Reserved;
+    // Index of the first scalar of the patch in the coefficients
+    uint64_t m_CoefIndex;
+};
+static_assert(sizeof(BinaryBVPatchRecord) == 24, "BinaryBVPatchRecord must be packed");
+
+struct BinaryBVGroupRecord
+{
+    // Byte offset of the name relative to m_GroupNamesOffset
+    uint32_t m_NameOffset;
+    uint32_t m_NameLength;
+};
+static_assert(sizeof(BinaryBVGroupRecord) == 8, "BinaryBVGroupRecord must be packed");
+
+/*
+ *  True if the host stores integers and floats little-endian,
+ *  in which case the file can be used without conversion.
+ */
+inline bool binary_bv_host_is_little_endian()
+{
+    const uint16_t t_One = 1;
+    unsigned char t_FirstByte;
+    std::memcpy(&t_FirstByte, &t_One, 1);
+    return t_FirstByte == 1;
+}
+
+/*
+ *  Reverse the byte order of a_Count values of a_Size bytes each, in place.
+ */
+inline void binary_bv_swap_bytes(void* a_Data, size_t a_Size, size_t a_Count)
+{
+    unsigned char* t_Bytes = static_cast<unsigned char*>(a_Data);
+    for(size_t i = 0; i < a_Count; ++i, t_Bytes += a_Size)
+    {
+        for(size_t b = 0; b < a_Size / 2; ++b)
+        {
+            const unsigned char t_Byte = t_Bytes[b];
+            t_Bytes[b] = t_Bytes[a_Size - 1 - b];
+            t_Bytes[a_Size - 1 - b] = t_Byte;
+        }
+    }
+}
+
+/*
+ *  Convert the fields of a record between host and little-endian byte order.
+ *  Does nothing on little-endian hosts, and converts in either direction otherwise.
+ */
+inline void binary_bv_byte_order(BinaryBVHeader& a_Header)
+{
+    if(!binary_bv_host_is_little_endian())
+    {
+        binary_bv_swap_bytes(&a_Header.m_Version, 4, 3);
+        binary_bv_swap_bytes(&a_Header.m_NumPatches, 8, 6);
+    }
+}
+
+inline void binary_bv_byte_order(BinaryBVPatchRecord& a_Record)
+{
+    if(!binary_bv_host_is_little_endian())
+    {
+        binary_bv_swap_bytes(&a_Record.m_DegU, 4, 4);
+        binary_bv_swap_bytes(&a_Record.m_CoefIndex, 8, 1);
+    }
+}
+
+inline void binary_bv_byte_order(BinaryBVGroupRecord& a_Record)
+{
+    if(!binary_bv_host_is_little_endian())
+    {
+        binary_bv_swap_bytes(&a_Record, 4, 2);
+    }
+}
@@ -0,0 +1,233 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BINARY_BV_USE_MMAP
+#endif
+
+#include "BinaryBVReader.hpp"
+
+BinaryBVReader::BinaryBVReader(const std::string& a_File)
+{
+#ifdef BINARY_BV_USE_MMAP
+    const int t_Fd = ::open(a_File.c_str(), O_RDONLY);
+    if(t_Fd < 0)
+    {
+        throw std::runtime_error("Could not open " + a_File);
+    }
+    struct stat t_Stat;
+    if(::fstat(t_Fd, &t_Stat) != 0 || t_Stat.st_size == 0)
+    {
+        ::close(t_Fd);
+        throw std::runtime_error("Could not read " + a_File);
+    }
+    m_Size = t_Stat.st_size;
+    void* t_Mapping = ::mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, t_Fd, 0);
+    ::close(t_Fd);
+    if(t_Mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Could not map " + a_File);
+    }
+    m_Mapping = t_Mapping;
+    m_Data = static_cast<const char*>(t_Mapping);
+#else
+    std::ifstream t_File(a_File, std::ios::binary | std::ios::ate);
+    if(!t_File)
+    {
+        throw std::runtime_error("Could not open " + a_File);
+    }
+    m_Size = t_File.tellg();
+    m_Content.resize((m_Size + 7) / 8);
+    t_File.seekg(0);
+    if(!t_File.read(reinterpret_cast<char*>(m_Content.data()), m_Size))
+    {
+        throw std::runtime_error("Could not read " + a_File);
+    }
+    m_Data = reinterpret_cast<const char*>(m_Content.data());
+#endif
+    try
+    {
+        validate();
+    }
+    catch(...)
+    {
+#ifdef BINARY_BV_USE_MMAP
+        ::munmap(m_Mapping, m_Size);
+#endif
+        throw;
+    }
+}
+
+BinaryBVReader::BinaryBVReader(const void* a_Data, size_t a_Size) : m_Data(static_cast<const char*>(a_Data)), m_Size(a_Size)
+{
+    validate();
+}
+
+BinaryBVReader::~BinaryBVReader()
+{
+#ifdef BINARY_BV_USE_MMAP
+    if(m_Mapping != nullptr)
+    {
+        ::munmap(m_Mapping, m_Size);
+    }
+#endif
+}
+
+/*
+ *  Checks that the header is a binary BV header and that
+ *  every section and every patch lies inside the data.
+ */
+void BinaryBVReader::validate()
+{
+    if(m_Size < sizeof(BinaryBVHeader))
+    {
+        throw std::runtime_error("Binary BV file is too short");
+    }
+    std::memcpy(&m_Header, m_Data, sizeof(m_Header));
+    binary_bv_byte_order(m_Header);
+    if(std::memcmp(m_Header.m_Magic, BINARY_BV_MAGIC, sizeof(m_Header.m_Magic)) != 0)
+    {
+        throw std::runtime_error("Not a binary BV file");
+    }
+    if(m_Header.m_Version != BINARY_BV_VERSION)
+    {
+        throw std::runtime_error("Unsupported binary BV version " + std::to_string(m_Header.m_Version));
+    }
+    if(m_Header.m_ScalarSize != sizeof(float) && m_Header.m_ScalarSize != sizeof(double))
+    {
+        throw std::runtime_error("Invalid binary BV scalar size " + std::to_string(m_Header.m_ScalarSize));
+    }
+
+    // Each section must lie inside the file; the divisions avoid overflow on corrupt counts
+    auto t_Inside = [&](uint64_t a_Offset, uint64_t a_Count, uint64_t a_ElementSize)
+    {
+        return a_Offset <= m_Size && a_Count <= (m_Size - a_Offset) / a_ElementSize;
+    };
+    if(!t_Inside(m_Header.m_CoefOffset, m_Header.m_NumCoefs, m_Header.m_ScalarSize) ||
+       !t_Inside(m_Header.m_PatchTableOffset, m_Header.m_NumPatches, sizeof(BinaryBVPatchRecord)) ||
+       !t_Inside(m_Header.m_GroupTableOffset, m_Header.m_NumGroups, sizeof(BinaryBVGroupRecord)) ||
+       m_Header.m_GroupNamesOffset > m_Size ||
+       m_Header.m_CoefOffset % 8 != 0)
+    {
+        throw std::runtime_error("Binary BV file is truncated or corrupt");
+    }
+
+    for(size_t p = 0; p < m_Header.m_NumPatches; ++p)
+    {
+        const BinaryBVPatchRecord t_Record = getRecord(p);
+        const uint64_t t_NumCoefs = (static_cast<uint64_t>(t_Record.m_DegU) + 1) * (static_cast<uint64_t>(t_Record.m_DegV) + 1) * 3;
+        if(t_Record.m_DegU > 0xffff || t_Record.m_DegV > 0xffff || t_Record.m_Group >= m_Header.m_NumGroups ||
+           t_Record.m_CoefIndex > m_Header.m_NumCoefs || t_NumCoefs > m_Header.m_NumCoefs - t_Record.m_CoefIndex)
+        {
+            throw std::runtime_error("Binary BV patch " + std::to_string(p) + " is corrupt");
+        }
+    }
+
+    m_GroupIds.resize(m_Header.m_NumGroups);
+    for(size_t g = 0; g < m_Header.m_NumGroups; ++g)
+    {
+        const BinaryBVGroupRecord t_Record = getGroupRecord(g);
+        if(!t_Inside(m_Header.m_GroupNamesOffset + t_Record.m_NameOffset, t_Record.m_NameLength, 1))
+        {
+            throw std::runtime_error("Binary BV group " + std::to_string(g) + " is corrupt");
+        }
+        m_GroupIds[g] = Patch::internGroup(getGroupName(g));
+    }
+}
+
+BinaryBVPatchRecord BinaryBVReader::getRecord(size_t a_Index) const
+{
+    BinaryBVPatchRecord t_Record;
+    std::memcpy(&t_Record, m_Data + m_Header.m_PatchTableOffset + a_Index * sizeof(BinaryBVPatchRecord), sizeof(t_Record));
+    binary_bv_byte_order(t_Record);
+    return t_Record;
+}
+
+BinaryBVGroupRecord BinaryBVReader::getGroupRecord(size_t a_Group) const
+{
+    BinaryBVGroupRecord t_Record;
+    std::memcpy(&t_Record, m_Data + m_Header.m_GroupTableOffset + a_Group * sizeof(BinaryBVGroupRecord), sizeof(t_Record));
+    binary_bv_byte_order(t_Record);
+    return t_Record;
+}
+
+std::string BinaryBVReader::getGroupName(size_t a_Group) const
+{
+    if(a_Group >= m_Header.m_NumGroups)
+    {
+        throw std::out_of_range("Binary BV group index out of range");
+    }
+    const BinaryBVGroupRecord t_Record = getGroupRecord(a_Group);
+    return std::string(m_Data + m_Header.m_GroupNamesOffset + t_Record.m_NameOffset, t_Record.m_NameLength);
+}
+
+BinaryBVPatchView BinaryBVReader::getPatchView(size_t a_Index) const
+{
+    if(a_Index >= m_Header.m_NumPatches)
+    {
+        throw std::out_of_range("Binary BV patch index out of range");
+    }
+    if(!binary_bv_host_is_little_endian())
+    {
+        throw std::runtime_error("Binary BV patch views need a little-endian host, use getPatch instead");
+    }
+    const BinaryBVPatchRecord t_Record = getRecord(a_Index);
+    BinaryBVPatchView t_View;
+    t_View.m_DegU = t_Record.m_DegU;
+    t_View.m_DegV = t_Record.m_DegV;
+    t_View.m_Group = t_Record.m_Group;
+    t_View.m_Coefs = m_Data + m_Header.m_CoefOffset + t_Record.m_CoefIndex * m_Header.m_ScalarSize;
+    t_View.m_ScalarSize = m_Header.m_ScalarSize;
+    return t_View;
+}
+
+Patch BinaryBVReader::getPatch(size_t a_Index) const
+{
+    if(a_Index >= m_Header.m_NumPatches)
+    {
+        throw std::out_of_range("Binary BV patch index out of range");
+    }
+    const BinaryBVPatchRecord t_Record = getRecord(a_Index);
+    Patch t_Patch(t_Record.m_DegU, t_Record.m_DegV, m_GroupIds[t_Record.m_Group]);
+    const char* t_Coefs = m_Data + m_Header.m_CoefOffset + t_Record.m_CoefIndex * m_Header.m_ScalarSize;
+    const size_t t_NumCoefs = t_Patch.m_Coefs.size();
+    if(m_Header.m_ScalarSize == sizeof(float))
+    {
+        std::memcpy(t_Patch.m_Coefs.data(), t_Coefs, t_NumCoefs * sizeof(float));
+        if(!binary_bv_host_is_little_endian())
+        {
+            binary_bv_swap_bytes(t_Patch.m_Coefs.data(), sizeof(float), t_NumCoefs);
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < t_NumCoefs; ++i)
+        {
+            double t_Value;
+            std::memcpy(&t_Value, t_Coefs + i * sizeof(double), sizeof(double));
+            if(!binary_bv_host_is_little_endian())
+            {
+                binary_bv_swap_bytes(&t_Value, sizeof(double), 1);
+            }
+            t_Patch.m_Coefs[i] = static_cast<float>(t_Value);
+        }
+    }
+    return t_Patch;
+}
+
+std::vector<Patch> BinaryBVReader::getPatches() const
+{
+    std::vector<Patch> t_Patches;
+    t_Patches.reserve(m_Header.m_NumPatches);
+    for(size_t p = 0; p < m_Header.m_NumPatches; ++p)
+    {
+        t_Patches.push_back(getPatch(p));
+    }
+    return t_Patches;
+}
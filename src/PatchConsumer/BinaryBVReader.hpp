@@ -0,0 +1,108 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "BinaryBV.hpp"
+#include "../Patch/Patch.hpp"
+
+/**
+ * @brief A patch inside a binary BV file, pointing at the coefficients in the file without copying them.
+ */
+struct BinaryBVPatchView
+{
+    int m_DegU;
+    int m_DegV;
+    /**
+     * @brief Index of the group of the patch, see \ref BinaryBVReader::getGroupName.
+     */
+    uint32_t m_Group;
+    /**
+     * @brief (m_DegU+1) * (m_DegV+1) * 3 scalars in the order of Patch::m_Coefs, float if m_ScalarSize is 4, double if 8.
+     */
+    const void* m_Coefs;
+    uint32_t m_ScalarSize;
+
+    /**
+     * @brief Coordinate a_K of the control point (a_I, a_J).
+     */
+    double operator()(int a_I, int a_J, int a_K) const
+    {
+        const size_t t_Index = (static_cast<size_t>(a_I) * (m_DegV + 1) + a_J) * 3 + a_K;
+        return m_ScalarSize == sizeof(double) ? static_cast<const double*>(m_Coefs)[t_Index]
+                                              : static_cast<const float*>(m_Coefs)[t_Index];
+    }
+};
+
+/**
+ * @brief Reads binary BV files written by \ref BinaryBVWriter.
+ *
+ * A file is mapped into memory where the platform supports it and read into memory otherwise.
+ * The patches can then be accessed in place through \ref getPatchView or copied into \ref Patch "Patches".
+ * The structure of the file is validated on construction, so the accessors do no further checks besides the index.
+ */
+class BinaryBVReader
+{
+public:
+    /**
+     * @brief Open a binary BV file.
+     *
+     * @param a_File Path of the file.
+     * @throws std::runtime_error if the file cannot be read or is not a valid binary BV file.
+     */
+    explicit BinaryBVReader(const std::string& a_File);
+
+    /**
+     * @brief Read a binary BV file that is already in memory. The memory is not copied and must outlive the reader.
+     *
+     * @param a_Data The content of the file, aligned to 8 bytes.
+     * @param a_Size The size of the file in bytes.
+     * @throws std::runtime_error if the data is not a valid binary BV file.
+     */
+    BinaryBVReader(const void* a_Data, size_t a_Size);
+
+    ~BinaryBVReader();
+    BinaryBVReader(const BinaryBVReader&) = delete;
+    BinaryBVReader& operator=(const BinaryBVReader&) = delete;
+
+    size_t getNumPatches() const { return m_Header.m_NumPatches; }
+    size_t getNumGroups() const { return m_Header.m_NumGroups; }
+    /**
+     * @brief 4 if the coefficients are stored as float32, 8 if as float64.
+     */
+    uint32_t getScalarSize() const { return m_Header.m_ScalarSize; }
+    std::string getGroupName(size_t a_Group) const;
+
+    /**
+     * @brief View of a patch without copying its coefficients.
+     *
+     * @throws std::runtime_error on big-endian hosts, where the coefficients cannot be used in place.
+     */
+    BinaryBVPatchView getPatchView(size_t a_Index) const;
+
+    /**
+     * @brief Copy a patch, including its group, into a \ref Patch.
+     */
+    Patch getPatch(size_t a_Index) const;
+
+    /**
+     * @brief Copy all patches.
+     */
+    std::vector<Patch> getPatches() const;
+
+private:
+    const char* m_Data = nullptr;
+    size_t m_Size = 0;
+    // Memory mapping of the file, or the file content where mapping is not available
+    void* m_Mapping = nullptr;
+    std::vector<uint64_t> m_Content;
+    BinaryBVHeader m_Header;
+    // Group ids of Patch for the groups of the file
+    std::vector<uint32_t> m_GroupIds;
+
+    void validate();
+    BinaryBVPatchRecord getRecord(size_t a_Index) const;
+    BinaryBVGroupRecord getGroupRecord(size_t a_Group) const;
+};
@@ -0,0 +1,184 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#include <iostream>
+
+#include "BinaryBVWriter.hpp"
+
+/*
+ *  Constructor.
+ *  Opens the file and reserves room for the header.
+ */
+BinaryBVWriter::BinaryBVWriter(const std::string a_OutFile, bool a_IsDouble) : m_IsDouble(a_IsDouble)
+{
+    m_OutFile.open(a_OutFile, std::ios::binary | std::ios::trunc);
+    const BinaryBVHeader t_Header = {};
+    m_OutFile.write(reinterpret_cast<const char*>(&t_Header), sizeof(t_Header));
+    m_CoefEnd = sizeof(BinaryBVHeader);
+    const size_t t_BufferSize = 1 << 20;
+    m_Buffer.reserve(t_BufferSize + 4096);
+    m_IsDirty = true;
+}
+
+/*
+ *  Destructor.
+ *  Writes the tables if patches were added since the last stop.
+ */
+BinaryBVWriter::~BinaryBVWriter()
+{
+    if(m_IsDirty)
+    {
+        writeTables();
+    }
+    m_OutFile.close();
+}
+
+void BinaryBVWriter::start()
+{
+    /*
+     *  Do nothing
+     */
+    return;
+}
+
+/*
+ *  Completes the file: writes the tables
+ *  behind the coefficients and the header.
+ */
+void BinaryBVWriter::stop()
+{
+    writeTables();
+    return;
+}
+
+/*
+ *  Appends the coefficients of a patch and
+ *  records its degrees, group and offset.
+ */
+void BinaryBVWriter::consume(const Patch& a_Patch)
+{
+    if(!a_Patch.isValid())
+    {
+        std::cout << "Patch is not valid,  write is aborting!\n";
+        return;
+    }
+
+    auto t_Group = m_GroupIndices.emplace(a_Patch.m_GroupId, static_cast<uint32_t>(m_Groups.size()));
+    if(t_Group.second)
+    {
+        m_Groups.push_back(a_Patch.m_GroupId);
+    }
+
+    BinaryBVPatchRecord t_Record = {};
+    t_Record.m_DegU = a_Patch.m_DegU;
+    t_Record.m_DegV = a_Patch.m_DegV;
+    t_Record.m_Group = t_Group.first->second;
+    t_Record.m_CoefIndex = m_NumCoefs;
+    m_Patches.push_back(t_Record);
+
+    const size_t t_NumCoefs = a_Patch.m_Coefs.size();
+    const size_t t_ScalarSize = m_IsDouble ? sizeof(double) : sizeof(float);
+    const size_t t_Begin = m_Buffer.size();
+    m_Buffer.resize(t_Begin + t_NumCoefs * t_ScalarSize);
+    char* t_Out = m_Buffer.data() + t_Begin;
+    if(m_IsDouble)
+    {
+        for(size_t i = 0; i < t_NumCoefs; ++i)
+        {
+            const double t_Value = a_Patch.m_Coefs[i];
+            std::memcpy(t_Out + i * sizeof(double), &t_Value, sizeof(double));
+        }
+    }
+    else
+    {
+        std::memcpy(t_Out, a_Patch.m_Coefs.data(), t_NumCoefs * sizeof(float));
+    }
+    if(!binary_bv_host_is_little_endian())
+    {
+        binary_bv_swap_bytes(t_Out, t_ScalarSize, t_NumCoefs);
+    }
+    m_NumCoefs += t_NumCoefs;
+    m_IsDirty = true;
+
+    const size_t t_BufferSize = 1 << 20;
+    if(m_Buffer.size() >= t_BufferSize)
+    {
+        flushBuffer();
+    }
+    return;
+}
+
+/*
+ *  Writes the buffered coefficients at the end of the coefficient section.
+ */
+void BinaryBVWriter::flushBuffer()
+{
+    if(!m_Buffer.empty())
+    {
+        m_OutFile.seekp(m_CoefEnd);
+        m_OutFile.write(m_Buffer.data(), m_Buffer.size());
+        m_CoefEnd += m_Buffer.size();
+        m_Buffer.clear();
+    }
+}
+
+/*
+ *  Writes the patch table, the group table and the group names
+ *  behind the coefficients, each aligned to 8 bytes, then the header.
+ */
+void BinaryBVWriter::writeTables()
+{
+    flushBuffer();
+
+    const char t_Padding[8] = {};
+    uint64_t t_Position = m_CoefEnd;
+    auto t_Align = [&]()
+    {
+        const uint64_t t_Aligned = (t_Position + 7) / 8 * 8;
+        m_OutFile.write(t_Padding, t_Aligned - t_Position);
+        t_Position = t_Aligned;
+    };
+    m_OutFile.seekp(t_Position);
+
+    t_Align();
+    const uint64_t t_PatchTableOffset = t_Position;
+    for(BinaryBVPatchRecord t_Record : m_Patches)
+    {
+        binary_bv_byte_order(t_Record);
+        m_OutFile.write(reinterpret_cast<const char*>(&t_Record), sizeof(t_Record));
+    }
+    t_Position += m_Patches.size() * sizeof(BinaryBVPatchRecord);
+
+    const uint64_t t_GroupTableOffset = t_Position;
+    std::string t_Names;
+    for(uint32_t t_GroupId : m_Groups)
+    {
+        const std::string& t_Name = Patch::groupName(t_GroupId);
+        BinaryBVGroupRecord t_Record = {static_cast<uint32_t>(t_Names.size()), static_cast<uint32_t>(t_Name.size())};
+        binary_bv_byte_order(t_Record);
+        m_OutFile.write(reinterpret_cast<const char*>(&t_Record), sizeof(t_Record));
+        t_Names += t_Name;
+    }
+    t_Position += m_Groups.size() * sizeof(BinaryBVGroupRecord);
+
+    const uint64_t t_GroupNamesOffset = t_Position;
+    m_OutFile.write(t_Names.data(), t_Names.size());
+    t_Position += t_Names.size();
+    t_Align();
+
+    BinaryBVHeader t_Header = {};
+    std::memcpy(t_Header.m_Magic, BINARY_BV_MAGIC, sizeof(t_Header.m_Magic));
+    t_Header.m_Version = BINARY_BV_VERSION;
+    t_Header.m_ScalarSize = m_IsDouble ? sizeof(double) : sizeof(float);
+    t_Header.m_NumGroups = m_Groups.size();
+    t_Header.m_NumPatches = m_Patches.size();
+    t_Header.m_NumCoefs = m_NumCoefs;
+    t_Header.m_CoefOffset = sizeof(BinaryBVHeader);
+    t_Header.m_PatchTableOffset = t_PatchTableOffset;
+    t_Header.m_GroupTableOffset = t_GroupTableOffset;
+    t_Header.m_GroupNamesOffset = t_GroupNamesOffset;
+    binary_bv_byte_order(t_Header);
+    m_OutFile.seekp(0);
+    m_OutFile.write(reinterpret_cast<const char*>(&t_Header), sizeof(t_Header));
+    m_OutFile.flush();
+    m_IsDirty = false;
+}
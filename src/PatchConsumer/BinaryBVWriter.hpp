@@ -0,0 +1,50 @@
+/* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
+
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+#include "PatchConsumer.hpp"
+#include "BinaryBV.hpp"
+#include "../Patch/Patch.hpp"
+
+/**
+ * @brief Writes patches into a binary BV file that can be memory mapped, see BinaryBV.hpp for the layout and \ref BinaryBVReader.
+ *
+ * The coefficients are streamed to the file as the patches arrive. The patch and group tables are kept in memory
+ * and written behind the coefficients by \ref stop, which also fills in the header. Patches consumed after \ref stop
+ * are appended and the tables are rewritten by the next \ref stop or by the destructor.
+ */
+class BinaryBVWriter : public PatchConsumer
+{
+public:
+    /**
+     * @brief Construct a BinaryBVWriter.
+     *
+     * @param a_OutFile The file to write.
+     * @param a_IsDouble Store the coefficients as float64 instead of float32.
+     */
+    BinaryBVWriter(const std::string a_OutFile, bool a_IsDouble = false);
+    ~BinaryBVWriter();
+    void start();
+    void stop();
+    void consume(const Patch& a_Patch);
+private:
+    std::ofstream m_OutFile;
+    bool m_IsDouble;
+    // Coefficients waiting to be written, flushed to m_OutFile in large chunks
+    std::vector<char> m_Buffer;
+    // File position behind the last coefficient
+    uint64_t m_CoefEnd;
+    uint64_t m_NumCoefs = 0;
+    bool m_IsDirty = false;
+    std::vector<BinaryBVPatchRecord> m_Patches;
+    // Group id of Patch to index into the group table, and the group ids in table order
+    std::unordered_map<uint32_t, uint32_t> m_GroupIndices;
+    std::vector<uint32_t> m_Groups;
+    void flushBuffer();
+    void writeTables();
+};
@@ -9,20 +9,46 @@
 
 #include "PatchConsumer.hpp"
 #include "../Patch/Patch.hpp"
+#include "../Helper/Tessellator.hpp"
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
 
+/**
+ * @brief Tessellates the consumed patches into one triangle mesh.
+ *
+ * The triangles are collected in flat buffers. Written to a \ref TessellatedMesh they are used as they are,
+ * written to a MeshType the mesh is built from them in one pass by \ref Helper::build_mesh when the writer stops.
+ */
 class EvaluatedMeshWriter : public PatchConsumer
 {
 public:
-    EvaluatedMeshWriter(MeshType *mesh);
+    /**
+     * @brief Construct an EvaluatedMeshWriter.
+     *
+     * @param mesh The mesh the tessellated patches are written to when the writer stops, with vertex normals and texture coordinates.
+     * Its previous content is replaced.
+     * @param a_Tolerance 0 tessellates every patch uniformly with 16 x 16 vertices. A positive value tessellates adaptively so that
+     * the triangles are within a_Tolerance of the patches, see \ref Tessellator::tessellateAdaptive.
+     */
+    EvaluatedMeshWriter(MeshType *mesh, float a_Tolerance = 0);
+
+    /**
+     * @brief Construct an EvaluatedMeshWriter that writes to flat buffers, without building a MeshType.
+     *
+     * @param a_Sink The buffers the tessellated patches are appended to, cleared when the writer starts.
+     * @param a_Tolerance See above.
+     */
+    EvaluatedMeshWriter(TessellatedMesh *a_Sink, float a_Tolerance = 0);
     void start();
     void stop();
-    void consume(const Patch a_Patch);
+    void consume(const Patch& a_Patch);
 
 private:
-    MeshType* mesh;
-    MeshType::Point de_casteljau_surface(float u, float v, const Patch a_Patch);
-    MeshType::Point de_casteljau_normal(float u, float v, const Patch& a_Patch);
-    void create_bezier_surface_mesh(const Patch a_Patch, int n, MeshType *mesh);
+    MeshType* mesh = nullptr;
+    Tessellator m_Tessellator;
+    float m_Tolerance;
+    // The buffers the patches are tessellated into, m_Tessellated unless the caller gave a sink
+    TessellatedMesh m_Tessellated;
+    TessellatedMesh* m_Sink;
+    void build_mesh(const TessellatedMesh& a_Tessellated, MeshType *mesh);
 };
@@ -1,15 +1,59 @@
 /* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
 
+#include <algorithm>
+#include <assert.h>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+
 #include "IGSWriter.hpp"
+#include "../Helper/Parallel.hpp"
 
-IGSWriter::IGSWriter(const std::string a_OutFile)
+IGSWriter::IGSWriter(const std::string a_OutFile, int a_NumThreads) : m_FileName(a_OutFile), m_NumThreads(a_NumThreads)
 {
     m_OutFile = fopen(a_OutFile.c_str(),"w");
 }
 
+/* append one formatted line to a_Out */
+template <typename... Args>
+static void append_line(std::string& a_Out, const char* a_Format, Args... a_Args)
+{
+    char t_Line[128];
+    const int t_Length = snprintf(t_Line, sizeof(t_Line), a_Format, a_Args...);
+    a_Out.append(t_Line, std::min<size_t>(t_Length, sizeof(t_Line) - 1));
+}
+
+/*
+ *  Formats a_Format(i, text) for every i in [0, a_Count) in parallel,
+ *  a block of items at a time, and writes each block with a single fwrite.
+ */
+template <typename Format>
+static void write_in_blocks(FILE* a_File, size_t a_Count, int a_NumThreads, Format&& a_Format)
+{
+    const size_t t_BlockSize = 4096;
+    std::vector<std::string> t_Texts(std::min(a_Count, t_BlockSize));
+    std::string t_Block;
+    for(size_t t_Begin = 0; t_Begin < a_Count; t_Begin += t_BlockSize)
+    {
+        const size_t t_End = std::min(a_Count, t_Begin + t_BlockSize);
+        Helper::parallel_for(t_Begin, t_End, a_NumThreads, [&](size_t i)
+        {
+            std::string& t_Text = t_Texts[i - t_Begin];
+            t_Text.clear();
+            a_Format(i, t_Text);
+        }, 64);
+
+        t_Block.clear();
+        for(size_t i = t_Begin; i < t_End; ++i)
+        {
+            t_Block += t_Texts[i - t_Begin];
+        }
+        fwrite(t_Block.data(), 1, t_Block.size(), a_File);
+    }
+}
 
 /* write knots of bb-form in IGES */
-int IGSWriter::knots(int a_Deg1, int a_Bbase, int a_Ffctr, FILE* fp, int a_PerLine)
+int IGSWriter::knots(int a_Deg1, int a_Bbase, int a_Ffctr, std::string& a_Out, int a_PerLine)
 {
     int	i,j;
 
@@ -17,19 +61,19 @@ int IGSWriter::knots(int a_Deg1, int a_Bbase, int a_Ffctr, FILE* fp, int a_PerLi
     {
     	if ((i%a_PerLine==0) && (i != 0))
         {
-    	    fprintf(fp,"%8dP%7d\n", a_Ffctr, a_Bbase);
+    	    append_line(a_Out, "%8dP%7d\n", a_Ffctr, a_Bbase);
     	    a_Bbase++;
     	}
-    	fprintf(fp,"0.00000,");
+    	a_Out += "0.00000,";
     }
     for (; i< 2*a_Deg1; i++)
     {
     	if (i%a_PerLine==0)
         {
-    	    fprintf(fp, "%8dP%7d\n", a_Ffctr, a_Bbase);
+    	    append_line(a_Out, "%8dP%7d\n", a_Ffctr, a_Bbase);
     	    a_Bbase++;
 	    }
-	    fprintf(fp,"1.00000,");
+	    a_Out += "1.00000,";
     }
     j = (2*a_Deg1) % a_PerLine;
     if (j != 0)
@@ -37,90 +81,143 @@ int IGSWriter::knots(int a_Deg1, int a_Bbase, int a_Ffctr, FILE* fp, int a_PerLi
 	    j = a_PerLine - j;
 	    for (i=0; i < j; i++)
         {
-		  fprintf(fp,"        ");
+		  a_Out += "        ";
 	    }
     }
 
-    fprintf(fp, "%8dP%7d\n", a_Ffctr,a_Bbase);
+    append_line(a_Out, "%8dP%7d\n", a_Ffctr, a_Bbase);
 
     a_Bbase++;
 
     return(a_Bbase);
 }
 
+/*
+ *  Number of parameter data lines of a patch:
+ *  header, the knots in v and u, weights, one line per control point, parameter range.
+ *  Knots and weights are typeset 8 per line.
+ */
+int IGSWriter::numParameterLines(const Patch& a_Patch)
+{
+    const int t_KnotLinesU = (2 * (a_Patch.m_DegU + 1) + 7) / 8;
+    const int t_KnotLinesV = (2 * (a_Patch.m_DegV + 1) + 7) / 8;
+    const int t_NumCpts = (a_Patch.m_DegU + 1) * (a_Patch.m_DegV + 1);
+    const int t_WeightLines = (t_NumCpts + 7) / 8;
+    return 1 + t_KnotLinesV + t_KnotLinesU + t_WeightLines + t_NumCpts + 1;
+}
+
+/*
+ *  Writes the global section with the default delimiters,
+ *  the parameters are packed into lines of 72 columns.
+ */
+void IGSWriter::writeGlobalSection(int& a_NumLines)
+{
+    auto t_Hollerith = [](const std::string& a_Text)
+    {
+        return a_Text.empty() ? std::string() : std::to_string(a_Text.size()) + "H" + a_Text;
+    };
+    char t_Date[32];
+    const std::time_t t_Now = std::time(nullptr);
+    std::strftime(t_Date, sizeof(t_Date), "%Y%m%d.%H%M%S", std::localtime(&t_Now));
+
+    const std::string t_Product = "PolyhedralSplines";
+    const std::vector<std::string> t_Params = {
+        "1H,", "1H;", t_Hollerith(t_Product), t_Hollerith(m_FileName), t_Hollerith(t_Product), t_Hollerith("1.0"),
+        "32", "38", "6", "308", "15", t_Hollerith(t_Product), "1.0", "1", "4HINCH", "1", "0.01", t_Hollerith(t_Date),
+        "1.0E-6", "0.0", "", "", "11", "0", t_Hollerith(t_Date)};
+
+    std::string t_Line;
+    auto t_WriteLine = [&]()
+    {
+        fprintf(m_OutFile, "%-72sG%7d\n", t_Line.c_str(), a_NumLines + 1);
+        a_NumLines++;
+        t_Line.clear();
+    };
+    a_NumLines = 0;
+    for(size_t i = 0; i < t_Params.size(); i++)
+    {
+        std::string t_Param = t_Params[i] + (i + 1 < t_Params.size() ? "," : ";");
+        if(t_Line.size() + t_Param.size() > 72)
+        {
+            t_WriteLine();
+        }
+        // Parameters longer than a line, e.g. a long file name, continue on the next line
+        while(t_Param.size() > 72)
+        {
+            t_Line = t_Param.substr(0, 72);
+            t_Param.erase(0, 72);
+            t_WriteLine();
+        }
+        t_Line += t_Param;
+    }
+    t_WriteLine();
+}
 
 /*
  *  Destructor.
- *  All it does is close the file.
+ *  Writes the file and closes it.
  */
 IGSWriter::~IGSWriter()
 {
-    fprintf(m_OutFile, "copyright(c)Jorg Peters [jorg.peters@gmail.com]                         S      1\n");
-
-    int k, k1, w, w1, rows, flen[4], i, m, j, col, cols, fc, sds, dg;
-    double	h;
-
-    //int facelen = 2;
-    int t_Bbctr = 1;
-    int t_Ffctr = 1;
-
-    for (fc=0; fc < m_Patches.size(); fc++)
+    if(m_OutFile == nullptr)
     {
+        std::cerr << "Could not open " << m_FileName << " for writing\n";
+        return;
+    }
 
-        auto t_Patch = m_Patches[fc];
-        int t_DegU = t_Patch.m_DegU;
-        int t_DegV = t_Patch.m_DegV;
-
-        //k = (dg+1)*2;
-        k = (t_DegU + 1) + (t_DegV + 1);
-        k1 = (k % 8 != 0) + k / 8;  /* knots */
-        w = (t_DegU + 1) * (t_DegV + 1);
-        w1 = (w % 8 != 0) + w / 8;  /* weights */
-
-        /* deg-line, knots, weights, xyz location, param */
-        rows  = (1 + 2 * k1 + w1 + w + 1);  /* size of one block */
-
-        fprintf(m_OutFile,"     128%8d       0       1       0       0       0        00000000D%7d\n", t_Bbctr, t_Ffctr);
-        fprintf(m_OutFile,"     128%8d       8      %d       2                NurbSurf       0D%7d\n", 0, rows, t_Ffctr+1);
-
-        t_Bbctr += rows;
-        t_Ffctr += 2;
+    fprintf(m_OutFile, "copyright(c)Jorg Peters [jorg.peters@gmail.com]                         S      1\n");
+    int t_NumGlobalLines;
+    writeGlobalSection(t_NumGlobalLines);
+
+    // First parameter data line of each patch, the prefix sum of the line counts
+    const size_t t_NumPatches = m_Patches.size();
+    std::vector<int> t_FirstLine(t_NumPatches + 1);
+    t_FirstLine[0] = 1;
+    for (size_t fc=0; fc < t_NumPatches; fc++)
+    {
+        t_FirstLine[fc + 1] = t_FirstLine[fc] + numParameterLines(m_Patches[fc]);
     }
-    flen[0] = 1;
-    flen[1] = 10;
 
-    /* data entries */
-    t_Ffctr = 1; t_Bbctr = 1;
-    for (fc=0; fc < m_Patches.size(); fc++)
+    /* directory entries, two lines per patch */
+    write_in_blocks(m_OutFile, t_NumPatches, m_NumThreads, [&](size_t fc, std::string& a_Out)
     {
+        const int t_Bbctr = t_FirstLine[fc];
+        const int t_Ffctr = 2 * fc + 1;
+        const int rows = t_FirstLine[fc + 1] - t_FirstLine[fc];
+        append_line(a_Out, "     128%8d       0       1       0       0       0        00000000D%7d\n", t_Bbctr, t_Ffctr);
+        append_line(a_Out, "     128%8d       8%8d       2                NurbSurf       0D%7d\n", 0, rows, t_Ffctr+1);
+    });
 
-        auto t_Patch = m_Patches[fc];
-        int t_DegU = t_Patch.m_DegU;
-        int t_DegV = t_Patch.m_DegV;
+    /* data entries */
+    write_in_blocks(m_OutFile, t_NumPatches, m_NumThreads, [&](size_t fc, std::string& a_Out)
+    {
+        const Patch& t_Patch = m_Patches[fc];
+        const int t_DegU = t_Patch.m_DegU;
+        const int t_DegV = t_Patch.m_DegV;
+        const int t_Ffctr = 2 * fc + 1;
+        int t_Bbctr = t_FirstLine[fc];
 
         /* HEADER */
-        fprintf(m_OutFile, "128,%7d,%7d,%7d,%7d,0,0,1,0,0,%26dP%7d\n",
+        append_line(a_Out, "128,%7d,%7d,%7d,%7d,0,0,1,0,0,%26dP%7d\n",
                 t_DegV, t_DegU, t_DegV, t_DegU, t_Ffctr, t_Bbctr);
         t_Bbctr++;
 
         /* KNOTS */
-        w = (t_DegU + 1) * (t_DegV + 1);
-        t_Bbctr = IGSWriter::knots(t_DegV + 1, t_Bbctr, t_Ffctr, m_OutFile, 8);
-        t_Bbctr = IGSWriter::knots(t_DegU + 1, t_Bbctr, t_Ffctr, m_OutFile, 8);
+        t_Bbctr = IGSWriter::knots(t_DegV + 1, t_Bbctr, t_Ffctr, a_Out, 8);
+        t_Bbctr = IGSWriter::knots(t_DegU + 1, t_Bbctr, t_Ffctr, a_Out, 8);
 
         /* the w==RATIONAL coordinate */
-        cols = 8;
-        col = 0;
-        for (i=0; i<= t_DegU; i++)
+        const int cols = 8;
+        int col = 0;
+        for (int i=0; i<= t_DegU; i++)
         {
-            for (j=0; j<= t_DegV; j++)
+            for (int j=0; j<= t_DegV; j++)
             {
                 if ((col % cols==0) && (col != 0)) {  /* typeset */
-                    fprintf(m_OutFile, "%8dP%7d\n", t_Ffctr,t_Bbctr);
+                    append_line(a_Out, "%8dP%7d\n", t_Ffctr,t_Bbctr);
                     t_Bbctr++;
                 }
-                h = 1;
-                fprintf(m_OutFile, "%7.5f,", h);
+                a_Out += "1.00000,";
                 col++;
             }
         }
@@ -130,35 +227,33 @@ IGSWriter::~IGSWriter()
         if (col != 0)
         {
             col = cols-col;
-            for (i=0; i< col; i++)
+            for (int i=0; i< col; i++)
             {
-                fprintf(m_OutFile,"        ");
+                a_Out += "        ";
             }
         }
 
-        fprintf(m_OutFile, "%8dP%7d\n", t_Ffctr, t_Bbctr);
+        append_line(a_Out, "%8dP%7d\n", t_Ffctr, t_Bbctr);
         t_Bbctr++;
 
         /* the XYZ coordinates */
-        for (i=0; i<= t_DegU; i++)
+        for (int i=0; i<= t_DegU; i++)
         {
-            for (j=0; j<= t_DegV; j++)
+            for (int j=0; j<= t_DegV; j++)
             {
-                fprintf(m_OutFile,"%20e,%20e,%20e,%9dP%7d\n",
-                        t_Patch.m_BBcoefs[i][j][0], t_Patch.m_BBcoefs[i][j][1], t_Patch.m_BBcoefs[i][j][2], t_Ffctr,t_Bbctr);
+                append_line(a_Out, "%20e,%20e,%20e,%9dP%7d\n",
+                        t_Patch(i, j, 0), t_Patch(i, j, 1), t_Patch(i, j, 2), t_Ffctr,t_Bbctr);
                 t_Bbctr++;
             }
         }
 
-        fprintf(m_OutFile, "0.00000,1.00000,0.00000,1.00000;%40dP%7d\n", t_Ffctr, t_Bbctr);
+        append_line(a_Out, "0.00000,1.00000,0.00000,1.00000;%40dP%7d\n", t_Ffctr, t_Bbctr);
         t_Bbctr++;
-        t_Ffctr += 2;
-    }
-    flen[2] = t_Ffctr;
-    flen[3] = t_Bbctr;
+        assert(t_Bbctr == t_FirstLine[fc + 1]);
+    });
 
     /* structure of file */
-    fprintf(m_OutFile, "S%7dG%7dD%7dP%7d%40dT%7d\n", flen[0], flen[1], flen[2] - 1, flen[3] - 1, 1, 1);
+    fprintf(m_OutFile, "S%7dG%7dD%7dP%7d%40dT%7d\n", 1, t_NumGlobalLines, static_cast<int>(2 * t_NumPatches), t_FirstLine[t_NumPatches] - 1, 1, 1);
 
     fclose(m_OutFile);
 }
@@ -186,13 +281,13 @@ void IGSWriter::stop()
  *  Adds a patch to the queue in a
  *  thread-safe way.
  */
-void IGSWriter::consume(const Patch a_Patch)
+void IGSWriter::consume(const Patch& a_Patch)
 {
     writePatch(a_Patch);
     return;
 }
 
-void IGSWriter::writePatch(const Patch a_Patch)
+void IGSWriter::writePatch(const Patch& a_Patch)
 {
     // Check that the patch has the correct
     // number of control points for its degree
@@ -10,18 +10,27 @@
 #include "PatchConsumer.hpp"
 #include "../Patch/Patch.hpp"
 
+/*
+ *  Collects the patches and writes the IGES file in the destructor.
+ *  The number of parameter lines of a patch follows from its degree,
+ *  so the sequence numbers of all patches are known up front and the
+ *  directory entries and parameter data are formatted in parallel.
+ */
 class IGSWriter : public PatchConsumer
 {
 public:
-    IGSWriter(const std::string a_OutFile);
+    IGSWriter(const std::string a_OutFile, int a_NumThreads = 0);
     ~IGSWriter();
     void start();
     void stop();
-    void consume(const Patch a_Patch);
+    void consume(const Patch& a_Patch);
 private:
     std::vector<Patch> m_Patches;
+    std::string m_FileName;
     FILE* m_OutFile;
-    int m_NumOfFaces = 0;
-    int knots(int dg1, int bbase, int ffctr, FILE* fp, int per_line);
-    void writePatch(const Patch a_Patch);
+    int m_NumThreads;
+    static int knots(int a_Deg1, int a_Bbase, int a_Ffctr, std::string& a_Out, int a_PerLine);
+    static int numParameterLines(const Patch& a_Patch);
+    void writeGlobalSection(int& a_NumLines);
+    void writePatch(const Patch& a_Patch);
 };
@@ -14,16 +14,16 @@
  *     by scaling, by the degree in u, the difference of BB-coefficients  [i][j] and [i-1][j]
  *     in a double loop over all BB-coefficients (that have an [i-1] neighbor)
  *
- *  std::vector<std::vector<double>> get_du(const Patch& a_Patch)
+ *  std::vector<std::vector<Point>> get_du(const Patch& a_Patch)
  *  {
- *      std::vector<std::vector<double>> t_Du;
+ *      std::vector<std::vector<Point>> t_Du;
  *      for(int i=1; i<a_Patch.m_DegU+1; i++)   // note: start at 1 so that [i-1] is well-defined
  *      {
- *          std::vector<double> t_DuRow;
+ *          std::vector<Point> t_DuRow;
  *          for(int j=0; j<a_Patch.m_DegV+1; j++)
  *          {
  *              // scaling, by the degree in u, the difference of BB-coefficients  [i][j] and [i-1][j]
- *              t_DuRow.push_back(a_Patch.m_DegU * (a_Patch.m_BBcoefs[i][j] - a_Patch.m_BBcoefs[i-1][j]));
+ *              t_DuRow.push_back(a_Patch.m_DegU * (a_Patch.getPoint(i, j) - a_Patch.getPoint(i-1, j)));
  *          }
  *          t_Du.push_back(t_DuRow);
  *      }
@@ -37,5 +37,5 @@ public:
     virtual ~PatchConsumer() = default;
     virtual void start() = 0;
     virtual void stop() = 0;
-    virtual void consume(Patch a_Patch) = 0;
+    virtual void consume(const Patch& a_Patch) = 0;
 };
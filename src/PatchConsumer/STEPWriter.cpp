@@ -1,6 +1,12 @@
 /* Based on code by Jorg Peters */
 
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+
 #include "STEPWriter.hpp"
+#include "../Helper/Parallel.hpp"
 
 namespace STEPWriterVars {
 const char* heading = 
@@ -112,11 +118,36 @@ std::vector<std::string> lookUp = {"", "polyhedron", "triangular patch", "tensor
                                    "PN quads patches", "rational triangular patches"};
 }
 
-STEPWriter::STEPWriter(const std::string a_OutFile) : openShellLocs() {
+/*
+ *  Append printf style formatted text to a_Out.
+ */
+static void append_format(std::string& a_Out, const char* a_Format, ...)
+{
+    char t_Line[256];
+    va_list t_Args;
+    va_start(t_Args, a_Format);
+    const int t_Length = vsnprintf(t_Line, sizeof(t_Line), a_Format, t_Args);
+    va_end(t_Args);
+    if (t_Length < static_cast<int>(sizeof(t_Line))) {
+        a_Out.append(t_Line, t_Length);
+        return;
+    }
+    // Longer than the line buffer, format again directly into a_Out
+    const size_t t_Begin = a_Out.size();
+    a_Out.resize(t_Begin + t_Length + 1);
+    va_start(t_Args, a_Format);
+    vsnprintf(&a_Out[t_Begin], t_Length + 1, a_Format, t_Args);
+    va_end(t_Args);
+    a_Out.resize(t_Begin + t_Length);
+}
+
+STEPWriter::STEPWriter(const std::string a_OutFile, int a_NumThreads) : openShellLocs() {
     m_OutFile = fopen(a_OutFile.c_str(),"w");
     m_FileName = a_OutFile;
     m_CurrOffset = 30;                          // Start writing patches at element 30
     m_PatchNo = 0;
+    m_NumThreads = Helper::resolve_num_threads(a_NumThreads);
+    m_Texts.resize(1);
 }
 
 /*
@@ -124,7 +155,8 @@ STEPWriter::STEPWriter(const std::string a_OutFile) : openShellLocs() {
  *  All it does is close the file.
  */
 STEPWriter::~STEPWriter() {
-    fclose(m_OutFile);
+    if (m_OutFile != nullptr)
+        fclose(m_OutFile);
 }
 
 /*
@@ -136,32 +168,43 @@ void STEPWriter::start() {
 }
 
 /*
- *  Signals to WriteFromQueue to stop once
- *  it has processed all the patches in
- *  the queue.
+ *  Writes the remaining patches, the surface model
+ *  made of all open shells and the closing tags.
  */
 void STEPWriter::stop() {
-    // Make surface
-    fprintf(m_OutFile, "#27=SHELL_BASED_SURFACE_MODEL('Body1',");
-    std::string temp_str = "(#" + std::to_string(openShellLocs[0]);
-    for (int i = 1; i < openShellLocs.size(); i++)
-        temp_str += ",#" + std::to_string(openShellLocs[i]);
-    fprintf(m_OutFile, "%s));", temp_str.c_str());
+    writePending();
+
+    // Make surface, a few shells per line
+    std::string& t_Text = m_Texts[0];
+    t_Text = "#27=SHELL_BASED_SURFACE_MODEL('Body1',(";
+    for (size_t i = 0; i < openShellLocs.size(); i++) {
+        if (i > 0)
+            t_Text += (i % 8 == 0) ? ",\n" : ",";
+        append_format(t_Text, "#%d", openShellLocs[i]);
+        if (t_Text.size() >= (1 << 16)) {
+            fwrite(t_Text.data(), 1, t_Text.size(), m_OutFile);
+            t_Text.clear();
+        }
+    }
+    t_Text += "));\n";
 
     // Print closing tags
-    fprintf(m_OutFile, STEPWriterVars::ending);
+    t_Text += STEPWriterVars::ending;
+    fwrite(t_Text.data(), 1, t_Text.size(), m_OutFile);
+    t_Text.clear();
+    fflush(m_OutFile);
     return;
 }
 
 /*
  *  Process a patch
  */
-void STEPWriter::consume(const Patch a_Patch) {
+void STEPWriter::consume(const Patch& a_Patch) {
     writePatch(a_Patch);
     return;
 }
 
-void STEPWriter::writePatch(const Patch a_Patch) {
+void STEPWriter::writePatch(const Patch& a_Patch) {
     // Check that the patch has the correct
     // number of control points for its degree
     if(!a_Patch.isValid())
@@ -170,115 +213,153 @@ void STEPWriter::writePatch(const Patch a_Patch) {
         return;
     }
 
-    // Write patch out
+    if (m_NumThreads > 1) {
+        // Format a whole chunk in parallel later
+        m_Pending.push_back(a_Patch);
+        const size_t t_ChunkSize = 1024;
+        if (m_Pending.size() >= t_ChunkSize)
+            writePending();
+        return;
+    }
+
+    std::string& t_Text = m_Texts[0];
+    t_Text.clear();
+    const int t_NumIds = formatPatch(a_Patch, m_PatchNo++, m_CurrOffset, t_Text);
+    fwrite(t_Text.data(), 1, t_Text.size(), m_OutFile);
 
-    // TODO: Add code for this
-    // const auto& xBB = a_Patch.m_BBcoefs[0];
-    // const auto& yBB = a_Patch.m_BBcoefs[1];
-    // const auto& zBB = a_Patch.m_BBcoefs[2];
+    // Store where the open shell is and increment the offset
+    openShellLocs.push_back(m_CurrOffset + t_NumIds - 1);
+    m_CurrOffset += t_NumIds;
+
+    return;
+}
 
+/*
+ *  Assigns the entity ids of the pending patches in order,
+ *  formats them in parallel and writes them.
+ */
+void STEPWriter::writePending() {
+    if (m_Pending.empty())
+        return;
+
+    const size_t t_NumPatches = m_Pending.size();
+    std::vector<int> t_FirstIds(t_NumPatches);
+    for (size_t p = 0; p < t_NumPatches; p++) {
+        t_FirstIds[p] = m_CurrOffset;
+        const int t_NumPts = (m_Pending[p].m_DegU + 1) * (m_Pending[p].m_DegV + 1);
+        m_CurrOffset += t_NumPts + 21;
+        openShellLocs.push_back(m_CurrOffset - 1);
+    }
+
+    m_Texts.resize(std::max(m_Texts.size(), t_NumPatches));
+    Helper::parallel_for(0, t_NumPatches, m_NumThreads, [&](size_t p) {
+        m_Texts[p].clear();
+        formatPatch(m_Pending[p], m_PatchNo + p, t_FirstIds[p], m_Texts[p]);
+    }, 16);
+
+    for (size_t p = 0; p < t_NumPatches; p++)
+        fwrite(m_Texts[p].data(), 1, m_Texts[p].size(), m_OutFile);
+
+    m_PatchNo += t_NumPatches;
+    m_Pending.clear();
+}
+
+/*
+ *  Formats the entities of a patch with ids starting at a_FirstId,
+ *  returns the number of ids used. The last one is the open shell.
+ */
+int STEPWriter::formatPatch(const Patch& a_Patch, int a_PatchNo, int a_FirstId, std::string& a_Out) {
     int numRows = a_Patch.m_DegU + 1;
     int numCols = a_Patch.m_DegV + 1;
     int numPts = numRows * numCols;
 
-    fprintf(m_OutFile, "/* PATCH NO: %d; %s */\n", m_PatchNo++, STEPWriterVars::lookUp[atoi(a_Patch.m_PatchType.c_str())].c_str());
+    append_format(a_Out, "/* PATCH NO: %d; %s */\n", a_PatchNo, STEPWriterVars::lookUp[atoi(a_Patch.m_PatchType.c_str())].c_str());
     int ctr = 0;
     for (int row = 0; row < numRows; row++) {
         for (int col = 0; col < numCols; col++) {
-            const auto& pt = a_Patch.m_BBcoefs[row][col];
-            fprintf(m_OutFile, STEPWriterVars::cartPoint, ctr+m_CurrOffset, pt[0], pt[1], pt[2]);
+            append_format(a_Out, STEPWriterVars::cartPoint, ctr+a_FirstId, a_Patch(row, col, 0), a_Patch(row, col, 1), a_Patch(row, col, 2));
             ctr += 1;
         }
     }
 
     // Left side top to bottom
-    fprintf(m_OutFile, "#%d=B_SPLINE_CURVE_WITH_KNOTS('',%d,(", m_CurrOffset+numPts, numRows - 1);
-    std::string temp_str = "";
+    append_format(a_Out, "#%d=B_SPLINE_CURVE_WITH_KNOTS('',%d,(", a_FirstId+numPts, numRows - 1);
     for (int i = 0; i < numRows; i++) {
-        temp_str += "#" + std::to_string(m_CurrOffset + i * numCols);
+        append_format(a_Out, "#%d", a_FirstId + i * numCols);
         if (i < numRows - 1)
-            temp_str += ',';
+            a_Out += ',';
     }
     // TODO: Check following (make sure knot multiplicities are correct)
-    fprintf(m_OutFile, "%s),.UNSPECIFIED.,.F.,.F.,(%d,%d),(0.,1.),.UNSPECIFIED.);\n", temp_str.c_str(), numRows, numRows);
+    append_format(a_Out, "),.UNSPECIFIED.,.F.,.F.,(%d,%d),(0.,1.),.UNSPECIFIED.);\n", numRows, numRows);
 
     // Bottom side left to right
-    fprintf(m_OutFile, "#%d=B_SPLINE_CURVE_WITH_KNOTS('',%d,(", m_CurrOffset+numPts+1, numCols - 1);
-    temp_str = "";
+    append_format(a_Out, "#%d=B_SPLINE_CURVE_WITH_KNOTS('',%d,(", a_FirstId+numPts+1, numCols - 1);
     for (int i = 0; i < numCols; i++) {
-        temp_str += "#" + std::to_string(m_CurrOffset + numCols * (numRows - 1) + i);
+        append_format(a_Out, "#%d", a_FirstId + numCols * (numRows - 1) + i);
         if (i < numCols - 1)
-            temp_str += ',';
+            a_Out += ',';
     }
     // TODO: Check the following (make sure knot multiplicities are correct)
-    fprintf(m_OutFile, "%s),.UNSPECIFIED.,.F.,.F.,(%d,%d),(0.,1.),.UNSPECIFIED.);\n", temp_str.c_str(), numCols, numCols);
+    append_format(a_Out, "),.UNSPECIFIED.,.F.,.F.,(%d,%d),(0.,1.),.UNSPECIFIED.);\n", numCols, numCols);
 
     // Right side top to bottom
-    fprintf(m_OutFile, "#%d=B_SPLINE_CURVE_WITH_KNOTS('',%d,(", m_CurrOffset+numPts+2, numRows - 1);
-    temp_str = "";
+    append_format(a_Out, "#%d=B_SPLINE_CURVE_WITH_KNOTS('',%d,(", a_FirstId+numPts+2, numRows - 1);
     for (int i = 0; i < numRows; i++) {
-        temp_str += "#" + std::to_string(m_CurrOffset + (i + 1) * numCols - 1);
+        append_format(a_Out, "#%d", a_FirstId + (i + 1) * numCols - 1);
         if (i < numRows - 1)
-            temp_str += ',';
+            a_Out += ',';
     }
     // TODO: Check the following (make sure knot multiplicities are correct)
-    fprintf(m_OutFile, "%s),.UNSPECIFIED.,.F.,.F.,(%d,%d),(0.,1.),.UNSPECIFIED.);\n", temp_str.c_str(), numRows, numRows);
+    append_format(a_Out, "),.UNSPECIFIED.,.F.,.F.,(%d,%d),(0.,1.),.UNSPECIFIED.);\n", numRows, numRows);
 
     // Top side left to right
-    fprintf(m_OutFile, "#%d=B_SPLINE_CURVE_WITH_KNOTS('',%d,(", m_CurrOffset+numPts+3, numCols - 1);
-    temp_str = "";
+    append_format(a_Out, "#%d=B_SPLINE_CURVE_WITH_KNOTS('',%d,(", a_FirstId+numPts+3, numCols - 1);
     for (int i = 0; i < numCols; i++) {
-        temp_str += "#" + std::to_string(m_CurrOffset + i);
+        append_format(a_Out, "#%d", a_FirstId + i);
         if (i < numCols - 1)
-            temp_str += ',';
+            a_Out += ',';
     }
     // TODO: (make sure knot multiplicities are correct)
-    fprintf(m_OutFile, "%s),.UNSPECIFIED.,.F.,.F.,(%d,%d),(0.,1.),.UNSPECIFIED.);\n", temp_str.c_str(), numCols, numCols);
+    append_format(a_Out, "),.UNSPECIFIED.,.F.,.F.,(%d,%d),(0.,1.),.UNSPECIFIED.);\n", numCols, numCols);
 
     // Edges
-    fprintf(m_OutFile, STEPWriterVars::vertPoint, m_CurrOffset+numPts+4, m_CurrOffset+0);
-    fprintf(m_OutFile, STEPWriterVars::vertPoint, m_CurrOffset+numPts+5, m_CurrOffset+numCols*(numRows - 1));
-    fprintf(m_OutFile, STEPWriterVars::vertPoint, m_CurrOffset+numPts+6, m_CurrOffset+numCols*numRows - 1);
-    fprintf(m_OutFile, STEPWriterVars::vertPoint, m_CurrOffset+numPts+7, m_CurrOffset+numCols - 1);
-    fprintf(m_OutFile, STEPWriterVars::edgeCurve, m_CurrOffset+numPts+8, m_CurrOffset+numPts+4, m_CurrOffset+numPts+5, m_CurrOffset+numPts+0);
-    fprintf(m_OutFile, STEPWriterVars::edgeCurve, m_CurrOffset+numPts+9, m_CurrOffset+numPts+5, m_CurrOffset+numPts+6, m_CurrOffset+numPts+1);
-    fprintf(m_OutFile, STEPWriterVars::edgeCurve, m_CurrOffset+numPts+10,m_CurrOffset+numPts+7, m_CurrOffset+numPts+6, m_CurrOffset+numPts+2);
-    fprintf(m_OutFile, STEPWriterVars::edgeCurve, m_CurrOffset+numPts+11,m_CurrOffset+numPts+4, m_CurrOffset+numPts+7, m_CurrOffset+numPts+3);
-    fprintf(m_OutFile, STEPWriterVars::orientedEdge, m_CurrOffset+numPts+12, m_CurrOffset+numPts+8, ".T.");
-    fprintf(m_OutFile, STEPWriterVars::orientedEdge, m_CurrOffset+numPts+13, m_CurrOffset+numPts+9, ".T.");
-    fprintf(m_OutFile, STEPWriterVars::orientedEdge, m_CurrOffset+numPts+14, m_CurrOffset+numPts+10, ".F.");
-    fprintf(m_OutFile, STEPWriterVars::orientedEdge, m_CurrOffset+numPts+15, m_CurrOffset+numPts+11, ".F.");
-    fprintf(m_OutFile, STEPWriterVars::edgeLoop, m_CurrOffset+numPts+16, m_CurrOffset+numPts+12, m_CurrOffset+numPts+13, m_CurrOffset+numPts+14, m_CurrOffset+numPts+15);
-    fprintf(m_OutFile, "#%d=FACE_OUTER_BOUND('',#%d,.T.);\n", m_CurrOffset+numPts+17, m_CurrOffset+numPts+16);
+    append_format(a_Out, STEPWriterVars::vertPoint, a_FirstId+numPts+4, a_FirstId+0);
+    append_format(a_Out, STEPWriterVars::vertPoint, a_FirstId+numPts+5, a_FirstId+numCols*(numRows - 1));
+    append_format(a_Out, STEPWriterVars::vertPoint, a_FirstId+numPts+6, a_FirstId+numCols*numRows - 1);
+    append_format(a_Out, STEPWriterVars::vertPoint, a_FirstId+numPts+7, a_FirstId+numCols - 1);
+    append_format(a_Out, STEPWriterVars::edgeCurve, a_FirstId+numPts+8, a_FirstId+numPts+4, a_FirstId+numPts+5, a_FirstId+numPts+0);
+    append_format(a_Out, STEPWriterVars::edgeCurve, a_FirstId+numPts+9, a_FirstId+numPts+5, a_FirstId+numPts+6, a_FirstId+numPts+1);
+    append_format(a_Out, STEPWriterVars::edgeCurve, a_FirstId+numPts+10,a_FirstId+numPts+7, a_FirstId+numPts+6, a_FirstId+numPts+2);
+    append_format(a_Out, STEPWriterVars::edgeCurve, a_FirstId+numPts+11,a_FirstId+numPts+4, a_FirstId+numPts+7, a_FirstId+numPts+3);
+    append_format(a_Out, STEPWriterVars::orientedEdge, a_FirstId+numPts+12, a_FirstId+numPts+8, ".T.");
+    append_format(a_Out, STEPWriterVars::orientedEdge, a_FirstId+numPts+13, a_FirstId+numPts+9, ".T.");
+    append_format(a_Out, STEPWriterVars::orientedEdge, a_FirstId+numPts+14, a_FirstId+numPts+10, ".F.");
+    append_format(a_Out, STEPWriterVars::orientedEdge, a_FirstId+numPts+15, a_FirstId+numPts+11, ".F.");
+    append_format(a_Out, STEPWriterVars::edgeLoop, a_FirstId+numPts+16, a_FirstId+numPts+12, a_FirstId+numPts+13, a_FirstId+numPts+14, a_FirstId+numPts+15);
+    append_format(a_Out, "#%d=FACE_OUTER_BOUND('',#%d,.T.);\n", a_FirstId+numPts+17, a_FirstId+numPts+16);
 
     // Surface
     // TODO: Check that degrees are lined up correctly
-    fprintf(m_OutFile, "#%d=B_SPLINE_SURFACE_WITH_KNOTS('',%d,%d,(", m_CurrOffset+numPts+18, a_Patch.m_DegU, a_Patch.m_DegV);
+    append_format(a_Out, "#%d=B_SPLINE_SURFACE_WITH_KNOTS('',%d,%d,(", a_FirstId+numPts+18, a_Patch.m_DegU, a_Patch.m_DegV);
     ctr = 0;
     for (int row = 0; row < numRows; row++) {
-        temp_str = "(";
+        a_Out += '(';
         for (int col = 0; col < numCols; col++) {
-            temp_str += "#" + std::to_string(m_CurrOffset+ctr);
+            append_format(a_Out, "#%d", a_FirstId+ctr);
             if (col < numCols - 1)
-                temp_str += ",";
+                a_Out += ",";
             ctr +=1;
         }
-        temp_str += ')';
+        a_Out += ')';
         if (row < numRows - 1)
-            temp_str += ',';
-        
-        fprintf(m_OutFile, temp_str.c_str());
+            a_Out += ',';
     }
     // Check that multiplicities are correct order
-    fprintf(m_OutFile, "),.UNSPECIFIED.,.F.,.F.,.F.,(%d,%d),(%d,%d),(0.,1.),(0.,1.),.UNSPECIFIED.);\n", numRows, numRows, numCols, numCols);
+    append_format(a_Out, "),.UNSPECIFIED.,.F.,.F.,.F.,(%d,%d),(%d,%d),(0.,1.),(0.,1.),.UNSPECIFIED.);\n", numRows, numRows, numCols, numCols);
 
     // Face and shell
-    fprintf(m_OutFile, "#%d=ADVANCED_FACE('',(#%d),#%d,.T.);\n", m_CurrOffset+numPts+19, m_CurrOffset+numPts+17, m_CurrOffset+numPts+18);
-    fprintf(m_OutFile, "#%d=OPEN_SHELL('',(#%d));\n\n", m_CurrOffset+numPts+20, m_CurrOffset+numPts+19);
+    append_format(a_Out, "#%d=ADVANCED_FACE('',(#%d),#%d,.T.);\n", a_FirstId+numPts+19, a_FirstId+numPts+17, a_FirstId+numPts+18);
+    append_format(a_Out, "#%d=OPEN_SHELL('',(#%d));\n\n", a_FirstId+numPts+20, a_FirstId+numPts+19);
 
-    // Store where the open shell is and increment the offset
-    openShellLocs.push_back(m_CurrOffset+numPts+20);
-    m_CurrOffset += numPts+21;
-
-    return;
-}
\ No newline at end of file
+    return numPts + 21;
+}
@@ -10,18 +10,30 @@
 #include "PatchConsumer.hpp"
 #include "../Patch/Patch.hpp"
 
+/*
+ *  Streams the entities of each patch to the file as the patches arrive, only the ids of the
+ *  open shells are kept for the surface model written by stop().
+ *  With more than one thread, patches are collected in chunks whose entities are formatted in parallel.
+ *  a_NumThreads = 0 uses all hardware threads, as for IGSWriter.
+ */
 class STEPWriter : public PatchConsumer {
 public:
-    STEPWriter(const std::string a_OutFile);
+    STEPWriter(const std::string a_OutFile, int a_NumThreads = 0);
     ~STEPWriter();
     void start();
     void stop();
-    void consume(const Patch a_Patch);
+    void consume(const Patch& a_Patch);
 private:
     FILE* m_OutFile;
     int m_CurrOffset;
     std::vector<int> openShellLocs;
     std::string m_FileName;
     int m_PatchNo;
-    void writePatch(const Patch a_Patch);
+    int m_NumThreads;
+    // Patches of the current chunk when formatting in parallel, and their formatted entities
+    std::vector<Patch> m_Pending;
+    std::vector<std::string> m_Texts;
+    void writePatch(const Patch& a_Patch);
+    void writePending();
+    static int formatPatch(const Patch& a_Patch, int a_PatchNo, int a_FirstId, std::string& a_Out);
 };
\ No newline at end of file
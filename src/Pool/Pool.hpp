@@ -3,6 +3,13 @@
 #pragma once
 
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include "../Helper/MeshTopologyCache.hpp"
+#include "../Helper/SmallVector.hpp"
 #include "../Patch/Patch.hpp"
 #include "../Patch/T0PatchConstructor.hpp"
 #include "../Patch/T1PatchConstructor.hpp"
@@ -27,6 +34,17 @@
  * 
  * The \ref getPatchConstructor function traverses the pool and returns the first matching patch constructor for a given vertex or face.
  * 
+ * Classification is memoized by a topological signature of the element, computed in one pass over its neighborhood:
+ * - A vertex is described by its valence, number of faces, boundary bit and whether those faces are all quads.
+ *   This determines the result if none of the faces is a triangle, since all polar checks then fail.
+ *   Vertices next to triangles go through the constructors.
+ * - A face is described by its size, the valences of its vertices in order, the number of faces around it and whether those are all quads.
+ *   This is everything the face based constructors look at. No face based patch type is centered on a quad, so quads never match.
+ * Elements with a known signature are resolved by a table lookup instead of running the constructors.
+ * The signatures read the \ref MeshTopologyCache of the mesh when one is active.
+ * 
+ * The pool is immutable once constructed. \ref instance returns a process-wide pool that is shared by all threads, so
+ * constructors (and the masks they load on first use) are created once and \ref PatchBuilder "PatchBuilders" can refer to them for the lifetime of the process.
  */
 class PatchConstructorPool
 {
@@ -34,25 +52,239 @@ public:
     PatchConstructorPool()
     {
         // Functions to generate patches
-        m_PatchConstructorPool.push_back(new PolarPatchConstructor()); // Polar must be before Regular & Extraordinary
-        m_PatchConstructorPool.push_back(new RegularPatchConstructor());
-        m_PatchConstructorPool.push_back(new ExtraordinaryPatchConstructor());
-        // m_PatchConstructorPool.push_back(new TwoTrianglesTwoQuadsPatchConstructor()); // deprecated
-        m_PatchConstructorPool.push_back(new T0PatchConstructor());
-        m_PatchConstructorPool.push_back(new T1PatchConstructor());
-        m_PatchConstructorPool.push_back(new T2PatchConstructor());
-        m_PatchConstructorPool.push_back(new NGonPatchConstructor());
+        m_PatchConstructorPool.emplace_back(new PolarPatchConstructor()); // Polar must be before Regular & Extraordinary
+        m_PatchConstructorPool.emplace_back(new RegularPatchConstructor());
+        m_PatchConstructorPool.emplace_back(new ExtraordinaryPatchConstructor());
+        // m_PatchConstructorPool.emplace_back(new TwoTrianglesTwoQuadsPatchConstructor()); // deprecated
+        m_PatchConstructorPool.emplace_back(new T0PatchConstructor());
+        m_PatchConstructorPool.emplace_back(new T1PatchConstructor());
+        m_PatchConstructorPool.emplace_back(new T2PatchConstructor());
+        m_PatchConstructorPool.emplace_back(new NGonPatchConstructor());
+
+        for(auto& t_Entry : m_VertexMemo)
+        {
+            t_Entry.store(s_Unknown, std::memory_order_relaxed);
+        }
+        for(auto& t_Slot : m_FaceMemo)
+        {
+            t_Slot.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    PatchConstructorPool(const PatchConstructorPool&) = delete;
+    PatchConstructorPool& operator=(const PatchConstructorPool&) = delete;
+
+    /**
+     * @brief The process-wide pool. Created on first use, thread safe.
+     * 
+     * @return const PatchConstructorPool& 
+     */
+    static const PatchConstructorPool& instance()
+    {
+        static const PatchConstructorPool s_Pool;
+        return s_Pool;
     }
+
     template <typename T> PatchConstructor* getPatchConstructor(const T& a_T, MeshType& a_Mesh, bool check_marked = false) const;
 
 private:
+    // Memo entries: index into m_PatchConstructorPool, s_NoMatch, or s_Unknown if not classified yet
+    static constexpr int8_t s_NoMatch = -1;
+    static constexpr int8_t s_Unknown = -2;
+
+    /*
+     * Run the constructors in order, returning the index of the first match or s_NoMatch.
+     */
+    template <typename T> int8_t matchConstructor(const T& a_T, MeshType& a_Mesh) const
+    {
+        for(size_t i = 0; i < m_PatchConstructorPool.size(); ++i)
+        {
+            if(m_PatchConstructorPool[i]->isSamePatchType(a_T, a_Mesh, false))
+            {
+                return static_cast<int8_t>(i);
+            }
+        }
+        return s_NoMatch;
+    }
+
+    PatchConstructor* constructorAt(int8_t a_Index) const
+    {
+        return a_Index == s_NoMatch ? nullptr : m_PatchConstructorPool[a_Index].get();
+    }
+
+    PatchConstructor* classify(const VertexHandle& a_VertexHandle, MeshType& a_Mesh, bool check_marked) const;
+    PatchConstructor* classify(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, bool check_marked) const;
+
     /**
      * @brief The list of that contains an object for each \ref PatchConstructor subclasses that are considered.
      * 
      */
-    std::vector<PatchConstructor*> m_PatchConstructorPool;
+    std::vector<std::unique_ptr<PatchConstructor>> m_PatchConstructorPool;
+
+    /*
+     * Vertex signatures: valence and number of faces clamped to 15, boundary bit and all quads bit.
+     * Concurrent classifications of the same signature store the same value, so relaxed atomics suffice.
+     */
+    mutable std::array<std::atomic<int8_t>, 1024> m_VertexMemo;
+
+    /*
+     * Face signatures of faces with up to 8 vertices, see classify. Open addressing without locks:
+     * a slot holds (signature << 8) | (index + 2), or 0 if empty. Slots are only ever filled, never changed,
+     * and a signature that finds no free slot within s_FaceMemoProbes is classified without memo.
+     */
+    static constexpr size_t s_FaceMemoSize = 4096;
+    static constexpr size_t s_FaceMemoProbes = 16;
+    mutable std::array<std::atomic<uint64_t>, s_FaceMemoSize> m_FaceMemo;
 };
 
+inline PatchConstructor* PatchConstructorPool::classify(const VertexHandle& a_VertexHandle, MeshType& a_Mesh, bool check_marked) const
+{
+    if(check_marked && Helper::is_marked(a_Mesh, a_VertexHandle))
+    {
+        return nullptr;
+    }
+
+    // One lookup for the classification, the predicates of matchConstructor read it back
+    const MeshTopologyCache::Lookup t_Lookup(a_Mesh);
+    const MeshTopologyCache* t_Cache = t_Lookup.get();
+    unsigned t_NumFaces = 0;
+    bool t_HasTriangle = false;
+    bool t_AllQuads = true;
+    auto t_AddFace = [&](const FaceHandle& a_FaceHandle)
+    {
+        const int t_Size = t_Cache != nullptr ? t_Cache->faceSize(a_FaceHandle) : Helper::get_num_of_verts_for_face(a_Mesh, a_FaceHandle);
+        t_HasTriangle = t_HasTriangle || t_Size == 3;
+        t_AllQuads = t_AllQuads && t_Size == 4;
+        ++t_NumFaces;
+    };
+    if(t_Cache != nullptr && t_Cache->hasRings())
+    {
+        const uint32_t* t_Ring = t_Cache->facesAround(a_VertexHandle);
+        for(size_t i = 0; i < t_Cache->numFacesAround(a_VertexHandle); ++i)
+        {
+            t_AddFace(FaceHandle(t_Ring[i]));
+        }
+    }
+    else
+    {
+        for(auto t_VFIt = a_Mesh.cvf_ccwiter(a_VertexHandle); t_VFIt.is_valid(); ++t_VFIt)
+        {
+            t_AddFace(*t_VFIt);
+        }
+    }
+    if(t_HasTriangle)
+    {
+        // Polar configurations depend on the second ring
+        return constructorAt(matchConstructor(a_VertexHandle, a_Mesh));
+    }
+
+    const int t_VertValence = t_Cache != nullptr ? t_Cache->valence(a_VertexHandle) : Helper::get_vert_valence(a_Mesh, a_VertexHandle);
+    const unsigned t_Valence = std::min(static_cast<unsigned>(t_VertValence), 15u);
+    const bool t_IsBoundary = t_Cache != nullptr ? t_Cache->isBoundary(a_VertexHandle) : a_Mesh.is_boundary(a_VertexHandle);
+    const unsigned t_Key = t_Valence | (std::min(t_NumFaces, 15u) << 4) | (t_IsBoundary ? 1u << 8 : 0u) | (t_AllQuads ? 1u << 9 : 0u);
+    int8_t t_Index = m_VertexMemo[t_Key].load(std::memory_order_relaxed);
+    if(t_Index == s_Unknown)
+    {
+        t_Index = matchConstructor(a_VertexHandle, a_Mesh);
+        m_VertexMemo[t_Key].store(t_Index, std::memory_order_relaxed);
+    }
+    return constructorAt(t_Index);
+}
+
+inline PatchConstructor* PatchConstructorPool::classify(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, bool check_marked) const
+{
+    if(check_marked)
+    {
+        for(auto t_FVIt = a_Mesh.cfv_iter(a_FaceHandle); t_FVIt.is_valid(); ++t_FVIt)
+        {
+            if(Helper::is_marked(a_Mesh, *t_FVIt))
+            {
+                return nullptr;
+            }
+        }
+    }
+
+    // One lookup for the classification, the predicates of matchConstructor read it back
+    const MeshTopologyCache::Lookup t_Lookup(a_Mesh);
+    const MeshTopologyCache* t_Cache = t_Lookup.get();
+    const unsigned t_Size = t_Cache != nullptr ? t_Cache->faceSize(a_FaceHandle) : Helper::get_num_of_verts_for_face(a_Mesh, a_FaceHandle);
+    if(t_Size == 4)
+    {
+        return nullptr;
+    }
+    if(t_Size > 8)
+    {
+        return constructorAt(matchConstructor(a_FaceHandle, a_Mesh));
+    }
+
+    // Size, vertex valences clamped to 15 in counterclockwise order, number of neighbor faces clamped to 255 and all quads bit
+    uint64_t t_Key = t_Size;
+    int t_Shift = 4;
+    Helper::SmallVector<int, 32> t_NBFaces;
+    for(auto t_FVIt = a_Mesh.cfv_ccwiter(a_FaceHandle); t_FVIt.is_valid(); ++t_FVIt, t_Shift += 4)
+    {
+        const int t_Valence = t_Cache != nullptr ? t_Cache->valence(*t_FVIt) : Helper::get_vert_valence(a_Mesh, *t_FVIt);
+        t_Key |= static_cast<uint64_t>(std::min(static_cast<unsigned>(t_Valence), 15u)) << t_Shift;
+        if(t_Cache != nullptr && t_Cache->hasRings())
+        {
+            const uint32_t* t_Ring = t_Cache->facesAround(*t_FVIt);
+            for(size_t i = 0; i < t_Cache->numFacesAround(*t_FVIt); ++i)
+            {
+                if(static_cast<int>(t_Ring[i]) != a_FaceHandle.idx())
+                {
+                    t_NBFaces.push_back(static_cast<int>(t_Ring[i]));
+                }
+            }
+            continue;
+        }
+        for(auto t_VFIt = a_Mesh.cvf_iter(*t_FVIt); t_VFIt.is_valid(); ++t_VFIt)
+        {
+            if(*t_VFIt != a_FaceHandle)
+            {
+                t_NBFaces.push_back(t_VFIt->idx());
+            }
+        }
+    }
+    std::sort(t_NBFaces.begin(), t_NBFaces.end());
+    const size_t t_NumNBFaces = std::unique(t_NBFaces.begin(), t_NBFaces.end()) - t_NBFaces.begin();
+    bool t_AllQuads = true;
+    for(size_t i = 0; i < t_NumNBFaces && t_AllQuads; ++i)
+    {
+        const FaceHandle t_NBFace(t_NBFaces[i]);
+        t_AllQuads = (t_Cache != nullptr ? t_Cache->faceSize(t_NBFace) : Helper::get_num_of_verts_for_face(a_Mesh, t_NBFace)) == 4;
+    }
+    t_Key |= static_cast<uint64_t>(std::min<size_t>(t_NumNBFaces, 255)) << 36;
+    t_Key |= static_cast<uint64_t>(t_AllQuads) << 44;
+
+    const size_t t_Home = static_cast<size_t>((t_Key * 0x9E3779B97F4A7C15ull) >> 52) % s_FaceMemoSize;
+    for(size_t p = 0; p < s_FaceMemoProbes; ++p)
+    {
+        const uint64_t t_Slot = m_FaceMemo[(t_Home + p) % s_FaceMemoSize].load(std::memory_order_relaxed);
+        if(t_Slot == 0)
+        {
+            break;
+        }
+        if((t_Slot >> 8) == t_Key)
+        {
+            return constructorAt(static_cast<int8_t>(static_cast<int>(t_Slot & 0xFF) - 2));
+        }
+    }
+
+    const int8_t t_Index = matchConstructor(a_FaceHandle, a_Mesh);
+    const uint64_t t_Entry = (t_Key << 8) | static_cast<uint64_t>(t_Index + 2);
+    for(size_t p = 0; p < s_FaceMemoProbes; ++p)
+    {
+        uint64_t t_Expected = 0;
+        auto& t_Slot = m_FaceMemo[(t_Home + p) % s_FaceMemoSize];
+        // Stop once the slot is ours or already holds this signature from a concurrent classification
+        if(t_Slot.compare_exchange_strong(t_Expected, t_Entry, std::memory_order_relaxed) || (t_Expected >> 8) == t_Key)
+        {
+            break;
+        }
+    }
+    return constructorAt(t_Index);
+}
+
 /**
  * @brief Find a patch \ref PatchConstructor that matches the given vertex or face.
  * 
@@ -64,14 +296,7 @@ private:
  */
 template <typename T> PatchConstructor* PatchConstructorPool::getPatchConstructor(const T& a_T, MeshType& a_Mesh, bool check_marked) const
 {
-    for(auto t_PatchConstructor : m_PatchConstructorPool)
-    {
-        if(t_PatchConstructor->isSamePatchType(a_T, a_Mesh, check_marked))
-        {
-            return t_PatchConstructor;
-        }
-    }
-    return nullptr;
+    return classify(a_T, a_Mesh, check_marked);
 }
 template PatchConstructor* PatchConstructorPool::getPatchConstructor(const VertexHandle& a_VertexHandle, MeshType& a_Mesh, bool check_marked) const;
 template PatchConstructor* PatchConstructorPool::getPatchConstructor(const FaceHandle& a_FaceHandle, MeshType& a_Mesh, bool check_marked) const;
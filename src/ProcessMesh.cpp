@@ -1,25 +1,165 @@
 /* copyright(c)Jorg Peters [jorg.peters@gmail.com] */
 
 #include "ProcessMesh.hpp"
+#include "Helper/MeshTopologyCache.hpp"
+#include "Helper/Parallel.hpp"
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
 
-void process_mesh(MeshType& a_Mesh, PatchConsumer* a_Consumer, const bool a_IsDegRaise)
+// Raise the degree of the builders [a_Begin, a_End) if requested and build their patches in one batch
+static std::vector<Patch> buildPatchBlock(MeshType& a_Mesh, std::vector<PatchBuilder>& a_PatchBuilders, const size_t a_Begin, const size_t a_End, const bool a_IsDegRaise)
 {
+	if (a_IsDegRaise)
+	{
+		for (size_t i = a_Begin; i < a_End; ++i)
+		{
+			a_PatchBuilders[i].degRaise();
+		}
+	}
+	return PatchBuilder::buildPatchesBatched(a_Mesh, a_PatchBuilders.data() + a_Begin, a_End - a_Begin);
+}
 
-	a_Consumer->start();
+/*
+ * Build the patches of a_PatchBuilders on a_NumThreads worker threads while the calling thread hands
+ * them to the consumer, so the consumer never needs to be thread safe.
+ *
+ * Builders are processed in blocks of consecutive builders. Workers claim blocks in order and at most
+ * t_MaxPendingBlocks blocks are claimed but not yet consumed, which bounds the memory held by built
+ * patches. In ordered mode blocks are consumed in builder order, so the output is the same as the
+ * serial loop. Otherwise any finished block is consumed first.
+ */
+static void buildPatchesPipelined(MeshType& a_Mesh, std::vector<PatchBuilder>& a_PatchBuilders, PatchConsumer* a_Consumer, const bool a_IsDegRaise, const int a_NumThreads, const bool a_IsOrdered)
+{
+	const size_t t_BlockSize = 256;
+	const size_t t_NumBlocks = (a_PatchBuilders.size() + t_BlockSize - 1) / t_BlockSize;
+	const size_t t_MaxPendingBlocks = 4 * static_cast<size_t>(a_NumThreads);
 
-	std::vector<PatchBuilder> t_PatchBuilders = getPatchBuilders(a_Mesh);
+	std::mutex t_Mutex;
+	std::condition_variable t_CanClaim;
+	std::condition_variable t_CanConsume;
+	size_t t_NextBlock = 0;
+	size_t t_NumConsumed = 0;
+	std::map<size_t, std::vector<Patch>> t_Ready;
+	std::exception_ptr t_Error;
 
-	// Face iteration
-	for (auto patchBuilder = t_PatchBuilders.begin(); patchBuilder != t_PatchBuilders.end(); ++patchBuilder)
+	auto t_Worker = [&]()
 	{
-		if(a_IsDegRaise)
+		while (true)
 		{
-			patchBuilder->degRaise();
+			size_t t_Block;
+			{
+				std::unique_lock<std::mutex> t_Lock(t_Mutex);
+				t_CanClaim.wait(t_Lock, [&]() { return t_Error || t_NextBlock >= t_NumBlocks || t_NextBlock - t_NumConsumed < t_MaxPendingBlocks; });
+				if (t_Error || t_NextBlock >= t_NumBlocks)
+				{
+					return;
+				}
+				t_Block = t_NextBlock++;
+			}
+			std::vector<Patch> t_Patches;
+			try
+			{
+				const size_t t_End = std::min(a_PatchBuilders.size(), (t_Block + 1) * t_BlockSize);
+				t_Patches = buildPatchBlock(a_Mesh, a_PatchBuilders, t_Block * t_BlockSize, t_End, a_IsDegRaise);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> t_Lock(t_Mutex);
+				if (!t_Error)
+				{
+					t_Error = std::current_exception();
+				}
+				t_CanClaim.notify_all();
+				t_CanConsume.notify_all();
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> t_Lock(t_Mutex);
+				t_Ready.emplace(t_Block, std::move(t_Patches));
+			}
+			t_CanConsume.notify_one();
 		}
-		auto t_FacePatches = patchBuilder->buildPatches(a_Mesh);
-		for (auto t_Patch : t_FacePatches)
+	};
+
+	std::vector<std::thread> t_Threads;
+	for (int t = 0; t < a_NumThreads; ++t)
+	{
+		t_Threads.emplace_back(t_Worker);
+	}
+
+	try
+	{
+		for (size_t n = 0; n < t_NumBlocks; ++n)
 		{
+			std::vector<Patch> t_Patches;
+			{
+				std::unique_lock<std::mutex> t_Lock(t_Mutex);
+				t_CanConsume.wait(t_Lock, [&]() { return t_Error || (a_IsOrdered ? t_Ready.count(n) > 0 : !t_Ready.empty()); });
+				if (t_Error)
+				{
+					break;
+				}
+				auto t_It = a_IsOrdered ? t_Ready.find(n) : t_Ready.begin();
+				t_Patches = std::move(t_It->second);
+				t_Ready.erase(t_It);
+			}
+			for (auto& t_Patch : t_Patches)
+			{
+				a_Consumer->consume(t_Patch);
+			}
+			{
+				std::lock_guard<std::mutex> t_Lock(t_Mutex);
+				++t_NumConsumed;
+			}
+			t_CanClaim.notify_one();
+		}
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> t_Lock(t_Mutex);
+		if (!t_Error)
+		{
+			t_Error = std::current_exception();
+		}
+		t_CanClaim.notify_all();
+	}
+
+	for (auto& t_Thread : t_Threads)
+	{
+		t_Thread.join();
+	}
+	if (t_Error)
+	{
+		std::rethrow_exception(t_Error);
+	}
+}
+
+void process_mesh(MeshType& a_Mesh, PatchConsumer* a_Consumer, const bool a_IsDegRaise, const int a_NumThreads, const bool a_IsOrdered)
+{
+
+	a_Consumer->start();
+
+	std::vector<PatchBuilder> t_PatchBuilders = getPatchBuilders(a_Mesh, a_NumThreads);
 
+	const int t_NumThreads = Helper::resolve_num_threads(a_NumThreads);
+	if (t_NumThreads > 1)
+	{
+		buildPatchesPipelined(a_Mesh, t_PatchBuilders, a_Consumer, a_IsDegRaise, t_NumThreads, a_IsOrdered);
+		a_Consumer->stop();
+		return;
+	}
+
+	// Builders are built in blocks so that builders sharing a mask are evaluated together
+	const size_t t_BlockSize = 256;
+	for (size_t t_Begin = 0; t_Begin < t_PatchBuilders.size(); t_Begin += t_BlockSize)
+	{
+		const size_t t_End = std::min(t_PatchBuilders.size(), t_Begin + t_BlockSize);
+		auto t_BlockPatches = buildPatchBlock(a_Mesh, t_PatchBuilders, t_Begin, t_End, a_IsDegRaise);
+		for (auto& t_Patch : t_BlockPatches)
+		{
 			a_Consumer->consume(t_Patch);
 		}
 	}
@@ -43,49 +183,141 @@ static void setupMarkedStatus(MeshType& a_Mesh)
 	}
 }
 
-std::vector<PatchBuilder> getPatchBuilders(MeshType& a_Mesh)
+/*
+ * Collect the patch builders of one subdivision level and append them to a_PatchBuilders.
+ *
+ * The result (builders, their order and the marking) is the same as the serial sweep that visits
+ * all faces and then all vertices, matching each against the pool and marking what it gathers.
+ * To allow running on several threads the sweep is split into three phases:
+ * 1. Classify (parallel): each element unmarked at the start of the level is matched against the pool.
+ *    Matching only depends on the topology and on the marks of the element's own vertices, and marks
+ *    only grow during a level, so a match found here is the one the serial sweep would find if the
+ *    element is still unmarked when the sweep reaches it.
+ * 2. Claim (serial): candidates are visited in the serial order. A candidate is kept only if its vertices
+ *    are still unmarked, and is then marked the same way PatchConstructor::getPatchBuilder marks.
+ * 3. Build (parallel): the PatchBuilders of the claimed elements are gathered without marking.
+ */
+static void collectPatchBuilders(MeshType& a_Mesh, const PatchConstructorPool& a_Pool, const int a_NumThreads, std::vector<PatchBuilder>& a_PatchBuilders)
+{
+	const size_t t_NumFaces = a_Mesh.n_faces();
+	const size_t t_NumVerts = a_Mesh.n_vertices();
+
+	// Valences, face sizes and one-rings are read from flat arrays while patch types are identified
+	MeshTopologyCache t_TopologyCache(a_Mesh, a_NumThreads);
+	MeshTopologyCache::Scope t_TopologyScope(t_TopologyCache);
+
+	// Classify. Faces are [0, t_NumFaces), vertices follow.
+	std::vector<PatchConstructor*> t_Candidates(t_NumFaces + t_NumVerts, nullptr);
+	Helper::parallel_for(0, t_NumFaces + t_NumVerts, a_NumThreads, [&](size_t i)
+	{
+		if (i < t_NumFaces)
+		{
+			t_Candidates[i] = a_Pool.getPatchConstructor(a_Mesh.face_handle(i), a_Mesh, true);
+		}
+		else
+		{
+			t_Candidates[i] = a_Pool.getPatchConstructor(a_Mesh.vertex_handle(i - t_NumFaces), a_Mesh, true);
+		}
+	});
+
+	// Claim in serial order
+	auto t_MarkedStatus = OpenMesh::VProp<bool>(a_Mesh, "marked_status");
+	std::vector<size_t> t_Claimed;
+	for (size_t i = 0; i < t_NumFaces; ++i)
+	{
+		if (t_Candidates[i] == nullptr)
+		{
+			continue;
+		}
+		auto t_Face = a_Mesh.face_handle(i);
+		bool t_IsFree = true;
+		for (auto t_FVIt = a_Mesh.cfv_iter(t_Face); t_FVIt.is_valid(); ++t_FVIt)
+		{
+			if (t_MarkedStatus[*t_FVIt])
+			{
+				t_IsFree = false;
+				break;
+			}
+		}
+		if (!t_IsFree)
+		{
+			continue;
+		}
+		for (auto t_FVIt = a_Mesh.cfv_iter(t_Face); t_FVIt.is_valid(); ++t_FVIt)
+		{
+			t_MarkedStatus[*t_FVIt] = true;
+		}
+		t_Claimed.push_back(i);
+	}
+	for (size_t i = t_NumFaces; i < t_NumFaces + t_NumVerts; ++i)
+	{
+		auto t_Vert = a_Mesh.vertex_handle(i - t_NumFaces);
+		if (t_Candidates[i] == nullptr || t_MarkedStatus[t_Vert])
+		{
+			continue;
+		}
+		t_MarkedStatus[t_Vert] = true;
+		t_Claimed.push_back(i);
+	}
+
+	// Build
+	std::vector<std::optional<PatchBuilder>> t_Built(t_Claimed.size());
+	Helper::parallel_for(0, t_Claimed.size(), a_NumThreads, [&](size_t k)
+	{
+		const size_t i = t_Claimed[k];
+		// The predicates of getPatchBuilder read the cache of this lookup
+		const MeshTopologyCache::Lookup t_Lookup(a_Mesh);
+		if (i < t_NumFaces)
+		{
+			t_Built[k].emplace(t_Candidates[i]->getPatchBuilder(a_Mesh.face_handle(i), a_Mesh, false));
+		}
+		else
+		{
+			t_Built[k].emplace(t_Candidates[i]->getPatchBuilder(a_Mesh.vertex_handle(i - t_NumFaces), a_Mesh, false));
+		}
+	}, 16);
+
+	a_PatchBuilders.reserve(a_PatchBuilders.size() + t_Built.size());
+	for (auto& t_Builder : t_Built)
+	{
+		a_PatchBuilders.push_back(std::move(*t_Builder));
+	}
+}
+
+std::vector<PatchBuilder> getPatchBuilders(MeshType& a_Mesh, const int a_NumThreads, const bool a_IsLocalRefinement)
 {
 	const int numSubdivisions = 2;
+	// Rings of faces kept around the unmatched region so that patches near it see the same neighborhood as in the full mesh
+	const int t_NumContextRings = 2;
 	
 	MeshType subdividedMesh = a_Mesh;
 	setupMarkedStatus(subdividedMesh);
 	std::vector<PatchBuilder> t_PatchBuilders;
-	// Construct the pool which will process the mesh
-	PatchConstructorPool t_PatchConstructorPool;
+	// The pool which will process the mesh. Its masks are loaded on first use and kept for later calls.
+	const PatchConstructorPool& t_PatchConstructorPool = PatchConstructorPool::instance();
 	for(int s = 0; s <= numSubdivisions; ++s)
 	{	
 		if(s > 0)
 		{
-			std::cout << "Subdividing mesh at level: " << s << std::endl;
-			subdividedMesh = subdividePnsControlMeshDooSabin(subdividedMesh);
-		}
-		// Face iteration
-		MeshType::FaceIter t_FaceIt, t_FaceEnd(subdividedMesh.faces_end());
-		for (auto t_FaceIt = subdividedMesh.faces_begin(); t_FaceIt != t_FaceEnd; ++t_FaceIt)
-		{
-			PatchConstructor* t_Constructor = t_PatchConstructorPool.getPatchConstructor(*t_FaceIt, subdividedMesh, true);
-			if (t_Constructor == nullptr)
+			bool t_IsDone = false;
+			MeshType t_Region;
+			if(a_IsLocalRefinement && extractUnmarkedRegion(subdividedMesh, t_NumContextRings, t_Region, t_IsDone))
 			{
-				continue;
+				std::cout << "Subdividing " << t_Region.n_faces() << " of " << subdividedMesh.n_faces() << " faces at level: " << s << std::endl;
+				subdividedMesh = subdividePnsControlMeshDooSabin(t_Region);
 			}
-			auto t_FacePatches = t_Constructor->getPatchBuilder(*t_FaceIt, subdividedMesh, true);
-			t_PatchBuilders.push_back(t_FacePatches);
-		}
-
-		// Vert iteration
-		MeshType::VertexIter t_VertIt, t_VertEnd(subdividedMesh.vertices_end());
-		for (auto t_VertIt = subdividedMesh.vertices_begin(); t_VertIt != t_VertEnd; ++t_VertIt)
-		{
-			PatchConstructor* t_Constructor = t_PatchConstructorPool.getPatchConstructor(*t_VertIt, subdividedMesh, true);
-			if (t_Constructor == nullptr)
+			else if(t_IsDone)
 			{
-				continue;
+				break;
+			}
+			else
+			{
+				// No region to extract, subdivide the whole mesh without copying it
+				std::cout << "Subdividing mesh at level: " << s << std::endl;
+				subdividedMesh = subdividePnsControlMeshDooSabin(subdividedMesh);
 			}
-
-			auto t_VertPatches = t_Constructor->getPatchBuilder(*t_VertIt, subdividedMesh, true);
-			t_PatchBuilders.push_back(t_VertPatches);
-
 		}
+		collectPatchBuilders(subdividedMesh, t_PatchConstructorPool, a_NumThreads, t_PatchBuilders);
 		std::cout << "Num patch builders: " << t_PatchBuilders.size() << std::endl;
 	}
 
@@ -93,16 +325,7 @@ std::vector<PatchBuilder> getPatchBuilders(MeshType& a_Mesh)
 }
 
 static MeshType copyMesh(MeshType &a_Mesh){
-	// Setup vertex mapping if it doesn't exist
-	if (!OpenMesh::hasProperty<OpenMesh::VertexHandle, VertexMapping>(a_Mesh, "vertex_mapping")) { 
-        // create property if it doesn't exist
-        auto t_vertexMapping = OpenMesh::VProp<VertexMapping>(a_Mesh, "vertex_mapping");
-        for (auto v : a_Mesh.vertices()) {
-            t_vertexMapping[v] = VertexMapping();
-            t_vertexMapping[v].indices.push_back(v);
-            t_vertexMapping[v].mapping.push_back(1.0);
-        }
-    }
+	ensureIdentityVertexMapping(a_Mesh);
 	MeshType t_AugmentedMesh;
 	
 	// Copy original vertices and their mappings
@@ -8,7 +8,7 @@
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
 
-std::vector<PatchBuilder> getPatchBuilders(MeshType& a_Mesh);
+std::vector<PatchBuilder> getPatchBuilders(MeshType& a_Mesh, const int a_NumThreads, const bool a_IsLocalRefinement);
 
 /**
  * \ingroup patch_build
@@ -21,8 +21,14 @@ std::vector<PatchBuilder> getPatchBuilders(MeshType& a_Mesh);
  * @param a_Mesh The mesh to be processed.
  * @param a_Consumer The PatchConsumer that will receive the extracted patches.
  * @param a_IsDegRaise If true, raises the degree in direction upto 3 for each patch. If the degree is already 3 or higher in a direction, nothing happens in that direction.
+ * @param a_NumThreads Number of threads used to identify the PnS patches and build the Bézier patches. 0 uses all hardware threads. See \ref getPatchBuilders.
+ * @param a_IsOrdered Only used with more than one thread. If true, patches reach the consumer in the same order as with a single thread.
+ * If false, patches are handed over as soon as they are built, for consumers that do not depend on the order.
+ * 
+ * With more than one thread, worker threads build the patches while the calling thread feeds them to the consumer through a bounded queue.
+ * The consumer is only ever called from the calling thread.
  */
-void process_mesh(MeshType& a_Mesh, PatchConsumer* a_Consumer, const bool a_IsDegRaise);
+void process_mesh(MeshType& a_Mesh, PatchConsumer* a_Consumer, const bool a_IsDegRaise, const int a_NumThreads = 1, const bool a_IsOrdered = true);
 
 /**
  * \ingroup patch_build
@@ -30,10 +36,20 @@ void process_mesh(MeshType& a_Mesh, PatchConsumer* a_Consumer, const bool a_IsDe
  * 
  * The function traverses the mesh to identify PnS patches and build their corresponding \ref PatchBuilder "PatchBuilders".
  * 
+ * With more than one thread, patch types are identified and builders are gathered in parallel.
+ * The returned builders, their order and the marking of the mesh are the same as with a single thread.
+ * 
+ * Regions that do not match any PnS patch type are refined by Doo-Sabin subdivision, see \ref subdividePnsControlMeshDooSabin.
+ * With local refinement only the faces that still have an unmarked vertex and a few rings of faces around them are subdivided,
+ * see \ref extractUnmarkedRegion, so the cost of the refinement depends on the size of the unmatched regions rather than the size of the mesh.
+ * Refinement stops early once every vertex is marked.
+ * 
  * @param a_Mesh The mesh to be processed.
+ * @param a_NumThreads Number of threads to use. 0 uses all hardware threads.
+ * @param a_IsLocalRefinement If true, only the unmatched regions are subdivided. If false, the whole mesh is subdivided at every level.
  * @return A vector of PatchBuilders for all identified PnS patches in the mesh.
  */
-std::vector<PatchBuilder> getPatchBuilders(MeshType& a_Mesh);
+std::vector<PatchBuilder> getPatchBuilders(MeshType& a_Mesh, const int a_NumThreads = 1, const bool a_IsLocalRefinement = true);
 
 /**
  * @brief Augments the control mesh such that the control points at boundary layer represents the position 
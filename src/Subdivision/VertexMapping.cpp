@@ -29,49 +29,54 @@ VertexMapping::VertexMapping() = default;
 //     }
 // }
 
-VertexMapping VertexMapping::operator+(const VertexMapping& other) const {
+VertexMapping VertexMapping::weightedSum(const VertexMapping* const* a_Mappings, const double* a_Weights, size_t a_Count) {
     VertexMapping result;
-    result.indices.reserve(indices.size() + other.indices.size());
-    result.mapping.reserve(indices.size() + other.indices.size());
+    // Position of the next entry of every mapping, all mappings are merged at once since their indices are sorted
+    Helper::SmallVector<size_t, InlineSize> positions;
+    positions.resize(a_Count, 0);
+    while (true) {
+        bool isDone = true;
+        MeshType::VertexHandle minIndex;
+        for (size_t k = 0; k < a_Count; ++k) {
+            if (positions[k] == a_Mappings[k]->indices.size()) continue;
+            auto index = a_Mappings[k]->indices[positions[k]];
+            if (isDone || index < minIndex) {
+                minIndex = index;
+                isDone = false;
+            }
+        }
+        if (isDone) break;
 
-    size_t i = 0, j = 0;
-    while (i < indices.size() && j < other.indices.size()) {
-        if (indices[i] == other.indices[j]) {
-            double sum = mapping[i] + other.mapping[j];
-            if (sum != 0.0) {
-                result.indices.push_back(indices[i]);
-                result.mapping.push_back(sum);
+        double sum = 0.0;
+        for (size_t k = 0; k < a_Count; ++k) {
+            const VertexMapping& m = *a_Mappings[k];
+            if (positions[k] < m.indices.size() && m.indices[positions[k]] == minIndex) {
+                sum += a_Weights[k] * m.mapping[positions[k]];
+                ++positions[k];
             }
-            ++i; ++j;
-        } else if (indices[i] < other.indices[j]) {
-            result.indices.push_back(indices[i]);
-            result.mapping.push_back(mapping[i]);
-            ++i;
-        } else {
-            result.indices.push_back(other.indices[j]);
-            result.mapping.push_back(other.mapping[j]);
-            ++j;
         }
-    }
-    while (i < indices.size()) {
-        result.indices.push_back(indices[i]);
-        result.mapping.push_back(mapping[i]);
-        ++i;
-    }
-    while (j < other.indices.size()) {
-        result.indices.push_back(other.indices[j]);
-        result.mapping.push_back(other.mapping[j]);
-        ++j;
+        if (sum != 0.0) {
+            result.indices.push_back(minIndex);
+            result.mapping.push_back(sum);
+        }
     }
     return result;
 }
 
+VertexMapping VertexMapping::operator+(const VertexMapping& other) const {
+    const VertexMapping* mappings[2] = {this, &other};
+    const double weights[2] = {1.0, 1.0};
+    return weightedSum(mappings, weights, 2);
+}
+
 VertexMapping VertexMapping::operator-() const {
     return (*this) * -1.0;
 }
 
 VertexMapping VertexMapping::operator-(const VertexMapping& other) const {
-    return (*this) + (-other);
+    const VertexMapping* mappings[2] = {this, &other};
+    const double weights[2] = {1.0, -1.0};
+    return weightedSum(mappings, weights, 2);
 }
 
 VertexMapping VertexMapping::operator*(double scalar) const {
@@ -79,9 +84,9 @@ VertexMapping VertexMapping::operator*(double scalar) const {
         return VertexMapping();
     VertexMapping result;
     result.indices = indices;
-    result.mapping.reserve(mapping.size());
-    for (double v : mapping)
-        result.mapping.push_back(v * scalar);
+    result.mapping = mapping;
+    for (double& v : result.mapping)
+        v *= scalar;
     return result;
 }
 
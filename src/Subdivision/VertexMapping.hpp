@@ -3,6 +3,7 @@
 #include <vector>
 #include <stdexcept>
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
+#include "../Helper/SmallVector.hpp"
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
 
@@ -11,6 +12,8 @@ typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
  * @brief Represents a mapping from vertices in subdivided mesh to vertices in the original mesh.
  * Each mapping consists of a list of vertex indices in the original and corresponding weights. The vertex in the subdivided mesh is represented as a weighted combination of the vertices in the original mesh.
  * This class contains arithmetic operators to facilitate combining mappings during subdivision.
+ * A mapping rarely has more than a few entries, so they are stored inline and only allocate when there are more than \ref InlineSize.
+ * Combinations of more than two mappings should use \ref weightedSum, which merges all of them at once.
  * 
  */
 class VertexMapping {
@@ -28,16 +31,35 @@ class VertexMapping {
         VertexMapping operator/(double scalar) const;
         VertexMapping operator-() const;
 
+        /**
+         * @brief Compute the linear combination of several mappings in a single merge.
+         * Produces the same entries as adding up a_Weights[k] * *a_Mappings[k], up to rounding, without the intermediate
+         * mappings: the weights of an entry are summed in one pass, so the last bits can differ from the chained sum.
+         * Entries whose weight sums to exactly zero are dropped.
+         * 
+         * @param a_Mappings Pointers to the a_Count mappings. The same mapping may appear more than once.
+         * @param a_Weights The weight of each mapping.
+         * @param a_Count The number of mappings.
+         * @return VertexMapping The combined mapping.
+         */
+        static VertexMapping weightedSum(const VertexMapping* const* a_Mappings, const double* a_Weights, size_t a_Count);
+
+        /**
+         * @brief Number of entries stored without a heap allocation.
+         * 
+         */
+        static const size_t InlineSize = 8;
+
         /**
          * @brief The VertexHandles of the vertices in the original mesh that contribute to this vertex in the subdivided mesh.
          * 
          */
-        std::vector<MeshType::VertexHandle> indices;
+        Helper::SmallVector<MeshType::VertexHandle, InlineSize> indices;
 
         /**
          * @brief The weights associated with each vertex in \ref indices.
          * The weights should sum to 1.0.
          * 
          */
-        std::vector<double> mapping;
+        Helper::SmallVector<double, InlineSize> mapping;
     };
\ No newline at end of file
@@ -1,5 +1,18 @@
 #include "subdivision.hpp"
 
+void ensureIdentityVertexMapping(MeshType& a_Mesh)
+{
+    if (OpenMesh::hasProperty<OpenMesh::VertexHandle, VertexMapping>(a_Mesh, "vertex_mapping")) {
+        return;
+    }
+    auto t_vertexMapping = OpenMesh::VProp<VertexMapping>(a_Mesh, "vertex_mapping");
+    for (auto v : a_Mesh.vertices()) {
+        t_vertexMapping[v] = VertexMapping();
+        t_vertexMapping[v].indices.push_back(v);
+        t_vertexMapping[v].mapping.push_back(1.0);
+    }
+}
+
 MeshType subdividePnsControlMeshCatmullClark(MeshType& a_Mesh){
     MeshType t_SubdividedMesh;
 
@@ -7,17 +20,13 @@ MeshType subdividePnsControlMeshCatmullClark(MeshType& a_Mesh){
     auto subdividedVertexMapping = OpenMesh::VProp<VertexMapping>(t_SubdividedMesh, "vertex_mapping");
     auto markedStatus = OpenMesh::FProp<bool>(a_Mesh, "marked_status");
     auto subdividedMarkedStatus = OpenMesh::FProp<bool>(t_SubdividedMesh, "marked_status");
-    if (!OpenMesh::hasProperty<OpenMesh::VertexHandle, VertexMapping>(a_Mesh, "vertex_mapping")) { 
-        // create property if it doesn't exist
-        auto t_vertexMapping = OpenMesh::VProp<VertexMapping>(a_Mesh, "vertex_mapping");
-        for (auto v : a_Mesh.vertices()) {
-            t_vertexMapping[v] = VertexMapping();
-            t_vertexMapping[v].indices.push_back(v);
-            t_vertexMapping[v].mapping.push_back(1.0);
-        }
-    }
+    ensureIdentityVertexMapping(a_Mesh);
     auto vertexMapping = OpenMesh::VProp<VertexMapping>(a_Mesh, "vertex_mapping");
 
+    // Scratch lists for combining mappings, see VertexMapping::weightedSum
+    Helper::SmallVector<const VertexMapping*, 16> terms;
+    Helper::SmallVector<double, 16> weights;
+
     // Cutmull Clark subdivision
 
     // Face points
@@ -29,11 +38,13 @@ MeshType subdividePnsControlMeshCatmullClark(MeshType& a_Mesh){
                 return sum + a_Mesh.point(v);
             }) / static_cast<double>(a_Mesh.valence(f));
         auto facePointHandle = t_SubdividedMesh.add_vertex(facePoint);
-        subdividedVertexMapping[facePointHandle] = std::accumulate(
-            a_Mesh.fv_begin(f), a_Mesh.fv_end(f), VertexMapping(),
-            [&vertexMapping](const VertexMapping& sum, const MeshType::VertexHandle& v) {
-                return sum + vertexMapping[v];
-            }) / static_cast<double>(a_Mesh.valence(f));
+        terms.clear();
+        weights.clear();
+        for (auto fv_it = a_Mesh.fv_begin(f); fv_it != a_Mesh.fv_end(f); ++fv_it) {
+            terms.push_back(&vertexMapping[*fv_it]);
+            weights.push_back(1.0 / a_Mesh.valence(f));
+        }
+        subdividedVertexMapping[facePointHandle] = VertexMapping::weightedSum(terms.data(), weights.data(), terms.size());
         facePoints[f] = facePointHandle;
     }
 
@@ -41,17 +52,23 @@ MeshType subdividePnsControlMeshCatmullClark(MeshType& a_Mesh){
     std::map<MeshType::EdgeHandle, MeshType::VertexHandle> edgePoints;
     for (auto e : a_Mesh.edges()) {
         auto halfEdge = a_Mesh.halfedge_handle(e);
-        VertexMapping vm = vertexMapping[a_Mesh.to_vertex_handle(halfEdge)] + vertexMapping[a_Mesh.from_vertex_handle(halfEdge)];
+        VertexMapping vm;
         MeshType::Point edgePoint = (a_Mesh.point(a_Mesh.to_vertex_handle(halfEdge)) + a_Mesh.point(a_Mesh.from_vertex_handle(halfEdge)));
         if (a_Mesh.is_boundary(e)) {
             edgePoint /= 2.0; // For boundary edges, just average the two vertices
-            vm = vm / 2.0; // Average the vertex mappings
+            // Average the vertex mappings
+            const VertexMapping* ends[2] = {&vertexMapping[a_Mesh.to_vertex_handle(halfEdge)], &vertexMapping[a_Mesh.from_vertex_handle(halfEdge)]};
+            const double endWeights[2] = {0.5, 0.5};
+            vm = VertexMapping::weightedSum(ends, endWeights, 2);
         } else {
             edgePoint += t_SubdividedMesh.point(facePoints[a_Mesh.face_handle(halfEdge)]) + 
                          t_SubdividedMesh.point(facePoints[a_Mesh.opposite_face_handle(halfEdge)]);
             edgePoint /= 4.0;
-            vm = (vm + subdividedVertexMapping[facePoints[a_Mesh.face_handle(halfEdge)]]
-                + subdividedVertexMapping[facePoints[a_Mesh.opposite_face_handle(halfEdge)]]) / 4.0;
+            const VertexMapping* ends[4] = {&vertexMapping[a_Mesh.to_vertex_handle(halfEdge)], &vertexMapping[a_Mesh.from_vertex_handle(halfEdge)],
+                &subdividedVertexMapping[facePoints[a_Mesh.face_handle(halfEdge)]],
+                &subdividedVertexMapping[facePoints[a_Mesh.opposite_face_handle(halfEdge)]]};
+            const double endWeights[4] = {0.25, 0.25, 0.25, 0.25};
+            vm = VertexMapping::weightedSum(ends, endWeights, 4);
         }
         auto edgePointHandle = t_SubdividedMesh.add_vertex(edgePoint);
         subdividedVertexMapping[edgePointHandle] = vm;
@@ -64,42 +81,48 @@ MeshType subdividePnsControlMeshCatmullClark(MeshType& a_Mesh){
         int n = a_Mesh.valence(v);
         bool isHole = a_Mesh.is_boundary(v);
         if (!isHole){
+            // The mapping is (Fm + Rm + (n - 2) * vertexMapping[v]) / n with Fm and Rm the averages below, combined in one merge
+            terms.clear();
+            weights.clear();
             MeshType::Point F(0, 0, 0); // Average of face points
-            VertexMapping Fm; // Average of face point mappings
             for (auto vf_it = a_Mesh.vf_begin(v); vf_it != a_Mesh.vf_end(v); ++vf_it) {
                 F += t_SubdividedMesh.point(facePoints[*vf_it]);
-                Fm = Fm + subdividedVertexMapping[facePoints[*vf_it]];
+                terms.push_back(&subdividedVertexMapping[facePoints[*vf_it]]);
+                weights.push_back(1.0 / (static_cast<double>(n) * n));
             }
             F /= static_cast<double>(n);
-            Fm = Fm / static_cast<double>(n);
 
             MeshType::Point R(0, 0, 0); // Average of midpoints of edges
-            VertexMapping Rm; // Average of edge midpoints mappings
             for (auto voh_it = a_Mesh.voh_begin(v); voh_it != a_Mesh.voh_end(v); ++voh_it) {
                 R += a_Mesh.point(a_Mesh.to_vertex_handle(*voh_it));
-                Rm = Rm + vertexMapping[a_Mesh.to_vertex_handle(*voh_it)];
+                terms.push_back(&vertexMapping[a_Mesh.to_vertex_handle(*voh_it)]);
+                weights.push_back(1.0 / (static_cast<double>(n) * n));
             }
             R /= static_cast<double>(n);
-            Rm = Rm / static_cast<double>(n);
 
             MeshType::Point vertexPoint = (F + R + (n - 2.0) * a_Mesh.point(v)) / static_cast<double>(n);
-            VertexMapping vm = (Fm + Rm + vertexMapping[v] * (n - 2.0)) / static_cast<double>(n);
+            terms.push_back(&vertexMapping[v]);
+            weights.push_back((n - 2.0) / n);
+            VertexMapping vm = VertexMapping::weightedSum(terms.data(), weights.data(), terms.size());
             auto vertexPointHandle = t_SubdividedMesh.add_vertex(vertexPoint);
             subdividedVertexMapping[vertexPointHandle] = vm;
             vertexPoints[v] = vertexPointHandle;
         } else {
             int numHoleEdges = 1;
             MeshType::Point holePoint = a_Mesh.point(v);
-            VertexMapping holeMapping = vertexMapping[v];
+            terms.clear();
+            terms.push_back(&vertexMapping[v]);
             for (auto ve_it = a_Mesh.ve_begin(v); ve_it != a_Mesh.ve_end(v); ++ve_it) {
                 if (a_Mesh.is_boundary(*ve_it)) {
                     holePoint += t_SubdividedMesh.point(edgePoints[*ve_it]);
-                    holeMapping = holeMapping + subdividedVertexMapping[edgePoints[*ve_it]];
+                    terms.push_back(&subdividedVertexMapping[edgePoints[*ve_it]]);
                     ++numHoleEdges;
                 }
             }
             holePoint /= static_cast<double>(numHoleEdges);
-            holeMapping = holeMapping / static_cast<double>(numHoleEdges);
+            weights.clear();
+            weights.resize(terms.size(), 1.0 / numHoleEdges);
+            VertexMapping holeMapping = VertexMapping::weightedSum(terms.data(), weights.data(), terms.size());
             auto vertexPointHandle = t_SubdividedMesh.add_vertex(holePoint);
             subdividedVertexMapping[vertexPointHandle] = holeMapping;
             vertexPoints[v] = vertexPointHandle;
@@ -140,16 +163,13 @@ MeshType subdividePnsControlMeshDooSabin(MeshType& a_Mesh)
     auto markedStatus = OpenMesh::VProp<bool>(a_Mesh, "marked_status");
     auto subdividedMarkedStatus = OpenMesh::VProp<bool>(t_SubdividedMesh, "marked_status");
 
-    if (!OpenMesh::hasProperty<OpenMesh::VertexHandle, VertexMapping>(a_Mesh, "vertex_mapping")) {
-        auto t_vertexMapping = OpenMesh::VProp<VertexMapping>(a_Mesh, "vertex_mapping");
-        for (auto v : a_Mesh.vertices()) {
-            t_vertexMapping[v] = VertexMapping();
-            t_vertexMapping[v].indices.push_back(v);
-            t_vertexMapping[v].mapping.push_back(1.0);
-        }
-    }
+    ensureIdentityVertexMapping(a_Mesh);
     auto vertexMapping = OpenMesh::VProp<VertexMapping>(a_Mesh, "vertex_mapping");
 
+    // Scratch lists for combining mappings, see VertexMapping::weightedSum
+    Helper::SmallVector<const VertexMapping*, 16> terms;
+    Helper::SmallVector<double, 16> weights;
+
     // corner vertices keyed by halfedge (corner = from_vertex(h) in face f(h))
     std::map<MeshType::HalfedgeHandle, MeshType::VertexHandle> cornerVertices;
 
@@ -162,10 +182,13 @@ MeshType subdividePnsControlMeshDooSabin(MeshType& a_Mesh)
             [&a_Mesh](const MeshType::Point& s, const MeshType::VertexHandle& v){ return s + a_Mesh.point(v); }
         ) / static_cast<double>(n);
 
-        VertexMapping Fm = std::accumulate(
-            a_Mesh.fv_begin(f), a_Mesh.fv_end(f), VertexMapping(),
-            [&vertexMapping](const VertexMapping& s, const MeshType::VertexHandle& v){ return s + vertexMapping[v]; }
-        ) / static_cast<double>(n);
+        terms.clear();
+        for (auto fv_it = a_Mesh.fv_begin(f); fv_it != a_Mesh.fv_end(f); ++fv_it) {
+            terms.push_back(&vertexMapping[*fv_it]);
+        }
+        weights.clear();
+        weights.resize(terms.size(), 1.0 / n);
+        VertexMapping Fm = VertexMapping::weightedSum(terms.data(), weights.data(), terms.size());
 
 
         std::vector<MeshType::VertexHandle> facePoly;
@@ -183,12 +206,10 @@ MeshType subdividePnsControlMeshDooSabin(MeshType& a_Mesh)
             // corner position: (V + E_prev + E_next + F)/4
             MeshType::Point cornerP = (a_Mesh.point(v) + E_prev_p + E_next_p + Fp) / 4.0;
 
-            // mapping mirrors the same linear combo
-            VertexMapping vm =
-                ( vertexMapping[v]
-                + (vertexMapping[v_prev] + vertexMapping[v]) * 0.5
-                + (vertexMapping[v]     + vertexMapping[v_next]) * 0.5
-                + Fm ) / 4.0;
+            // mapping mirrors the same linear combo: V/2 + V_prev/8 + V_next/8 + F/4
+            const VertexMapping* cornerTerms[4] = {&vertexMapping[v], &vertexMapping[v_prev], &vertexMapping[v_next], &Fm};
+            const double cornerWeights[4] = {0.5, 0.125, 0.125, 0.25};
+            VertexMapping vm = VertexMapping::weightedSum(cornerTerms, cornerWeights, 4);
 
             auto vh = t_SubdividedMesh.add_vertex(cornerP);
             subdividedVertexMapping[vh] = vm;
@@ -235,4 +256,71 @@ MeshType subdividePnsControlMeshDooSabin(MeshType& a_Mesh)
     }
 
     return t_SubdividedMesh;
-}
\ No newline at end of file
+}
+
+bool extractUnmarkedRegion(MeshType& a_Mesh, const int a_NumRings, MeshType& a_Region, bool& a_IsEmpty)
+{
+    auto markedStatus = OpenMesh::VProp<bool>(a_Mesh, "marked_status");
+    ensureIdentityVertexMapping(a_Mesh);
+    auto vertexMapping = OpenMesh::VProp<VertexMapping>(a_Mesh, "vertex_mapping");
+
+    // Faces with an unmarked vertex
+    std::vector<bool> keepFace(a_Mesh.n_faces(), false);
+    std::vector<bool> keepVertex(a_Mesh.n_vertices(), false);
+    a_IsEmpty = true;
+    for (auto v : a_Mesh.vertices()) {
+        if (markedStatus[v]) continue;
+        a_IsEmpty = false;
+        for (auto vf_it = a_Mesh.vf_begin(v); vf_it != a_Mesh.vf_end(v); ++vf_it) {
+            keepFace[vf_it->idx()] = true;
+        }
+    }
+    if (a_IsEmpty) {
+        return false;
+    }
+
+    // Grow by rings of faces sharing a vertex with the region
+    for (int r = 0; r <= a_NumRings; ++r) {
+        for (auto f : a_Mesh.faces()) {
+            if (!keepFace[f.idx()]) continue;
+            for (auto fv_it = a_Mesh.fv_begin(f); fv_it != a_Mesh.fv_end(f); ++fv_it) {
+                keepVertex[fv_it->idx()] = true;
+            }
+        }
+        if (r == a_NumRings) break;
+        for (auto v : a_Mesh.vertices()) {
+            if (!keepVertex[v.idx()]) continue;
+            for (auto vf_it = a_Mesh.vf_begin(v); vf_it != a_Mesh.vf_end(v); ++vf_it) {
+                keepFace[vf_it->idx()] = true;
+            }
+        }
+    }
+    if (std::find(keepFace.begin(), keepFace.end(), false) == keepFace.end()) {
+        return false;
+    }
+
+    a_Region.clear();
+    auto regionVertexMapping = OpenMesh::VProp<VertexMapping>(a_Region, "vertex_mapping");
+    auto regionMarkedStatus = OpenMesh::VProp<bool>(a_Region, "marked_status");
+    std::vector<MeshType::VertexHandle> regionVertex(a_Mesh.n_vertices());
+    for (auto v : a_Mesh.vertices()) {
+        if (!keepVertex[v.idx()]) continue;
+        auto vh = a_Region.add_vertex(a_Mesh.point(v));
+        regionVertexMapping[vh] = vertexMapping[v];
+        regionMarkedStatus[vh] = markedStatus[v];
+        regionVertex[v.idx()] = vh;
+    }
+    std::vector<MeshType::VertexHandle> faceVerts;
+    for (auto f : a_Mesh.faces()) {
+        if (!keepFace[f.idx()]) continue;
+        faceVerts.clear();
+        for (auto fv_it = a_Mesh.fv_begin(f); fv_it != a_Mesh.fv_end(f); ++fv_it) {
+            faceVerts.push_back(regionVertex[fv_it->idx()]);
+        }
+        if (!a_Region.add_face(faceVerts).is_valid()) {
+            // The region pinches at a vertex, subdivide everything instead
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,8 +1,10 @@
 #pragma once
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 #include <OpenMesh/Core/Utils/PropertyManager.hh>
+#include <algorithm>
 #include <map>
 #include <numeric>
+#include <vector>
 #include "VertexMapping.hpp"
 
 /**
@@ -15,6 +17,14 @@
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
 
+/**
+ * \ingroup subdivision
+ * @brief Give every vertex the identity \ref VertexMapping, mapping it to itself with weight 1, unless the mesh already has a "vertex_mapping" property.
+ * 
+ * @param a_Mesh The mesh, the property is added to it.
+ */
+void ensureIdentityVertexMapping(MeshType& a_Mesh);
+
 /**
  * \ingroup subdivision
  * @brief Subdivide the input mesh using Catmull-Clark subdivision scheme.
@@ -39,4 +49,20 @@ MeshType subdividePnsControlMeshCatmullClark(MeshType& a_Mesh);
  * @param a_Mesh The input mesh to be subdivided.
  * @return MeshType The subdivided mesh.
  */
-MeshType subdividePnsControlMeshDooSabin(MeshType& a_Mesh);
\ No newline at end of file
+MeshType subdividePnsControlMeshDooSabin(MeshType& a_Mesh);
+/**
+ * \ingroup subdivision
+ * @brief Extract the part of the mesh that later subdivision levels still need.
+ * Used for local refinement: only the returned region is subdivided instead of the whole mesh.
+ * The region consists of the faces that have an unmarked vertex, see \ref Helper::is_marked, and a_NumRings rings of faces around them.
+ * Vertex positions, the vertex mapping and the vertex marks are copied. Faces keep their relative order, and so do vertices.
+ * If the region is the whole mesh, or it can not be represented as a manifold mesh, no region is extracted
+ * and the whole mesh is to be subdivided instead.
+ * 
+ * @param a_Mesh The input mesh, marked after matching its PnS patches.
+ * @param a_NumRings The number of rings of faces kept around the faces with an unmarked vertex.
+ * @param a_Region Set to the region to be subdivided, only valid if true is returned.
+ * @param a_IsEmpty Set to true if the mesh has no unmarked vertex, in which case nothing needs to be subdivided.
+ * @return bool true if a_Region was extracted, false if a_Mesh is empty or is to be subdivided as a whole.
+ */
+bool extractUnmarkedRegion(MeshType& a_Mesh, const int a_NumRings, MeshType& a_Region, bool& a_IsEmpty);
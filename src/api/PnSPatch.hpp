@@ -63,9 +63,26 @@ public:
      * @param i Index in the u-direction between 0 and Degree in u-direction.
      * @param j Index in the v-direction between 0 and Degree in v-direction.
      * @param k Dimension of control point between 0 and 2 (x, y, or z).
-     * @return Const reference to the coefficient value.
+     * @return The coefficient value.
      */
-    const double& operator()(uint32_t i, uint32_t j, uint32_t k) const;
+    double operator()(uint32_t i, uint32_t j, uint32_t k) const;
+
+    /**
+     * @brief Direct read access to all Bézier coefficients without copying.
+     *
+     * The coefficients are stored contiguously as (getDegreeU()+1)*(getDegreeV()+1) control points of 3 floats each,
+     * so coordinate k of coefficient (i, j) is at index (i*(getDegreeV()+1) + j)*3 + k.
+     * The pointer is valid until the patch is modified or destroyed.
+     *
+     * @return Pointer to the first of size() coefficients.
+     */
+    const float* data() const;
+
+    /**
+     * @brief Number of floats pointed to by data().
+     * @return (getDegreeU()+1)*(getDegreeV()+1)*3
+     */
+    uint32_t size() const;
 
     /**
      * @brief Check whether this patch is valid.
@@ -142,10 +159,18 @@ inline PnSPatch& PnSPatch::operator=(PnSPatch&& other) noexcept {
     return *this;
 }
 
-inline const double& PnSPatch::operator()(uint32_t i, uint32_t j, uint32_t k) const{
+inline double PnSPatch::operator()(uint32_t i, uint32_t j, uint32_t k) const{
     return PnSPatch_getValue(impl, i, j, k);
 }
 
+inline const float* PnSPatch::data() const{
+    return PnSPatch_getCoefficients(impl);
+}
+
+inline uint32_t PnSPatch::size() const{
+    return (getDegreeU() + 1) * (getDegreeV() + 1) * 3;
+}
+
 inline bool PnSPatch::isValid() const{
     return PnSPatch_isValid(impl);
 }
@@ -12,7 +12,11 @@ void PnSPatch_degRaise(Patch* patch){
 }
 
 double PnSPatch_getValue(const Patch* patch, uint32_t i, uint32_t j, uint32_t k){
-    return patch->m_BBcoefs[i][j][k];
+    return (*patch)(i, j, k);
+}
+
+const float* PnSPatch_getCoefficients(const Patch* patch){
+    return patch->data();
 }
 
 uint32_t PnSPatch_getDegreeU(const Patch* patch){
@@ -14,6 +14,7 @@ bool PnSPatch_isValid(const Patch* patch);
 void PnSPatch_degRaise(Patch* patch);
 
 double PnSPatch_getValue(const Patch* patch, uint32_t i, uint32_t j, uint32_t k);
+const float* PnSPatch_getCoefficients(const Patch* patch);
 
 uint32_t PnSPatch_getDegreeU(const Patch* patch);
 uint32_t PnSPatch_getDegreeV(const Patch* patch);
@@ -57,6 +57,25 @@ public:
              std::vector<std::vector<uint32_t>>& controlIndices,
              bool degRaise = false, bool gradientHandles = false);
 
+    /**
+     * @brief Construct a PnSpline from flat arrays, for example numpy arrays or buffers shared with C# or WebAssembly.
+     *
+     * The arrays are read in place and the control mesh is built in bulk, which is much faster than adding faces one at a time for large nets.
+     *
+     * @param points x, y, z of numPoints control points.
+     * @param numPoints Number of control points.
+     * @param faceIndices The 0-based control point indices of all faces, face after face.
+     * @param faceOffsets numFaces + 1 offsets into faceIndices, face f has the indices faceIndices[faceOffsets[f]] to faceIndices[faceOffsets[f+1]-1].
+     * @param numFaces Number of faces.
+     * @param degRaise See above.
+     * @param gradientHandles See above.
+     *
+     * @note The PnSpline does not keep references to the arrays.
+     */
+    PnSpline(const double* points, uint64_t numPoints,
+             const uint32_t* faceIndices, const uint64_t* faceOffsets, uint64_t numFaces,
+             bool degRaise = false, bool gradientHandles = false);
+
     /**
      * @brief Copy constructor.
      * @param other Another PnSpline to copy from.
@@ -93,6 +112,7 @@ public:
      *
      * @param updatedControlPoints New vertex positions.
      * @param updateIndices Indices of the control points to update.
+     * @param numThreads Number of threads used to rebuild the affected patches. 0 uses all hardware threads.
      * @return Indices of patches that were affected by the update.
      *
      * This allows incremental updates without rebuilding the entire surface.
@@ -101,7 +121,22 @@ public:
      */
     std::vector<uint32_t> updateControlMesh(
         std::vector<std::array<double,3>>& updatedControlPoints,
-        std::vector<uint32_t>& updateIndices);
+        std::vector<uint32_t>& updateIndices, int numThreads = 1);
+
+    /**
+     * @brief Update part of the control mesh, writing the indices of the affected patches into a caller provided buffer.
+     *
+     * @param updatedControlPoints New vertex positions.
+     * @param updateIndices Indices of the control points to update.
+     * @param outPatchIndices Buffer receiving the indices of the affected patches, in ascending order.
+     * @param maxOut Capacity of outPatchIndices. At most maxOut indices are written.
+     * @param numThreads Number of threads used to rebuild the affected patches. 0 uses all hardware threads.
+     * @return The number of affected patches. If it is larger than maxOut only the first maxOut indices were written.
+     */
+    uint64_t updateControlMesh(
+        const std::vector<std::array<double,3>>& updatedControlPoints,
+        const std::vector<uint32_t>& updateIndices,
+        uint32_t* outPatchIndices, uint64_t maxOut, int numThreads = 1);
 
     /**
      * @brief Degree raise all patches upto degree 3 for each paramter. Degree greater than 3 will remain unchanged. This is not relevant for PnS3.
@@ -124,6 +159,28 @@ public:
      */
     PnSPatch getPatch(uint32_t index) const;
 
+    /**
+     * @brief Total number of coefficient values (3 per control point) of all patches.
+     * @return The size needed for the coefficient buffer of @ref exportPatches.
+     */
+    uint64_t numCoefficients() const;
+
+    /**
+     * @brief Copy all patches into caller provided contiguous buffers in one call.
+     *
+     * Any buffer may be null to skip it.
+     *
+     * @param degrees 2 * numPatches() values: the degree in u and v of each patch.
+     * @param offsets numPatches() + 1 values: the index in coefficients of the first value of each patch. The last entry is numCoefficients().
+     * @param coefficients numCoefficients() values: the control points of every patch as x, y, z, in the order of PnSPatch::data().
+     */
+    void exportPatches(uint32_t* degrees, uint64_t* offsets, float* coefficients) const;
+
+    /**
+     * @brief Same as @ref exportPatches, converting the coefficients to double.
+     */
+    void exportPatches(uint32_t* degrees, uint64_t* offsets, double* coefficients) const;
+
 private:
     /// Opaque pointer to implementation (PIMPL idiom). This is to ensure binary compatibility.
     PnSplineImpl* impl;
@@ -136,24 +193,31 @@ inline PnSpline::PnSpline() : impl(PnSpline_create_empty()) {}
 inline PnSpline::PnSpline(std::vector<std::array<double,3>>& controlPoints,
                           std::vector<std::vector<uint32_t>>& controlIndices,
                           bool degRaise, bool gradientHandles) {
-    std::vector<double> flatPts;
-    flatPts.reserve(controlPoints.size() * 3);
-    for (auto& p : controlPoints) {
-        flatPts.insert(flatPts.end(), {p[0], p[1], p[2]});
-    }
+    // The points are contiguous x, y, z triples and are passed as they are, only the faces are flattened
+    static_assert(sizeof(std::array<double,3>) == 3 * sizeof(double), "std::array<double,3> must not be padded");
 
+    std::vector<uint64_t> faceOffsets;
+    faceOffsets.reserve(controlIndices.size() + 1);
+    faceOffsets.push_back(0);
+    for (auto& face : controlIndices) {
+        faceOffsets.push_back(faceOffsets.back() + face.size());
+    }
     std::vector<uint32_t> flatIndices;
-    std::vector<uint64_t> faceSizes;
+    flatIndices.reserve(faceOffsets.back());
     for (auto& face : controlIndices) {
-        faceSizes.push_back(face.size());
         flatIndices.insert(flatIndices.end(), face.begin(), face.end());
     }
 
-    impl = PnSpline_create_from_points(flatPts.data(), controlPoints.size(),
-                                       flatIndices.data(), faceSizes.data(), controlIndices.size(),
+    impl = PnSpline_create_from_arrays(controlPoints.empty() ? nullptr : controlPoints.data()->data(), controlPoints.size(),
+                                       flatIndices.data(), faceOffsets.data(), controlIndices.size(),
                                        degRaise, gradientHandles);
 }
 
+inline PnSpline::PnSpline(const double* points, uint64_t numPoints,
+                          const uint32_t* faceIndices, const uint64_t* faceOffsets, uint64_t numFaces,
+                          bool degRaise, bool gradientHandles)
+    : impl(PnSpline_create_from_arrays(points, numPoints, faceIndices, faceOffsets, numFaces, degRaise, gradientHandles)) {}
+
 inline PnSpline::PnSpline(const PnSpline& other)
     : impl(PnSpline_clone(other.impl)) {}
 
@@ -185,7 +249,18 @@ inline PnSpline::~PnSpline() {
 
 inline std::vector<uint32_t> PnSpline::updateControlMesh(
     std::vector<std::array<double,3>>& updatedControlPoints,
-    std::vector<uint32_t>& updateIndices) {
+    std::vector<uint32_t>& updateIndices, int numThreads) {
+
+    uint64_t numUpdated = updateControlMesh(updatedControlPoints, updateIndices, nullptr, 0, numThreads);
+    std::vector<uint32_t> outPatchIds(numUpdated);
+    PnSpline_getUpdatedPatches(impl, outPatchIds.data(), outPatchIds.size());
+    return outPatchIds;
+}
+
+inline uint64_t PnSpline::updateControlMesh(
+    const std::vector<std::array<double,3>>& updatedControlPoints,
+    const std::vector<uint32_t>& updateIndices,
+    uint32_t* outPatchIndices, uint64_t maxOut, int numThreads) {
 
     std::vector<double> flatPts;
     flatPts.reserve(updatedControlPoints.size() * 3);
@@ -193,14 +268,10 @@ inline std::vector<uint32_t> PnSpline::updateControlMesh(
         flatPts.insert(flatPts.end(), {p[0], p[1], p[2]});
     }
 
-    std::vector<uint32_t> outPatchIds(PnSpline_getNumPatches(impl)); // over-allocate
-    uint64_t numUpdated = PnSpline_updateControlMesh(
+    return PnSpline_updateControlMesh_mt(
         impl, flatPts.data(), updatedControlPoints.size(),
         updateIndices.data(), updateIndices.size(),
-        outPatchIds.data(), outPatchIds.size());
-
-    outPatchIds.resize(numUpdated);
-    return outPatchIds;
+        outPatchIndices, maxOut, numThreads);
 }
 
 inline void PnSpline::degRaise() { PnSpline_degRaise(impl); }
@@ -211,4 +282,16 @@ inline uint32_t PnSpline::numPatches() const {
 
 inline PnSPatch PnSpline::getPatch(uint32_t index) const {
     return PnSPatch(PnSpline_getPatch(impl, index));
+}
+
+inline uint64_t PnSpline::numCoefficients() const {
+    return PnSpline_getNumCoefficients(impl);
+}
+
+inline void PnSpline::exportPatches(uint32_t* degrees, uint64_t* offsets, float* coefficients) const {
+    PnSpline_exportPatches(impl, degrees, offsets, coefficients);
+}
+
+inline void PnSpline::exportPatches(uint32_t* degrees, uint64_t* offsets, double* coefficients) const {
+    PnSpline_exportPatchesDouble(impl, degrees, offsets, coefficients);
 }
\ No newline at end of file
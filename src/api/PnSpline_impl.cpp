@@ -6,20 +6,47 @@
 #include "Patch/PatchBuilder.hpp"
 #include "Patch/Patch.hpp"
 #include "ProcessMesh.hpp"
-#include <unordered_map>
-#include <set>
+#include "Helper/Parallel.hpp"
+#include "Helper/MeshBuilder.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <OpenMesh/Core/Mesh/PolyMesh_ArrayKernelT.hh>
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
 
 
+// Writes the degrees, coefficient offsets and coefficients of the patches, in the precision of T
+template <typename T>
+static void exportPatches(const std::vector<Patch*>& patches, uint32_t* degrees, uint64_t* offsets, T* coefficients) {
+    uint64_t offset = 0;
+    for (size_t i = 0; i < patches.size(); ++i) {
+        const Patch& patch = *patches[i];
+        if (degrees) {
+            degrees[2*i+0] = patch.m_DegU;
+            degrees[2*i+1] = patch.m_DegV;
+        }
+        if (offsets) offsets[i] = offset;
+        if (coefficients) std::copy_n(patch.data(), patch.size(), coefficients + offset);
+        offset += patch.size();
+    }
+    if (offsets) offsets[patches.size()] = offset;
+};
+
 extern "C" {
 struct PnSplineImpl{
     MeshType controlMesh;
     std::vector<Patch*> patches;
     std::vector<PatchBuilder> patchBuilders;
-    std::unordered_map<uint32_t, std::set<uint32_t>> vertexToPatchBuilder;
-    std::unordered_map<uint32_t, uint32_t> patchBuilderToPatchIndex;
+    // Patch builders using each control point, in compressed sparse row form:
+    // the builders of vertex v are vertexToPatchBuilder[vertexToPatchBuilderOffsets[v] .. vertexToPatchBuilderOffsets[v+1]), ascending.
+    std::vector<uint32_t> vertexToPatchBuilderOffsets;
+    std::vector<uint32_t> vertexToPatchBuilder;
+    // Index of the first patch of each builder (prefix sum of the number of patches), one extra entry for the total
+    std::vector<uint32_t> patchBuilderToPatchIndex;
+    // Number of delta updates applied to the patches of each builder since they were last fully rebuilt
+    std::vector<uint32_t> deltaUpdateCounts;
+    // Indices of the patches changed by the last update, ascending
+    std::vector<uint32_t> updatedPatches;
     ~PnSplineImpl(){
         for (auto patch : patches) {
             if(patch)delete patch;
@@ -37,49 +64,75 @@ static void initialize(PnSplineImpl* impl, bool gradientHandles = false) {
         impl->controlMesh = interpretGradientHandles(impl->controlMesh);
     }
     impl->patchBuilders = getPatchBuilders(impl->controlMesh);
-    impl->vertexToPatchBuilder.clear();
-    impl->patchBuilderToPatchIndex.clear();
-    impl->patches.clear();
-    for (uint i = 0; i < impl->patchBuilders.size(); ++i) {
-        auto patchBuilder = impl->patchBuilders[i];
-        impl->patchBuilderToPatchIndex[i] = impl->patches.size();
-        for (const auto& vertex : patchBuilder.getNeighborVerts()){
-            impl->vertexToPatchBuilder[vertex.idx()].insert(i);
-        }
-        auto t_patches = patchBuilder.buildPatches(impl->controlMesh);
-        impl->patches.reserve(impl->patches.size() + t_patches.size());
+    const size_t numVertices = impl->controlMesh.n_vertices();
+    const size_t numBuilders = impl->patchBuilders.size();
+
+    impl->patchBuilderToPatchIndex.assign(numBuilders + 1, 0);
+    for (size_t i = 0; i < numBuilders; ++i) {
+        impl->patchBuilderToPatchIndex[i+1] = impl->patchBuilderToPatchIndex[i] + impl->patchBuilders[i].numPatches();
+    }
 
-        for (auto& p : t_patches) {
-            impl->patches.push_back(new Patch(std::move(p)));
+    // Builders are visited in ascending order, so a builder that lists a vertex more than once is the last one recorded for it
+    std::vector<uint32_t> lastBuilder(numVertices, UINT32_MAX);
+    impl->vertexToPatchBuilderOffsets.assign(numVertices + 1, 0);
+    for (uint32_t i = 0; i < numBuilders; ++i) {
+        for (const auto& vertex : impl->patchBuilders[i].m_NBVertexHandles) {
+            if (!vertex.is_valid()) continue;
+            if (lastBuilder[vertex.idx()] != i) {
+                lastBuilder[vertex.idx()] = i;
+                impl->vertexToPatchBuilderOffsets[vertex.idx() + 1]++;
+            }
         }
     }
+    for (size_t v = 0; v < numVertices; ++v) {
+        impl->vertexToPatchBuilderOffsets[v+1] += impl->vertexToPatchBuilderOffsets[v];
+    }
+    impl->vertexToPatchBuilder.resize(impl->vertexToPatchBuilderOffsets[numVertices]);
+    std::vector<uint32_t> cursor(impl->vertexToPatchBuilderOffsets.begin(), impl->vertexToPatchBuilderOffsets.end() - 1);
+    std::fill(lastBuilder.begin(), lastBuilder.end(), UINT32_MAX);
+    for (uint32_t i = 0; i < numBuilders; ++i) {
+        for (const auto& vertex : impl->patchBuilders[i].m_NBVertexHandles) {
+            if (!vertex.is_valid()) continue;
+            if (lastBuilder[vertex.idx()] != i) {
+                lastBuilder[vertex.idx()] = i;
+                impl->vertexToPatchBuilder[cursor[vertex.idx()]++] = i;
+            }
+        }
+    }
+
+    impl->patches.assign(impl->patchBuilderToPatchIndex[numBuilders], nullptr);
+    // Builders sharing a mask are evaluated together, the patches come back in builder order
+    auto t_patches = PatchBuilder::buildPatchesBatched(impl->controlMesh, impl->patchBuilders.data(), impl->patchBuilders.size());
+    for (size_t i = 0; i < t_patches.size(); ++i) {
+        impl->patches[i] = new Patch(std::move(t_patches[i]));
+    }
+    impl->deltaUpdateCounts.assign(impl->patchBuilders.size(), 0);
+};
+
+// Rebuild all patches in place, so that pointers handed out by PnSpline_getPatch stay valid
+static void rebuildAllPatches(PnSplineImpl* impl) {
+    auto t_patches = PatchBuilder::buildPatchesBatched(impl->controlMesh, impl->patchBuilders.data(), impl->patchBuilders.size());
+    for (size_t i = 0; i < t_patches.size(); ++i) {
+        *impl->patches[i] = std::move(t_patches[i]);
+    }
+    impl->deltaUpdateCounts.assign(impl->patchBuilders.size(), 0);
 };
 
 void PnSpline_degRaise(PnSplineImpl* impl) {
     for (auto& pb : impl->patchBuilders) {
         pb.degRaise();
     }
+    // The raised masks produce patches of a different degree
+    rebuildAllPatches(impl);
 };
 
-PnSplineImpl* PnSpline_create_from_points(const double* points, uint64_t numPoints,
-                                          const uint32_t* faceIndices, const uint64_t* faceSizes, uint64_t numFaces,
+PnSplineImpl* PnSpline_create_from_arrays(const double* points, uint64_t numPoints,
+                                          const uint32_t* faceIndices, const uint64_t* faceOffsets, uint64_t numFaces,
                                           bool degRaise, bool gradientHandles) {
 
     PnSplineImpl* impl = new PnSplineImpl();
 
-    for (uint64_t i = 0; i < numPoints; ++i) {
-        impl->controlMesh.add_vertex({points[i * 3], points[i * 3 + 1], points[i * 3 + 2]});
-    }
-
-    uint64_t offset = 0;
-    for (uint64_t f = 0; f < numFaces; ++f) {
-        std::vector<MeshType::VertexHandle> vhandles;
-        for (uint64_t j = 0; j < faceSizes[f]; ++j) {
-            vhandles.push_back(impl->controlMesh.vertex_handle(faceIndices[offset+j]));
-        }
-        impl->controlMesh.add_face(vhandles);
-        offset += faceSizes[f];
-    }
+    Helper::build_mesh(impl->controlMesh, points, numPoints, faceIndices, faceOffsets, numFaces);
 
     initialize(impl, gradientHandles);
     if (degRaise) {
@@ -89,6 +142,17 @@ PnSplineImpl* PnSpline_create_from_points(const double* points, uint64_t numPoin
     return impl;
 };
 
+PnSplineImpl* PnSpline_create_from_points(const double* points, uint64_t numPoints,
+                                          const uint32_t* faceIndices, const uint64_t* faceSizes, uint64_t numFaces,
+                                          bool degRaise, bool gradientHandles) {
+
+    std::vector<uint64_t> faceOffsets(numFaces + 1, 0);
+    for (uint64_t f = 0; f < numFaces; ++f) {
+        faceOffsets[f + 1] = faceOffsets[f] + faceSizes[f];
+    }
+    return PnSpline_create_from_arrays(points, numPoints, faceIndices, faceOffsets.data(), numFaces, degRaise, gradientHandles);
+};
+
 PnSplineImpl* PnSpline_clone(const PnSplineImpl* other) {
     auto* impl = new PnSplineImpl();
     impl->controlMesh = other->controlMesh;
@@ -100,7 +164,10 @@ PnSplineImpl* PnSpline_clone(const PnSplineImpl* other) {
 
     impl->patchBuilders = other->patchBuilders;
     impl->vertexToPatchBuilder = other->vertexToPatchBuilder;
+    impl->vertexToPatchBuilderOffsets = other->vertexToPatchBuilderOffsets;
     impl->patchBuilderToPatchIndex = other->patchBuilderToPatchIndex;
+    impl->deltaUpdateCounts = other->deltaUpdateCounts;
+    impl->updatedPatches = other->updatedPatches;
 
     return impl;
 }
@@ -110,37 +177,101 @@ void PnSpline_destroy(PnSplineImpl* impl) {
     if(impl) delete impl;
 };
 
-uint64_t PnSpline_updateControlMesh(PnSplineImpl* impl,
-                                    const double* updatedPoints, uint64_t numPoints,
-                                    const uint32_t* updateIndices, uint64_t numIndices,
-                                    uint32_t* outPatchIndices, uint64_t maxOut) {
-    std::set<uint32_t> affectedPBs;
+uint64_t PnSpline_getUpdatedPatches(const PnSplineImpl* impl, uint32_t* outPatchIndices, uint64_t maxOut) {
+    const uint64_t n = impl->updatedPatches.size();
+    if (outPatchIndices) {
+        std::copy_n(impl->updatedPatches.begin(), std::min(n, maxOut), outPatchIndices);
+    }
+    return n;
+};
+
+uint64_t PnSpline_updateControlMesh_mt(PnSplineImpl* impl,
+                                       const double* updatedPoints, uint64_t numPoints,
+                                       const uint32_t* updateIndices, uint64_t numIndices,
+                                       uint32_t* outPatchIndices, uint64_t maxOut, int numThreads) {
+    // After this many delta updates the patches of a builder are rebuilt from the control points to bound the accumulated error
+    const uint32_t t_MaxDeltaUpdates = 64;
+
+    // The moved columns of every affected builder: (builder, column in the mask, delta)
+    struct MovedColumn {
+        uint32_t patchBuilder;
+        int column;
+        Point delta;
+    };
+    std::vector<MovedColumn> movedColumns;
+    std::vector<uint32_t> affectedPBs;
+    std::vector<bool> isAffected(impl->patchBuilders.size(), false);
 
+    const size_t numVertices = impl->controlMesh.n_vertices();
     for (uint64_t i = 0; i < numIndices; ++i) {
         uint32_t vid = updateIndices[i];
-        impl->controlMesh.set_point(
-            impl->controlMesh.vertex_handle(vid),
-            {updatedPoints[3*i+0], updatedPoints[3*i+1], updatedPoints[3*i+2]}
-        );
-        auto& affected = impl->vertexToPatchBuilder[vid];
-        affectedPBs.insert(affected.begin(), affected.end());
-    }
-
-    std::vector<uint32_t> updated;
-    for (auto pbIdx : affectedPBs) {
-        auto& pb = impl->patchBuilders[pbIdx];
-        auto rebuilt = pb.buildPatches(impl->controlMesh);
-        for (uint32_t j = 0; j < rebuilt.size(); ++j) {
-            uint32_t patchIdx = impl->patchBuilderToPatchIndex[pbIdx] + j;
-            delete impl->patches[patchIdx];
-            impl->patches[patchIdx] = new Patch(std::move(rebuilt[j]));
-            updated.push_back(patchIdx);
+        if (vid >= numVertices) continue;
+        auto vh = impl->controlMesh.vertex_handle(vid);
+        const Point oldPoint = impl->controlMesh.point(vh);
+        impl->controlMesh.set_point(vh, {updatedPoints[3*i+0], updatedPoints[3*i+1], updatedPoints[3*i+2]});
+        const Point delta = impl->controlMesh.point(vh) - oldPoint;
+
+        for (uint32_t k = impl->vertexToPatchBuilderOffsets[vid]; k < impl->vertexToPatchBuilderOffsets[vid+1]; ++k) {
+            const uint32_t pbIdx = impl->vertexToPatchBuilder[k];
+            if (!isAffected[pbIdx]) {
+                isAffected[pbIdx] = true;
+                affectedPBs.push_back(pbIdx);
+            }
+            const auto& nbVerts = impl->patchBuilders[pbIdx].m_NBVertexHandles;
+            for (int c = 0; c < (int)nbVerts.size(); ++c) {
+                if (nbVerts[c] == vh) movedColumns.push_back({pbIdx, c, delta});
+            }
         }
     }
 
-    uint64_t n = updated.size();
-    std::copy_n(updated.begin(), n, outPatchIndices);
-    return n;
+    // Report the patches in ascending order, group the moved columns by builder in the same order
+    std::sort(affectedPBs.begin(), affectedPBs.end());
+    std::sort(movedColumns.begin(), movedColumns.end(),
+              [](const MovedColumn& a, const MovedColumn& b) { return a.patchBuilder < b.patchBuilder; });
+
+    // Every affected builder has at least one moved column, so the groups line up with affectedPBs
+    std::vector<size_t> movedOffsets(affectedPBs.size() + 1, 0);
+    impl->updatedPatches.clear();
+    for (size_t i = 0, m = 0; i < affectedPBs.size(); ++i) {
+        while (m < movedColumns.size() && movedColumns[m].patchBuilder == affectedPBs[i]) ++m;
+        movedOffsets[i+1] = m;
+        for (uint32_t j = impl->patchBuilderToPatchIndex[affectedPBs[i]]; j < impl->patchBuilderToPatchIndex[affectedPBs[i]+1]; ++j) {
+            impl->updatedPatches.push_back(j);
+        }
+    }
+
+    // Each builder writes only its own patches and counter, so the builders can be updated in parallel without locking
+    Helper::parallel_for(0, affectedPBs.size(), numThreads, [&](size_t i) {
+        const uint32_t pbIdx = affectedPBs[i];
+        const auto& pb = impl->patchBuilders[pbIdx];
+        Patch* const* pbPatches = impl->patches.data() + impl->patchBuilderToPatchIndex[pbIdx];
+        uint32_t& deltaCount = impl->deltaUpdateCounts[pbIdx];
+        const size_t numMoved = movedOffsets[i+1] - movedOffsets[i];
+
+        // Applying more than half of the mask column by column costs more than a full rebuild
+        if (deltaCount + numMoved > t_MaxDeltaUpdates || 2 * numMoved > pb.m_NBVertexHandles.size()) {
+            auto rebuilt = pb.buildPatches(impl->controlMesh);
+            for (uint32_t j = 0; j < rebuilt.size(); ++j) {
+                *pbPatches[j] = std::move(rebuilt[j]);
+            }
+            deltaCount = 0;
+        }
+        else {
+            for (size_t m = movedOffsets[i]; m < movedOffsets[i+1]; ++m) {
+                pb.applyDelta(movedColumns[m].column, movedColumns[m].delta, pbPatches);
+            }
+            deltaCount += numMoved;
+        }
+    }, 64);
+
+    return PnSpline_getUpdatedPatches(impl, outPatchIndices, maxOut);
+};
+
+uint64_t PnSpline_updateControlMesh(PnSplineImpl* impl,
+                                    const double* updatedPoints, uint64_t numPoints,
+                                    const uint32_t* updateIndices, uint64_t numIndices,
+                                    uint32_t* outPatchIndices, uint64_t maxOut) {
+    return PnSpline_updateControlMesh_mt(impl, updatedPoints, numPoints, updateIndices, numIndices, outPatchIndices, maxOut, 1);
 };
 
 
@@ -152,4 +283,20 @@ Patch* PnSpline_getPatch(const PnSplineImpl* impl, uint32_t index) {
     if (index >= impl->patches.size()) return nullptr;
     return impl->patches[index];
 };
+
+uint64_t PnSpline_getNumCoefficients(const PnSplineImpl* impl) {
+    uint64_t n = 0;
+    for (const auto* patch : impl->patches) {
+        n += patch->size();
+    }
+    return n;
+};
+
+void PnSpline_exportPatches(const PnSplineImpl* impl, uint32_t* degrees, uint64_t* offsets, float* coefficients) {
+    exportPatches(impl->patches, degrees, offsets, coefficients);
+};
+
+void PnSpline_exportPatchesDouble(const PnSplineImpl* impl, uint32_t* degrees, uint64_t* offsets, double* coefficients) {
+    exportPatches(impl->patches, degrees, offsets, coefficients);
+};
 }
\ No newline at end of file
@@ -19,18 +19,41 @@ PnSplineImpl* PnSpline_create_empty();
 PnSplineImpl* PnSpline_create_from_points(const double* points, uint64_t numPoints,
                                         const uint32_t* faceIndices, const uint64_t* faceSizes, uint64_t numFaces,
                                         bool degRaise, bool gradientHandles = false);
+// Same as PnSpline_create_from_points with the faces in compressed sparse row form: face f has the vertices
+// faceIndices[faceOffsets[f]] to faceIndices[faceOffsets[f+1]-1]. The arrays are read in place, not copied.
+PnSplineImpl* PnSpline_create_from_arrays(const double* points, uint64_t numPoints,
+                                        const uint32_t* faceIndices, const uint64_t* faceOffsets, uint64_t numFaces,
+                                        bool degRaise, bool gradientHandles = false);
 PnSplineImpl* PnSpline_clone(const PnSplineImpl* other);
 void PnSpline_destroy(PnSplineImpl* impl);
 
 // Operations
 void PnSpline_degRaise(PnSplineImpl* impl);
 
+// Writes at most maxOut indices of updated patches and returns the number of updated patches, which may be larger.
+// All of them can be read with PnSpline_getUpdatedPatches until the next update. outUpdatedPatchIndices may be null.
 uint64_t PnSpline_updateControlMesh(PnSplineImpl* impl,
                                 const double* updatedPoints, uint64_t numPoints,
                                 const uint32_t* updateIndices, uint64_t numIndices,
                                 uint32_t* outUpdatedPatchIndices, uint64_t maxOut);
 
+// Same as PnSpline_updateControlMesh, the affected patches are rebuilt on numThreads threads (0 = all hardware threads).
+uint64_t PnSpline_updateControlMesh_mt(PnSplineImpl* impl,
+                                const double* updatedPoints, uint64_t numPoints,
+                                const uint32_t* updateIndices, uint64_t numIndices,
+                                uint32_t* outUpdatedPatchIndices, uint64_t maxOut, int numThreads);
+
+// Indices of the patches changed by the last update. Writes at most maxOut and returns the total number.
+uint64_t PnSpline_getUpdatedPatches(const PnSplineImpl* impl, uint32_t* outUpdatedPatchIndices, uint64_t maxOut);
+
 uint64_t PnSpline_getNumPatches(const PnSplineImpl* impl);
 
 Patch* PnSpline_getPatch(const PnSplineImpl* impl, uint32_t index);
+
+// Bulk export of all patches in structure-of-arrays form. Any of the output buffers may be null to skip it.
+// degrees: 2 per patch (u, v). offsets: numPatches+1 entries, the index of the first coefficient of each patch.
+// coefficients: PnSpline_getNumCoefficients values, the (u+1)(v+1) points of every patch as x,y,z in the order of PnSPatch_getCoefficients.
+uint64_t PnSpline_getNumCoefficients(const PnSplineImpl* impl);
+void PnSpline_exportPatches(const PnSplineImpl* impl, uint32_t* degrees, uint64_t* offsets, float* coefficients);
+void PnSpline_exportPatchesDouble(const PnSplineImpl* impl, uint32_t* degrees, uint64_t* offsets, double* coefficients);
 }
\ No newline at end of file
@@ -12,10 +12,12 @@
 #include "Pool/Pool.hpp"
 #include "PatchConsumer/PatchConsumer.hpp"
 #include "PatchConsumer/BVWriter.hpp"
+#include "PatchConsumer/BinaryBVWriter.hpp"
 #include "PatchConsumer/IGSWriter.hpp"
 #include "PatchConsumer/STEPWriter.hpp"
 #include "ProcessMesh.hpp"
 #include "Helper/simple_arg.hpp"
+#include "Helper/ObjLoader.hpp"
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
 
@@ -25,7 +27,8 @@ int main(int argc, char **argv)
     SimpleArg p{argv[0]};
     p.add<bool>('d', "DEGREE_RAISE", "raise degree 2 patches to degree 3");
     p.add<std::string>('f', "FORMAT", "output format", false, "bv",
-                       {"bv", "igs", "step"});
+                       {"bv", "bvb", "igs", "step"});
+    p.add<int>('j', "THREADS", "number of threads, 0 uses all hardware threads", false, 0);
     p.addPositional<std::string>("input",   "input file");
 
     if (!p.parse(argc, argv) || p.help()) {
@@ -38,25 +41,34 @@ int main(int argc, char **argv)
     bool t_IsDegRaise = p.get<bool>("DEGREE_RAISE");
     const std::string t_InputFile = p.getPositional<std::string>(0);
     const std::string t_Format = p.get<std::string>("FORMAT");
+    const int t_NumThreads = p.get<int>("THREADS");
 
     // Load mesh from .obj file
     MeshType t_Mesh;
     
-    OpenMesh::IO::read_mesh(t_Mesh, t_InputFile);
+    // OBJ files are parsed in parallel, other formats are read by OpenMesh
+    const bool t_IsObj = t_InputFile.size() > 4 && t_InputFile.compare(t_InputFile.size() - 4, 4, ".obj") == 0;
+    if (t_IsObj) {
+        Helper::load_obj(t_InputFile, t_Mesh, t_NumThreads);
+    } else {
+        OpenMesh::IO::read_mesh(t_Mesh, t_InputFile);
+    }
 
     // Init .bv file writer
     const std::string t_FileName = "output." + t_Format;
     PatchConsumer* t_Writer;
     if (t_Format == "bv") {
         t_Writer = new BVWriter(t_FileName);
+    } else if(t_Format == "bvb") {
+        t_Writer = new BinaryBVWriter(t_FileName);
     } else if(t_Format == "igs") {
-        t_Writer = new IGSWriter(t_FileName);
+        t_Writer = new IGSWriter(t_FileName, t_NumThreads);
     } else{ // t_Format == "step"
-        t_Writer = new STEPWriter(t_FileName);
+        t_Writer = new STEPWriter(t_FileName, t_NumThreads);
     }
 
     // Convert mesh into Patches (contain BB-coefficients) and write patches into .bv file
-    process_mesh(t_Mesh, t_Writer, t_IsDegRaise);
+    process_mesh(t_Mesh, t_Writer, t_IsDegRaise, t_NumThreads);
 
     delete t_Writer;
 
@@ -11,6 +11,8 @@
 #include "PatchConsumer/STEPWriter.hpp"
 #include "ProcessMesh.hpp"
 #include "PatchConsumer/EvaluatedMeshWriter.hpp"
+#include "Helper/Tessellator.hpp"
+#include "Helper/ObjLoader.hpp"
 
 
 typedef OpenMesh::PolyMesh_ArrayKernelT<> MeshType;
@@ -71,59 +73,68 @@ std::string saveMeshToString(MeshType& mesh) {
     return objStream.str();
 }
 
+// Patches of an OBJ file given as text, false if it can not be read
+static bool buildPatchesFromObj(const unsigned char* data, int length, std::vector<Patch>& patches) {
+    MeshType mesh;
+    if (!Helper::parse_obj(reinterpret_cast<const char*>(data), length, mesh)) {
+        std::cerr << "Could not read mesh" << std::endl;
+        return false;
+    }
+    std::vector<PatchBuilder> t_PatchBuilders = getPatchBuilders(mesh);
+    patches = PatchBuilder::buildPatchesBatched(mesh, t_PatchBuilders.data(), t_PatchBuilders.size());
+    return true;
+}
+
 extern "C" {
     EMSCRIPTEN_KEEPALIVE
     int evaluatedPnsMesh(const unsigned char* data, int length, float *vertexBuffer, int *indexBuffer, float *uvBuffer, float *normalBuffer) {
-        // Load the mesh from the string
-        std::string str = std::string(data, data + length);
-        std::istringstream objStream(str);
-        MeshType mesh;
-        OpenMesh::IO::Options options;
-        if (!OpenMesh::IO::read_mesh(mesh, objStream, "obj", options)) {
-            std::cerr << "Could not read mesh" << std::endl;
+        // Convert mesh into Patches (contain BB-coefficients) and tessellate them straight into the output buffers
+        std::vector<Patch> t_Patches;
+        if (!buildPatchesFromObj(data, length, t_Patches)) {
             return 0;
         }
 
-        //create bv
-        MeshType t_Mesh;
-        t_Mesh.request_vertex_texcoords2D();
-        PatchConsumer* t_Writer = new EvaluatedMeshWriter(&t_Mesh);
+        Tessellator t_Tessellator(16);
+        const size_t t_NumVertices = t_Tessellator.numVerticesPerPatch();
+        const size_t t_NumIndices = t_Tessellator.numIndicesPerPatch();
+        for (size_t p = 0; p < t_Patches.size(); p++) {
+            t_Tessellator.tessellate(t_Patches[p],
+                                     vertexBuffer + 3 * t_NumVertices * p,
+                                     normalBuffer + 3 * t_NumVertices * p,
+                                     uvBuffer + 2 * t_NumVertices * p,
+                                     reinterpret_cast<uint32_t*>(indexBuffer) + t_NumIndices * p,
+                                     t_NumVertices * p);
+        }
+        std::cout << "Vertices: " << t_NumVertices * t_Patches.size() << " Faces: " << t_NumIndices / 3 * t_Patches.size() << std::endl;
+        return t_NumIndices * t_Patches.size();
 
-        // Convert mesh into Patches (contain BB-coefficients) and write patches into .bv file
-        const bool t_IsDegRaise = false;
-        process_mesh(mesh, t_Writer, t_IsDegRaise);
+    }
 
-        delete t_Writer;
-        std::cout << "Vertices: " << t_Mesh.n_vertices() << " Faces: " << t_Mesh.n_faces() << std::endl;
-        // scaleAndTranslateMesh(t_Mesh);
-        // std::string temp = saveMeshToString(t_Mesh);
-        for (int i = 0; i < t_Mesh.n_vertices(); i++) {
-            MeshType::Point p = t_Mesh.point(MeshType::VertexHandle(i));
-            vertexBuffer[i * 3] = p[0];
-            vertexBuffer[i * 3 + 1] = p[1];
-            vertexBuffer[i * 3 + 2] = p[2];
-
-            MeshType::Normal n = t_Mesh.normal(MeshType::VertexHandle(i));
-            normalBuffer[i * 3] = n[0];
-            normalBuffer[i * 3 + 1] = n[1];
-            normalBuffer[i * 3 + 2] = n[2];
-
-            MeshType::TexCoord2D uv = t_Mesh.texcoord2D(MeshType::VertexHandle(i));
-            uvBuffer[i * 2] = uv[0];
-            uvBuffer[i * 2 + 1] = uv[1];
+    /*
+     * Like evaluatedPnsMesh, but every patch is tessellated adaptively so that the triangles are within tolerance of it,
+     * see Tessellator::tessellateAdaptive. A patch never gets more vertices or triangles than in evaluatedPnsMesh,
+     * so buffers sized for evaluatedPnsMesh suffice. The vertices are packed at the start of the vertex buffers.
+     * A tolerance of 0 or less gives the uniform tessellation of evaluatedPnsMesh.
+     */
+    EMSCRIPTEN_KEEPALIVE
+    int evaluatedPnsMeshAdaptive(const unsigned char* data, int length, float tolerance, float *vertexBuffer, int *indexBuffer, float *uvBuffer, float *normalBuffer) {
+        if (tolerance <= 0) {
+            return evaluatedPnsMesh(data, length, vertexBuffer, indexBuffer, uvBuffer, normalBuffer);
         }
-
-        for (int i = 0; i < t_Mesh.n_faces(); i++) {
-            MeshType::FaceHandle fh = MeshType::FaceHandle(i);
-            MeshType::FaceVertexIter fv_it = t_Mesh.fv_iter(fh);
-            int j = 0;
-            for (; fv_it.is_valid(); ++fv_it) {
-                indexBuffer[i * 3 + j] = fv_it->idx();
-                j++;
-            }
+        std::vector<Patch> t_Patches;
+        if (!buildPatchesFromObj(data, length, t_Patches)) {
+            return 0;
         }
-        return t_Mesh.n_faces() * 3;
 
+        Tessellator t_Tessellator(16);
+        TessellatedMesh t_Mesh;
+        t_Tessellator.tessellateAdaptive(t_Patches.data(), t_Patches.size(), tolerance, t_Mesh);
+        std::copy(t_Mesh.m_Vertices.begin(), t_Mesh.m_Vertices.end(), vertexBuffer);
+        std::copy(t_Mesh.m_Normals.begin(), t_Mesh.m_Normals.end(), normalBuffer);
+        std::copy(t_Mesh.m_UVs.begin(), t_Mesh.m_UVs.end(), uvBuffer);
+        std::copy(t_Mesh.m_Indices.begin(), t_Mesh.m_Indices.end(), reinterpret_cast<uint32_t*>(indexBuffer));
+        std::cout << "Vertices: " << t_Mesh.m_Vertices.size() / 3 << " Faces: " << t_Mesh.m_Indices.size() / 3 << std::endl;
+        return t_Mesh.m_Indices.size();
     }
 }
 
@@ -132,13 +143,8 @@ extern "C" {
     int getBv(const unsigned char* data, int length) {
 
 
-        std::string str = std::string(data, data + length);
-
-
-        std::istringstream objStream(str);
         MeshType mesh;
-        OpenMesh::IO::Options options;
-        if (!OpenMesh::IO::read_mesh(mesh, objStream, "obj", options)) {
+        if (!Helper::parse_obj(reinterpret_cast<const char*>(data), length, mesh)) {
             std::cerr << "Could not read mesh" << std::endl;
             return 1;
         }
@@ -158,11 +164,8 @@ extern "C" {
 extern "C" {
     EMSCRIPTEN_KEEPALIVE  
     int getigs(const unsigned char* data, int length) {
-        std::string str = std::string(data, data + length);
-        std::istringstream objStream(str);
         MeshType mesh;
-        OpenMesh::IO::Options options;
-        if (!OpenMesh::IO::read_mesh(mesh, objStream, "obj", options)) {
+        if (!Helper::parse_obj(reinterpret_cast<const char*>(data), length, mesh)) {
             std::cerr << "Could not read mesh" << std::endl;
             return 1;
         }
@@ -179,11 +182,8 @@ extern "C" {
 extern "C" {
     EMSCRIPTEN_KEEPALIVE  
     int getstep(const unsigned char* data, int length) {
-        std::string str = std::string(data, data + length);
-        std::istringstream objStream(str);
         MeshType mesh;
-        OpenMesh::IO::Options options;
-        if (!OpenMesh::IO::read_mesh(mesh, objStream, "obj", options)) {
+        if (!Helper::parse_obj(reinterpret_cast<const char*>(data), length, mesh)) {
             std::cerr << "Could not read mesh" << std::endl;
             return 1;
         }